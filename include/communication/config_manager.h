@@ -4,51 +4,55 @@
 
 #include "config.h"
 
-#include <EEPROM.h>
+#include <services/storage_manager.h>
 
-#define EEPROM_SIZE 512
-#define EEPROM_ADDR 0
-#define CONFIG_MAGIC 0xABCD1234
-
-struct StoredConfig
-{
-    uint32_t magic;
-    Config config;
-};
+#define CONFIG_DOCUMENT_SIZE 512
+#define CONFIG_STORAGE_VERSION 1
+#define CONFIG_MAGIC 0xABCD1234 // header of the JSON written before the network partition existed
 
 class ConfigManager
 {
-public:
-    void begin()
-    {
-        EEPROM.begin();
-    }
+    StorageManager *storage = nullptr;
 
-    bool load(Config &config)
+    // Reads the pre-partition layout (magic followed by a NUL-terminated string) and moves it over. A
+    // string longer than the partition holds is used where it is, so it is never stored truncated.
+    bool load_legacy(Config &config)
     {
-        uint32_t magic;
-        String json;
-
-        EEPROM.get(EEPROM_ADDR, magic);
+        uint32_t magic = 0;
+        storage->get(Partition::NETWORK, 0, magic);
         if (magic != CONFIG_MAGIC)
         {
             Serial.println("Invalid config magic");
             return false;
         }
 
-        char buffer[EEPROM_SIZE];
-        for (int i = 0; i < EEPROM_SIZE; i++)
+        char buffer[partition_size(Partition::NETWORK)];
+        uint16_t length = 0;
+        while (length < sizeof(buffer) - sizeof(magic) - 1)
         {
-            char c = EEPROM.read(EEPROM_ADDR + sizeof(CONFIG_MAGIC) + i);
+            char c = storage->read_byte(Partition::NETWORK, sizeof(magic) + length);
             if (c == '\0')
                 break;
-            buffer[i] = c;
+            buffer[length++] = c;
         }
+        buffer[length] = '\0';
 
-        buffer[EEPROM_SIZE - 1] = '\0';
-        json = String(buffer);
+        if (!parse(buffer, config))
+            return false;
+
+        if (length > partition_capacity(Partition::NETWORK))
+        {
+            Serial.println("ConfigManager: Legacy config is too long for the network partition, keeping it in place");
+            return true;
+        }
 
-        StaticJsonDocument<EEPROM_SIZE> doc;
+        save(String(buffer));
+        return true;
+    }
+
+    bool parse(const char *json, Config &config)
+    {
+        StaticJsonDocument<CONFIG_DOCUMENT_SIZE> doc;
         DeserializationError error = deserializeJson(doc, json);
         if (error)
         {
@@ -69,19 +73,33 @@ public:
         return true;
     }
 
-    bool save(const String &json)
+public:
+    void begin(StorageManager *storage)
+    {
+        this->storage = storage;
+    }
+
+    bool load(Config &config)
     {
-        // Save the config string to EEPROM
-        EEPROM.put(EEPROM_ADDR, CONFIG_MAGIC);
+        char buffer[partition_capacity(Partition::NETWORK) + 1];
+        uint16_t length = sizeof(buffer) - 1;
+
+        if (!storage->read(Partition::NETWORK, CONFIG_STORAGE_VERSION, buffer, length))
+            return load_legacy(config);
+
+        buffer[length] = '\0';
+        return parse(buffer, config);
+    }
 
-        int len = min(json.length(), EEPROM_SIZE - sizeof(CONFIG_MAGIC));
-        for (int i = 0; i < len; i++)
+    bool save(const String &json)
+    {
+        // A truncated document would fail to parse on load, so the stored one is kept instead
+        if (json.length() > partition_capacity(Partition::NETWORK))
         {
-            EEPROM.write(EEPROM_ADDR + sizeof(CONFIG_MAGIC) + i, json[i]);
+            Serial.println("ConfigManager: Config is too long for the network partition, not saved");
+            return false;
         }
-
-        EEPROM.write(EEPROM_ADDR + sizeof(CONFIG_MAGIC) + len, '\0'); // Null-terminate the string
-        return true;
+        return storage->write(Partition::NETWORK, CONFIG_STORAGE_VERSION, json.c_str(), json.length());
     }
 
     void update_config(const Config &config)
@@ -92,7 +110,7 @@ public:
         if (!loaded)
         {
             // If there's no valid configuration, just save the new one
-            StaticJsonDocument<EEPROM_SIZE> doc;
+            StaticJsonDocument<CONFIG_DOCUMENT_SIZE> doc;
             doc["device_uid"] = config.device_uid;
             doc["wifi"]["ssid"] = config.wifi.ssid;
             doc["wifi"]["password"] = config.wifi.password;
@@ -143,7 +161,7 @@ public:
         }
 
         // Save the updated configuration
-        StaticJsonDocument<EEPROM_SIZE> doc;
+        StaticJsonDocument<CONFIG_DOCUMENT_SIZE> doc;
         doc["device_uid"] = current_config.device_uid;
         doc["wifi"]["ssid"] = current_config.wifi.ssid;
         doc["wifi"]["password"] = current_config.wifi.password;
@@ -160,10 +178,7 @@ public:
 
     void clear()
     {
-        for (int i = 0; i < EEPROM_SIZE; ++i)
-        {
-            EEPROM.write(i, 0);
-        }
+        storage->invalidate(Partition::NETWORK);
     }
 };
 
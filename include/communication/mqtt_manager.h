@@ -4,6 +4,11 @@
 #include "config.h"
 #include <ArduinoMqttClient.h>
 #include <WiFi.h>
+#include <communication/publish_queue.h>
+#include <services/scheduler.h>
+
+#define MQTT_POLL_INTERVAL 10  // ms
+#define MQTT_DRAIN_BUDGET_MS 5 // time allowed for sending queued messages per poll
 
 class MQTTManager
 {
@@ -11,6 +16,7 @@ private:
     MQTTConfig config;
     WiFiClient wifiClient;
     MqttClient mqttClient;
+    PublishQueue queue;
 
 public:
     MQTTManager(const MQTTConfig &cfg) : config(cfg), mqttClient(wifiClient) {}
@@ -29,26 +35,66 @@ public:
             return mqttClient.connect(config.broker.c_str(), config.port);
         }
         mqttClient.poll();
+        drain(MQTT_DRAIN_BUDGET_MS);
         return true;
     }
 
+    // Sends queued messages, urgent lane first, until the queue is empty or the
+    // budget is spent. At least one message is sent per call.
+    void drain(unsigned long budget_ms)
+    {
+        unsigned long start = millis();
+
+        while (!queue.empty() && mqttClient.connected())
+        {
+            QueuedMessage message = queue.front();
+
+            if (!mqttClient.beginMessage(message.topic))
+                return;
+            mqttClient.write(message.payload, message.length);
+            if (!mqttClient.endMessage())
+                return;
+
+            queue.pop();
+
+            if (millis() - start >= budget_ms)
+                return;
+        }
+    }
+
+    // Polls an open session only; SystemMonitor reconnects outside the scheduler
+    void register_tasks(Scheduler &scheduler)
+    {
+        scheduler.add_periodic("mqtt", MQTT_POLL_INTERVAL, TASK_HIGH, [this]()
+                               {
+                                   if (mqttClient.connected())
+                                       update();
+                               });
+    }
+
     bool is_connected()
     {
         return mqttClient.connected();
     }
 
-    void publish(const char *topic, const char *payload)
+    bool publish(const char *topic, const char *payload, PublishPriority priority = PublishPriority::TELEMETRY)
+    {
+        return queue.enqueue(topic, (const uint8_t *)payload, strlen(payload), priority);
+    }
+
+    bool publish(const char *topic, const uint8_t *payload, size_t length, PublishPriority priority = PublishPriority::TELEMETRY)
+    {
+        return queue.enqueue(topic, payload, length, priority);
+    }
+
+    void set_overflow_policy(PublishPriority lane, OverflowPolicy policy)
     {
-        mqttClient.beginMessage(topic);
-        mqttClient.print(payload);
-        mqttClient.endMessage();
+        queue.set_policy(lane, policy);
     }
 
-    void publish(const char *topic, const uint8_t *payload, size_t length)
+    const PublishQueueStats &get_queue_stats() const
     {
-        mqttClient.beginMessage(topic);
-        mqttClient.write(payload, length);
-        mqttClient.endMessage();
+        return queue.get_stats();
     }
 
     void subscribe(const char *topic)
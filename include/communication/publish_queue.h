@@ -0,0 +1,239 @@
+// --- PublishQueue.h ---
+#ifndef PUBLISH_QUEUE_H
+#define PUBLISH_QUEUE_H
+
+#include <Arduino.h>
+
+#define MQTT_QUEUE_BYTES 1024         ///< Telemetry lane capacity in bytes
+#define MQTT_PRIORITY_QUEUE_BYTES 512 ///< Priority lane capacity in bytes
+#define MQTT_MAX_TOPIC_LENGTH 80      ///< Maximum topic length including terminator
+#define MQTT_MAX_PAYLOAD_LENGTH 256   ///< Maximum payload size in bytes (fits a full TelemetryBatch)
+
+enum class PublishPriority
+{
+    TELEMETRY, ///< Periodic sensor data, sent when nothing urgent is waiting
+    URGENT     ///< Alarms and access results, always sent first
+};
+
+enum class OverflowPolicy
+{
+    DROP_OLDEST, ///< Discard the oldest queued messages to make room
+    REJECT_NEW   ///< Refuse the new message
+};
+
+/**
+ * @brief Counters describing the outbound queue.
+ */
+struct PublishQueueStats
+{
+    uint32_t enqueued;   ///< Messages accepted
+    uint32_t sent;       ///< Messages handed to the MQTT client
+    uint32_t dropped;    ///< Messages lost to overflow (either policy) or oversize
+    uint32_t bytes_sent; ///< Payload bytes handed to the MQTT client
+    uint16_t high_water; ///< Largest number of messages queued at once
+};
+
+/**
+ * @brief A queued message as stored in its lane; the pointers stay valid until the message is popped.
+ */
+struct QueuedMessage
+{
+    const char *topic;
+    const uint8_t *payload;
+    uint16_t length;
+};
+
+/**
+ * @class MessageRing
+ * @brief FIFO of variable-length messages in a fixed byte buffer.
+ *
+ * A record is its payload length, its NUL-terminated topic and its payload, so a message only takes
+ * the bytes it needs. Records are never split: one that does not fit before the end of the buffer
+ * starts over at offset 0, and the unused tail is skipped when the oldest record reaches it.
+ */
+template <uint16_t BYTES>
+class MessageRing
+{
+    uint8_t data[BYTES];
+    uint16_t head = 0;     // oldest record
+    uint16_t tail = 0;     // after the newest record
+    uint16_t end = BYTES;  // end of the records before the wrap
+    bool wrapped = false;  // the newest records start over at offset 0
+    uint16_t count = 0;
+
+    static uint16_t record_size(uint16_t topic_length, uint16_t length)
+    {
+        return sizeof(uint16_t) + topic_length + 1 + length;
+    }
+
+    uint16_t size_at(uint16_t offset) const
+    {
+        uint16_t length;
+        memcpy(&length, data + offset, sizeof(length));
+        return record_size(strlen((const char *)data + offset + sizeof(length)), length);
+    }
+
+public:
+    static constexpr uint16_t MAX_RECORD = sizeof(uint16_t) + MQTT_MAX_TOPIC_LENGTH + MQTT_MAX_PAYLOAD_LENGTH;
+    static_assert(BYTES >= MAX_RECORD, "a lane must hold the largest message");
+
+    bool empty() const { return count == 0; }
+    uint16_t size() const { return count; }
+
+    QueuedMessage front() const
+    {
+        QueuedMessage message;
+        memcpy(&message.length, data + head, sizeof(message.length));
+        message.topic = (const char *)data + head + sizeof(message.length);
+        message.payload = (const uint8_t *)message.topic + strlen(message.topic) + 1;
+        return message;
+    }
+
+    void pop()
+    {
+        head += size_at(head);
+        count--;
+
+        if (count == 0)
+        {
+            head = tail = 0;
+            end = BYTES;
+            wrapped = false;
+        }
+        else if (head == end)
+        {
+            head = 0;
+            end = BYTES;
+            wrapped = false;
+        }
+    }
+
+    /**
+     * @brief Copies a message in if there is room for it.
+     */
+    bool push(const char *topic, uint16_t topic_length, const uint8_t *payload, uint16_t length)
+    {
+        uint16_t size = record_size(topic_length, length);
+        uint16_t at;
+
+        if (wrapped)
+        {
+            if (tail + size > head)
+                return false;
+            at = tail;
+        }
+        else if (tail + size <= BYTES)
+        {
+            at = tail;
+        }
+        else if (size <= head)
+        {
+            end = tail;
+            wrapped = true;
+            at = 0;
+        }
+        else
+        {
+            return false;
+        }
+
+        memcpy(data + at, &length, sizeof(length));
+        memcpy(data + at + sizeof(length), topic, topic_length + 1);
+        memcpy(data + at + sizeof(length) + topic_length + 1, payload, length);
+        tail = at + size;
+        count++;
+        return true;
+    }
+};
+
+/**
+ * @class PublishQueue
+ * @brief Bounded two-lane outbound queue. Enqueueing copies into a preallocated lane in O(1), apart
+ *        from the oldest messages a full DROP_OLDEST lane discards.
+ *
+ * By default the telemetry lane drops its oldest messages, since the newest reading supersedes them,
+ * and the urgent lane rejects new ones, so a queued access result is never evicted by a later one.
+ */
+class PublishQueue
+{
+    MessageRing<MQTT_PRIORITY_QUEUE_BYTES> urgent;
+    MessageRing<MQTT_QUEUE_BYTES> telemetry;
+    OverflowPolicy urgent_policy = OverflowPolicy::REJECT_NEW;
+    OverflowPolicy telemetry_policy = OverflowPolicy::DROP_OLDEST;
+    PublishQueueStats stats = {0};
+
+    template <uint16_t N>
+    bool push(MessageRing<N> &ring, OverflowPolicy policy, const char *topic, uint16_t topic_length,
+              const uint8_t *payload, uint16_t length)
+    {
+        while (!ring.push(topic, topic_length, payload, length))
+        {
+            stats.dropped++;
+            if (policy == OverflowPolicy::REJECT_NEW)
+                return false;
+            ring.pop();
+        }
+        return true;
+    }
+
+public:
+    void set_policy(PublishPriority lane, OverflowPolicy policy)
+    {
+        if (lane == PublishPriority::URGENT)
+            urgent_policy = policy;
+        else
+            telemetry_policy = policy;
+    }
+
+    /**
+     * @brief Copies a message into the lane matching its priority.
+     * @return false if the message was rejected or does not fit a lane
+     */
+    bool enqueue(const char *topic, const uint8_t *payload, size_t length, PublishPriority priority)
+    {
+        size_t topic_length = strlen(topic);
+        if (topic_length >= MQTT_MAX_TOPIC_LENGTH || length > MQTT_MAX_PAYLOAD_LENGTH)
+        {
+            stats.dropped++;
+            return false;
+        }
+
+        bool accepted = priority == PublishPriority::URGENT
+                            ? push(urgent, urgent_policy, topic, topic_length, payload, length)
+                            : push(telemetry, telemetry_policy, topic, topic_length, payload, length);
+        if (!accepted)
+            return false;
+
+        stats.enqueued++;
+        if (size() > stats.high_water)
+            stats.high_water = size();
+        return true;
+    }
+
+    bool empty() const { return urgent.empty() && telemetry.empty(); }
+
+    uint16_t size() const { return urgent.size() + telemetry.size(); }
+
+    /**
+     * @brief Returns the next message to send, urgent lane first. The queue must not be empty.
+     */
+    QueuedMessage front() const { return urgent.empty() ? telemetry.front() : urgent.front(); }
+
+    /**
+     * @brief Removes the message returned by front() after it was sent.
+     */
+    void pop()
+    {
+        stats.sent++;
+        stats.bytes_sent += front().length;
+
+        if (urgent.empty())
+            telemetry.pop();
+        else
+            urgent.pop();
+    }
+
+    const PublishQueueStats &get_stats() const { return stats; }
+};
+
+#endif
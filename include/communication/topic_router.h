@@ -0,0 +1,158 @@
+// --- TopicRouter.h ---
+#ifndef TOPIC_ROUTER_H
+#define TOPIC_ROUTER_H
+
+#include <Arduino.h>
+#include <pb.h>
+
+#define ROUTER_MAX_ROUTES 8          ///< Maximum number of subscribed routes
+#define ROUTER_TABLE_SIZE 16         ///< Hash table slots (power of two, > ROUTER_MAX_ROUTES)
+#define ROUTER_MAX_TOPIC_LENGTH 96   ///< Maximum full topic length including terminator
+#define ROUTER_TOPIC_PREFIX "arduino/"
+
+/**
+ * @class TopicRouter
+ * @brief Maps inbound MQTT topics of the form `arduino/<uid>/<suffix>` to member handlers.
+ *
+ * Topics are built once into fixed buffers when routes are registered. Dispatch checks the
+ * device prefix, hashes the suffix with FNV-1a in a single pass and resolves the handler with
+ * an open-addressed probe, so routing a message never touches the heap.
+ *
+ * @tparam T Class owning the handler member functions.
+ */
+template <typename T>
+class TopicRouter
+{
+public:
+    typedef void (T::*Handler)(pb_istream_t *stream);
+
+private:
+    struct Route
+    {
+        char topic[ROUTER_MAX_TOPIC_LENGTH]; ///< Full topic, used for subscribing
+        uint32_t hash;                       ///< FNV-1a hash of the suffix
+        Handler handler;                     ///< Member function invoked on match
+    };
+
+    T *owner = nullptr;
+    size_t prefix_length = 0;
+    char prefix[ROUTER_MAX_TOPIC_LENGTH];
+    Route routes[ROUTER_MAX_ROUTES];
+    uint8_t route_count = 0;
+    int8_t table[ROUTER_TABLE_SIZE];
+
+    static uint32_t hash_suffix(const char *suffix)
+    {
+        uint32_t hash = 2166136261UL;
+        while (*suffix)
+        {
+            hash ^= (uint8_t)*suffix++;
+            hash *= 16777619UL;
+        }
+        return hash;
+    }
+
+public:
+    TopicRouter()
+    {
+        prefix[0] = '\0';
+        clear();
+    }
+
+    /**
+     * @brief Builds the `arduino/<uid>/` prefix shared by every route.
+     * @param owner Instance the handlers are invoked on
+     * @param device_uid Device identifier embedded in the topics
+     * @return false if the prefix does not fit the topic buffer
+     */
+    bool begin(T *owner, const String &device_uid)
+    {
+        clear();
+        this->owner = owner;
+
+        int written = snprintf(prefix, sizeof(prefix), ROUTER_TOPIC_PREFIX "%s/", device_uid.c_str());
+        if (written < 0 || written >= (int)sizeof(prefix))
+        {
+            prefix[0] = '\0';
+            prefix_length = 0;
+            return false;
+        }
+
+        prefix_length = written;
+        return true;
+    }
+
+    /**
+     * @brief Removes every route; the prefix is kept.
+     */
+    void clear()
+    {
+        route_count = 0;
+        memset(table, -1, sizeof(table));
+    }
+
+    /**
+     * @brief Registers a handler for `arduino/<uid>/<suffix>`.
+     * @param suffix Topic suffix after the device prefix
+     * @param handler Member function to invoke on match
+     * @return false if the table is full or the topic does not fit
+     */
+    bool add(const char *suffix, Handler handler)
+    {
+        if (!owner || route_count >= ROUTER_MAX_ROUTES)
+            return false;
+
+        Route &route = routes[route_count];
+        int written = snprintf(route.topic, sizeof(route.topic), "%s%s", prefix, suffix);
+        if (written < 0 || written >= (int)sizeof(route.topic))
+            return false;
+
+        route.hash = hash_suffix(suffix);
+        route.handler = handler;
+
+        uint8_t slot = route.hash & (ROUTER_TABLE_SIZE - 1);
+        while (table[slot] >= 0)
+            slot = (slot + 1) & (ROUTER_TABLE_SIZE - 1);
+        table[slot] = route_count++;
+
+        return true;
+    }
+
+    /**
+     * @brief Resolves the route registered for a topic.
+     * @return Route index, or -1 if no route matches
+     */
+    int match(const char *topic) const
+    {
+        if (!owner || prefix_length == 0 || strncmp(topic, prefix, prefix_length) != 0)
+            return -1;
+
+        const char *suffix = topic + prefix_length;
+        uint32_t hash = hash_suffix(suffix);
+
+        uint8_t slot = hash & (ROUTER_TABLE_SIZE - 1);
+        while (table[slot] >= 0)
+        {
+            const Route &route = routes[table[slot]];
+            if (route.hash == hash && strcmp(route.topic + prefix_length, suffix) == 0)
+                return table[slot];
+            slot = (slot + 1) & (ROUTER_TABLE_SIZE - 1);
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief Invokes the handler of a resolved route with the payload stream.
+     */
+    void invoke(int index, pb_istream_t *stream)
+    {
+        (owner->*routes[index].handler)(stream);
+    }
+
+    uint8_t size() const { return route_count; }
+
+    const char *topic(uint8_t index) const { return routes[index].topic; }
+};
+
+#endif
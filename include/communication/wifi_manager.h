@@ -62,6 +62,21 @@ public:
     {
         return WiFi.status() == WL_CONNECTED;
     }
+
+    // Drops the current association and starts over with new credentials
+    void reconnect(const WiFiConfig &cfg)
+    {
+        config = cfg;
+        retryCount = 0;
+        WiFi.disconnect();
+        WiFi.begin(config.ssid.c_str(), config.password.c_str());
+    }
+
+    // True once every retry of the current credentials has failed
+    bool failed() const
+    {
+        return retryCount > maxRetries;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -2,11 +2,14 @@
 #define RELAY_CONTROL_H
 
 #include <communication/serial_module.h>
+#include <services/scheduler.h>
 
 // Constants for relay commands
 #define TOGGLE_RELAY 1
 #define GET_RELAY_STATE 2
 
+#define RELAY_POLL_INTERVAL 20 // ms
+
 // Constants for relay types
 #define LOW_DUTY 1   // 10A, 4 switches
 #define HEAVY_DUTY 2 // 30A, 2 switches
@@ -73,6 +76,12 @@ public:
      * @return true if a response was handled
      */
     bool handleResponses();
+
+    /**
+     * @brief Registers the response polling task
+     * @param scheduler Scheduler driving the main loop
+     */
+    void register_tasks(Scheduler &scheduler);
 };
 
 #endif // RELAY_CONTROL_H
\ No newline at end of file
@@ -3,6 +3,44 @@
 
 #include <MFRC522.h>
 
+#ifndef RFID_IRQ_PIN
+#define RFID_IRQ_PIN -1 ///< Pin wired to the MFRC522 IRQ output; -1 if it is not connected
+#endif
+#define RFID_POLL_MIN_MS 20      ///< Polling interval while cards are being presented
+#define RFID_POLL_MAX_MS 200     ///< Polling interval once the reader has been idle for a while
+#define RFID_ACTIVE_HOLD_MS 5000 ///< Time after the last card during which polling stays at the fastest interval
+
+/**
+ * @brief How the reader notices a card.
+ */
+enum class RfidDetection : uint8_t
+{
+    POLLING, ///< PICC_IsNewCardPresent at an interval that backs off while idle
+    IRQ      ///< A REQA is started without waiting; the IRQ line reports the card's answer
+};
+
+/**
+ * @brief Timing of the last successful card read, in microseconds.
+ */
+struct card_timing
+{
+    unsigned long start_us;  ///< micros() when detection started: the PICC_IsNewCardPresent call, or the IRQ
+    unsigned long detect_us; ///< Time spent in PICC_IsNewCardPresent, or from the IRQ until it was served
+    unsigned long read_us;   ///< Time spent in PICC_ReadCardSerial
+};
+
+/**
+ * @brief Reader traffic counters; busy_us over elapsed time is the reader's share of the loop.
+ */
+struct RfidStats
+{
+    uint32_t polls;        ///< PICC_IsNewCardPresent calls
+    uint32_t skipped;      ///< read_card() calls that did not touch the reader
+    uint32_t kicks;        ///< REQA commands started in IRQ mode
+    uint32_t interrupts;   ///< Answers reported by the IRQ line
+    unsigned long busy_us; ///< Time spent in reader calls
+};
+
 /**
  * @brief RFID module wrapper for the MFRC522 RFID reader.
  *
@@ -14,6 +52,27 @@ class RFID
 {
 private:
     MFRC522 *rfid; ///< Pointer to dynamically allocated MFRC522 instance
+    card_timing timing = {0};
+    RfidDetection detection = RfidDetection::POLLING;
+    unsigned long poll_interval_ms = RFID_POLL_MIN_MS;
+    unsigned long last_poll_ms = 0;
+    unsigned long last_card_ms = 0;
+    RfidStats stats = {0};
+
+    /**
+     * @brief Polled detection: checks for a card when the adaptive interval has elapsed.
+     */
+    bool poll_card();
+
+    /**
+     * @brief IRQ detection: reads the card that answered, or starts the next REQA.
+     */
+    bool serve_irq();
+
+    /**
+     * @brief Reads the UID of a card that answered, then halts it.
+     */
+    bool read_serial(unsigned long start);
 
 public:
     /**
@@ -44,11 +103,13 @@ public:
      * @brief Initializes the RFID reader and associates an authenticator.
      *
      * This method initializes SPI communication and allocates the MFRC522
-     * instance using fixed pins (SS = 4, RST = 2).
+     * instance using fixed pins (SS = 4, RST = 2). If an IRQ pin is given, the
+     * receive interrupt is enabled and cards are detected through it.
      *
+     * @param irq_pin Pin wired to the MFRC522 IRQ output; -1 polls the reader
      * @return true if the initialization was successful.
      */
-    bool init();
+    bool init(int irq_pin = RFID_IRQ_PIN);
 
     /**
      * @brief Attempts to read a card and authenticate it.
@@ -59,6 +120,15 @@ public:
      * @return true if an authorized card was successfully read; false otherwise.
      */
     bool read_card();
+
+    /**
+     * @brief Returns how long each reader call took during the last successful read_card().
+     */
+    const card_timing &get_timing() const { return timing; }
+
+    RfidDetection get_detection() const { return detection; }
+    unsigned long get_poll_interval() const { return poll_interval_ms; }
+    const RfidStats &get_stats() const { return stats; }
 };
 
 #endif // RFID_H
@@ -24,9 +24,10 @@ private:
     float humidity;        ///< Last recorded relative humidity (%)
     int air_quality_index; ///< Last recorded air quality index (integer value)
 
-    Mux *mux;                            ///< Pointer to a shared Mux instance
-    DHT *dht_sensor;                     ///< Pointer to DHT sensor instance
-    AirQualitySensor air_quality_sensor; ///< Instance of the air quality sensor
+    Mux *mux;                                      ///< Pointer to a shared Mux instance
+    DHT *dht_sensor;                               ///< DHT sensor constructed in dht_storage, nullptr before init()
+    alignas(DHT) uint8_t dht_storage[sizeof(DHT)]; ///< In-place storage, so init() never allocates
+    AirQualitySensor air_quality_sensor;           ///< Instance of the air quality sensor
 
 public:
     /**
@@ -35,7 +36,7 @@ public:
     Climate();
 
     /**
-     * @brief Destructor. Frees dynamically allocated memory.
+     * @brief Destructor. Destroys the DHT sensor.
      */
     ~Climate();
 
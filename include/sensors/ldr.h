@@ -17,7 +17,7 @@ public:
     /**
      * @brief Constructs an LDR sensor object.
      */
-    LDR() : _analog_pin(A0) {} // Default pin and threshold
+    LDR() : id(-1), _analog_pin(A0) {} // Default pin and threshold
 
     /**
      * @brief Initializes the LDR pin as input.
@@ -31,6 +31,12 @@ public:
      */
     int get_id() const;
 
+    /**
+     * @brief Returns the analog pin the LDR is read from.
+     * @return The analog pin of the LDR.
+     */
+    uint8_t get_port() const;
+
     /**
      * @brief Reads the current analog value from the LDR.
      * @return The raw analog value from the LDR.
@@ -19,12 +19,23 @@ private:
 
     Mux *_mux; ///< Pointer to the Mux object for channel selection
 
+    unsigned long debounce_ms;  ///< Time the raw input must be stable before it is accepted
+    unsigned long hold_ms;      ///< Occupancy timeout after the last accepted motion
+    bool candidate;             ///< Last raw reading
+    unsigned long candidate_ms; ///< Time the raw reading last changed
+    unsigned long edge_us;      ///< micros() when the raw reading last changed
+    bool stable;                ///< Debounced input state
+    bool occupied;              ///< Occupancy state reported to callers
+    unsigned long last_seen_ms; ///< Time motion was last accepted
+
 public:
     /**
      * @brief Default constructor for the PIR class.
      */
     PIR()
-        : id(-1), _port(-1), movement(false), _mux(nullptr) {} // Default values
+        : id(-1), _port(-1), movement(false), _mux(nullptr),
+          debounce_ms(0), hold_ms(0), candidate(false), candidate_ms(0), edge_us(0),
+          stable(false), occupied(false), last_seen_ms(0) {} // Default values
     /**
      * @brief Destructor for the PIR class.
      */
@@ -68,6 +79,32 @@ public:
      * to monitor motion status in real-time.
      */
     void detect_movement();
+
+    /**
+     * @brief Sets the debounce time and occupancy timeout used by poll().
+     * @param debounce_ms Time the raw input must be stable before it is accepted.
+     * @param hold_ms Time occupancy is kept after the last accepted motion.
+     */
+    void configure(unsigned long debounce_ms, unsigned long hold_ms);
+
+    /**
+     * @brief Samples the sensor and updates the debounced occupancy state.
+     * @param now Current time in milliseconds.
+     * @return True if the occupancy state changed.
+     */
+    bool poll(unsigned long now);
+
+    /**
+     * @brief Returns the occupancy state computed by poll().
+     * @return True while motion is present or within the hold time.
+     */
+    bool is_occupied() const;
+
+    /**
+     * @brief Returns when the raw input last changed, for latency measurements.
+     * @return Value of micros() at the last raw edge.
+     */
+    unsigned long get_edge_us() const;
 };
 
 #endif // PIR_H
@@ -0,0 +1,151 @@
+#ifndef ACCESS_JOURNAL_H
+#define ACCESS_JOURNAL_H
+
+#include <Arduino.h>
+#include <communication/mqtt_manager.h>
+#include <services/scheduler.h>
+#include <services/storage_manager.h>
+#include <services/system_clock.h>
+
+#define JOURNAL_MAGIC 0x4A524E4CUL     ///< Marks a formatted access log partition
+#define JOURNAL_BATCH 8                ///< Events per AccessLog message
+#define JOURNAL_UPLOAD_INTERVAL 1000UL ///< Period of the upload retry in milliseconds
+
+/**
+ * @brief Why an access decision was taken. The order matches transporter_AccessReason.
+ */
+enum class AccessReason : uint8_t
+{
+    LISTED,         ///< Listed and inside its access window
+    NOT_LISTED,     ///< Not on the whitelist
+    OUTSIDE_WINDOW, ///< Listed, but outside its access window
+    CLOCK_UNSYNCED, ///< Listed with an access window, but the time is unknown
+    REGISTRATION    ///< Presented in registration mode and sent for registration
+};
+
+/**
+ * @struct journal_header
+ * @brief Start of the access log partition. The upload cursor is stored with its complement so a
+ *        torn update is detected.
+ */
+struct journal_header
+{
+    uint32_t magic;      ///< JOURNAL_MAGIC once formatted
+    uint16_t sent_seq;   ///< Sequence number of the last uploaded event
+    uint16_t sent_check; ///< ~sent_seq
+};
+
+/**
+ * @struct journal_entry
+ * @brief One access event. The check byte is written last and covers the other bytes, so an entry
+ *        torn by a power cut is ignored.
+ */
+struct journal_entry
+{
+    uint32_t uid_digest; ///< FNV-1a of the UID; the UID itself is not stored
+    uint32_t timestamp;  ///< Unix time, or 0 if the clock was not synced
+    uint16_t seq;        ///< Incremented for every event; the highest valid one is the newest
+    uint8_t code;        ///< Bit 7: access granted; bits 0-6: AccessReason
+    uint8_t check;
+};
+
+#define JOURNAL_CAPACITY ((partition_size(Partition::ACCESS_LOG) - sizeof(journal_header)) / sizeof(journal_entry))
+
+static_assert(JOURNAL_CAPACITY >= JOURNAL_BATCH, "the access log must hold at least one batch");
+
+/**
+ * @brief Counters describing the journal.
+ */
+struct JournalStats
+{
+    uint32_t appended;    ///< Events written
+    uint32_t uploaded;    ///< Events handed to the MQTT queue
+    uint32_t overwritten; ///< Events overwritten before they were uploaded
+};
+
+/**
+ * @class AccessJournal
+ * @brief Persistent ring of access events, uploaded in batches while the broker is reachable.
+ *
+ * Appending writes one fixed-size entry into the next slot, so it takes constant time and never
+ * rewrites a header. The newest entry is found at boot by scanning the sequence numbers. Only the
+ * upload cursor lives in the header; it is advanced once per batch, so an event is sent once even
+ * across reboots. When the ring is full the oldest event is overwritten, uploaded or not.
+ */
+class AccessJournal
+{
+private:
+    StorageManager *storage = nullptr;
+    MQTTManager *mqtt = nullptr;
+    const SystemClock *clock = nullptr;
+    String topic;
+
+    uint16_t newest_seq = 0; ///< Sequence number of the newest entry
+    uint8_t newest_slot = 0; ///< Slot holding the newest entry
+    uint8_t stored = 0;      ///< Valid entries, at most JOURNAL_CAPACITY
+    uint16_t sent_seq = 0;   ///< Sequence number of the last uploaded event
+    JournalStats stats = {0};
+
+    /**
+     * @brief Finds the newest entry and the upload cursor, formatting the partition if needed.
+     */
+    void load();
+
+    /**
+     * @brief Clears every entry and the cursor.
+     */
+    void format();
+
+    /**
+     * @brief Returns the offset of a slot in the partition.
+     */
+    static uint16_t slot_offset(uint8_t slot) { return sizeof(journal_header) + slot * sizeof(journal_entry); }
+
+    /**
+     * @brief Computes the check byte of an entry.
+     */
+    static uint8_t checksum(const journal_entry &entry);
+
+    /**
+     * @brief Persists the upload cursor.
+     */
+    void put_cursor(uint16_t seq);
+
+public:
+    /**
+     * @brief Loads the journal.
+     * @param storage Storage owning the access log partition
+     * @param mqtt Broker connection used for uploads
+     * @param clock Source of the event timestamps
+     * @param device_uid Device id used in the upload topic
+     */
+    void init(StorageManager *storage, MQTTManager *mqtt, const SystemClock *clock, const String &device_uid);
+
+    /**
+     * @brief Appends an event and uploads it right away if the broker is reachable.
+     * @param uid_digest Digest of the presented UID
+     * @param granted Whether access was granted
+     * @param reason Why
+     */
+    void append(uint32_t uid_digest, bool granted, AccessReason reason);
+
+    /**
+     * @brief Uploads the oldest pending events as one AccessLog message if the broker is reachable.
+     * @return true if a batch was queued
+     */
+    bool upload();
+
+    /**
+     * @brief Returns the number of events not uploaded yet.
+     */
+    uint8_t pending() const;
+
+    /**
+     * @brief Registers the periodic upload retry.
+     */
+    void register_tasks(Scheduler &scheduler);
+
+    const JournalStats &get_stats() const { return stats; }
+};
+
+#endif // ACCESS_JOURNAL_H
@@ -0,0 +1,45 @@
+/**
+ * @file board_profile.h
+ * @brief Module capacities of the board the firmware is built for.
+ *
+ * Everything sized by the number of modules derives from BOARD_PROFILE: the config_data layout, the
+ * dirty record mask, SensorManager's module arrays and the compiled rule table. The FullConfig
+ * message has no fixed counts and is checked against the profile while it is decoded. Changing a
+ * capacity is a one-line edit here; the static_asserts below and next to the users of the profile
+ * reject a build whose footprint no longer fits.
+ */
+
+#ifndef BOARD_PROFILE_H
+#define BOARD_PROFILE_H
+
+#include <Arduino.h>
+
+#define MUX_SELECT_PINS 4                    ///< Selection pins wired to the CD74HC4067
+#define MUX_CHANNELS (1 << MUX_SELECT_PINS) ///< Channels the PIRs and climate modules share
+
+/**
+ * @struct board_profile
+ * @brief Number of modules of each type the configuration and SensorManager hold.
+ */
+struct board_profile
+{
+    uint8_t climates;    ///< Climate modules (DHT22, AQI sensor and optional buzzer)
+    uint8_t ldrs;        ///< LDRs, each on its own analog pin
+    uint8_t motions;     ///< PIRs, each on a mux channel
+    uint8_t rules;       ///< Threshold rules
+    uint16_t ram_budget; ///< Bytes the configuration and SensorManager, with its module pools, may take in RAM
+};
+
+// The largest PIR build keeps two climate modules on the mux: {2, 2, 14, 8, 4096}
+constexpr board_profile BOARD_PROFILE = {2, 2, 4, 8, 4096};
+
+constexpr uint8_t MAX_CLIMATE = BOARD_PROFILE.climates;
+constexpr uint8_t MAX_LDR = BOARD_PROFILE.ldrs;
+constexpr uint8_t MAX_MOTION = BOARD_PROFILE.motions;
+constexpr uint8_t MAX_RULES = BOARD_PROFILE.rules;
+
+static_assert(MAX_CLIMATE > 0 && MAX_LDR > 0 && MAX_MOTION > 0 && MAX_RULES > 0,
+              "zero-length module arrays are not supported");
+static_assert(MAX_MOTION + MAX_CLIMATE <= MUX_CHANNELS, "every PIR and climate module needs its own mux channel");
+
+#endif // BOARD_PROFILE_H
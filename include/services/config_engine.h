@@ -4,43 +4,59 @@
  *
  * This module provides structured management of configuration for various IoT sensors and actuators,
  * including Climate sensors (DHT22, AQI, Buzzer), LDR sensors, Motion sensors, and Relays.
- * It uses EEPROM for persistent storage and supports versioning and structure validation.
+ * It persists through the StorageManager "modules" partition and supports versioning and structure validation.
+ * Configurations written by older firmware are upgraded at boot by a chain of migrations, one per
+ * schema version, instead of being reset.
  */
 
 #ifndef CONFIG_ENGINE_H
 #define CONFIG_ENGINE_H
 
-#include <EEPROM.h>
+#include <services/board_profile.h>
+#include <services/scheduler.h>
+#include <services/storage_manager.h>
 
-// EEPROM configuration
-#define EEPROM_SIZE 1024    ///< Total EEPROM size in bytes
-#define EEPROM_ADDRESS 1024 ///< Starting address for config data in EEPROM
+#define CONFIG_VERSION 2 ///< Bumped whenever the layout of config_data changes; add a migration with it
 
-#define MAX_CLIMATE 2
-#define MAX_LDR 2
-#define MAX_MOTION 4
+#define CONFIG_COMMIT_DELAY 2000UL      ///< Quiet time after the last change before it is committed, in milliseconds
+#define CONFIG_COMMIT_MAX_DELAY 10000UL ///< Longest a change waits for a commit during a steady stream of updates
+#define CONFIG_COMMIT_POLL 250UL        ///< Period of the commit check in milliseconds
 
 /**
  * @struct climate
  * @brief Configuration structure for climate modules.
+ *
+ * Deadbands are in tenths of the reading's unit, or in tenths of a percent of the last
+ * published value when relative_deadband is set. A deadband of 0 publishes any change of its value,
+ * and a module whose deadbands are all 0 publishes every reading.
  */
 typedef struct _c
 {
-    uint8_t id;          ///< Unique identifier
-    uint8_t dht22_port;  ///< DHT22 sensor port
-    uint8_t aqi_port;    ///< AQI sensor port
-    bool has_buzzer;     ///< Flag to indicate buzzer usage
-    uint8_t buzzer_port; ///< Buzzer port (valid only if has_buzzer is true)
+    uint8_t id;                    ///< Unique identifier
+    uint8_t dht22_port;            ///< DHT22 sensor port
+    uint8_t aqi_port;              ///< AQI sensor port
+    bool has_buzzer;               ///< Flag to indicate buzzer usage
+    uint8_t buzzer_port;           ///< Buzzer port (valid only if has_buzzer is true)
+    bool relative_deadband;        ///< Deadbands are relative to the last published value
+    uint16_t temperature_deadband; ///< Temperature change needed to publish
+    uint16_t humidity_deadband;    ///< Humidity change needed to publish
+    uint16_t aqi_deadband;         ///< AQI change needed to publish
+    uint16_t max_silent_s;         ///< Longest interval without a publish (0 disables)
 } climate;
 
 /**
  * @struct ldr
  * @brief Configuration structure for LDR sensors.
+ *
+ * The deadband follows the same rules as the climate deadbands.
  */
 typedef struct _l
 {
-    uint8_t id;   ///< Unique identifier
-    uint8_t port; ///< Analog pin used by LDR
+    uint8_t id;             ///< Unique identifier
+    uint8_t port;           ///< Analog pin used by LDR
+    bool relative_deadband; ///< Deadband is relative to the last published value
+    uint16_t deadband;      ///< Light change needed to publish
+    uint16_t max_silent_s;  ///< Longest interval without a publish (0 disables)
 } ldr;
 
 /**
@@ -49,12 +65,35 @@ typedef struct _l
  */
 typedef struct _m
 {
-    uint8_t id;         ///< Unique identifier
-    uint8_t port;       ///< PIR sensor pin
-    uint8_t relay_port; ///< ID of the associated relay
-    uint8_t relay_type; ///< Channel index of associated relay
+    uint8_t id;            ///< Unique identifier
+    uint8_t port;          ///< PIR sensor pin
+    uint8_t relay_port;    ///< ID of the associated relay
+    uint8_t relay_type;    ///< Channel index of associated relay
+    bool local_automation; ///< Drive the relay directly on occupancy changes
+    uint16_t debounce_ms;  ///< Time the raw input must be stable before it is accepted (0 disables)
+    uint16_t hold_s;       ///< Occupancy (and a locally driven relay) is kept this long after the last motion
+    uint16_t heartbeat_s;  ///< Interval for re-publishing an unchanged state (0 disables)
 } motion;
 
+/**
+ * @struct rule
+ * @brief Threshold rule mapping a sensor reading to an action.
+ *
+ * Field values follow the RuleSensor, RuleComparator and RuleAction enums of transporter.proto.
+ */
+typedef struct _r
+{
+    uint8_t id;         ///< Unique identifier
+    uint8_t sensor;     ///< Reading the rule watches (temperature, humidity, AQI, light)
+    uint8_t sensor_id;  ///< ID of the climate or LDR sensor
+    uint8_t comparator; ///< Fires above or below the threshold
+    uint8_t action;     ///< Buzzer, relay or publish
+    uint8_t port;       ///< Buzzer mux port or relay port
+    uint8_t relay_type; ///< Relay type for relay actions
+    float threshold;    ///< Value at which the rule becomes active
+    float hysteresis;   ///< Distance back past the threshold before the rule clears
+} rule;
+
 /**
  * @struct config_data
  * @brief Main configuration container for all sensor and relay settings.
@@ -62,37 +101,97 @@ typedef struct _m
 typedef struct _config_data
 {
     uint8_t version;               ///< Configuration schema version
-    uint8_t size;                  ///< Size of this structure
+    uint8_t reserved;              ///< Keeps size aligned; always 0
+    uint16_t size;                 ///< Size of this structure
     uint8_t climate_size;          ///< Number of climate configs
     uint8_t ldr_size;              ///< Number of LDR configs
     uint8_t motion_size;           ///< Number of motion configs
     uint8_t relay_size;            ///< Number of relay configs
+    uint8_t rule_size;             ///< Number of rules
     climate climates[MAX_CLIMATE]; ///< Climate config array
     ldr ldrs[MAX_LDR];             ///< LDR config array
     motion motions[MAX_MOTION];    ///< Motion sensor config array
+    rule rules[MAX_RULES];         ///< Rule array
 } config_data;
 
 // Default configuration structure
 const config_data default_config = {
-    1,                   // version
+    CONFIG_VERSION,      // version
+    0,                   // reserved
     sizeof(config_data), // size
     0,                   // climate_size
     0,                   // ldr_size
     0,                   // motion_size
     0,                   // relay_size
+    0,                   // rule_size
     {},                  // climates
     {},                  // ldrs
     {},                  // motions
+    {},                  // rules
+};
+
+// Bits of the dirty mask: the header fields, then one per array slot
+#define CONFIG_RECORD_HEADER 0
+#define CONFIG_RECORD_CLIMATES 1
+#define CONFIG_RECORD_LDRS (CONFIG_RECORD_CLIMATES + MAX_CLIMATE)
+#define CONFIG_RECORD_MOTIONS (CONFIG_RECORD_LDRS + MAX_LDR)
+#define CONFIG_RECORD_RULES (CONFIG_RECORD_MOTIONS + MAX_MOTION)
+#define CONFIG_RECORD_COUNT (CONFIG_RECORD_RULES + MAX_RULES)
+
+static_assert(CONFIG_RECORD_COUNT <= 32, "the dirty mask is a uint32_t");
+static_assert(sizeof(config_data) <= partition_capacity(Partition::MODULES), "config_data does not fit the modules partition");
+
+/**
+ * @brief Counters comparing configuration changes with the commits they caused.
+ */
+struct ConfigStats
+{
+    uint32_t updates;   ///< Set and delete calls
+    uint32_t unchanged; ///< Updates that matched the stored value and dirtied nothing
+    uint32_t commits;   ///< Writes of the modules partition
+    uint32_t records;   ///< Dirty records covered by those writes
+
+    uint8_t migrated_from;    ///< Schema version upgraded at boot, 0 if the stored one was current
+    unsigned long migrate_us; ///< Time the upgrade took, including reading the old copy
 };
 
 /**
  * @class ConfigEngine
- * @brief Class to manage sensor and relay configurations via EEPROM.
+ * @brief Class to manage sensor and relay configurations via the StorageManager.
+ *
+ * Setters and deletes only change the in-memory copy and mark the records they touched. The
+ * partition is written once the changes have been quiet for CONFIG_COMMIT_DELAY, so a burst of
+ * updates costs one commit; the StorageManager then programs only the bytes that differ.
  */
 class ConfigEngine
 {
 private:
-    config_data *_config; ///< Internal pointer to config data
+    config_data *_config;              ///< Internal pointer to config data
+    StorageManager *storage = nullptr; ///< Owner of the modules partition
+    uint32_t dirty = 0;                ///< Records changed since the last commit, one bit per CONFIG_RECORD_*
+    unsigned long first_change = 0;    ///< millis() of the oldest uncommitted change
+    unsigned long last_change = 0;     ///< millis() of the newest uncommitted change
+    ConfigStats stats = {0};
+
+    /**
+     * @brief Marks records [from, to) of the array starting at record first as changed.
+     */
+    void mark(uint8_t first, uint8_t from, uint8_t to);
+
+    /**
+     * @brief Copies a value into a record and marks it if it differs.
+     */
+    template <typename T>
+    void store(T &slot, const T &value, uint8_t record)
+    {
+        if (memcmp(&slot, &value, sizeof(T)) == 0)
+        {
+            stats.unchanged++;
+            return;
+        }
+        slot = value;
+        mark(record, 0, 1);
+    }
 
 public:
     /**
@@ -108,22 +207,33 @@ public:
     /**
      * @brief Initializes the configuration system.
      *        Loads saved config or creates a default one if invalid.
+     * @param storage Storage manager holding the modules partition.
      * @return true if successful, false if invalid config.
      */
-    bool init();
+    bool init(StorageManager *storage);
 
     /**
-     * @brief Loads configuration from EEPROM.
+     * @brief Loads configuration from the modules partition, upgrading a copy written by older firmware.
      * @return true if config is valid, false otherwise.
      */
     bool load_config();
 
     /**
-     * @brief Saves the current configuration to EEPROM.
+     * @brief Saves the current configuration to the modules partition now and clears the dirty records.
      * @return true if successful, false otherwise.
      */
     bool save_config();
 
+    /**
+     * @brief Commits the dirty records once the changes have been quiet long enough.
+     */
+    void update();
+
+    /**
+     * @brief Registers the commit check with the scheduler.
+     */
+    void register_tasks(Scheduler &scheduler);
+
     /**
      * @brief Sets the default configuration.
      * @return true if valid, false otherwise.
@@ -159,6 +269,13 @@ public:
      */
     bool set_motion_config(motion motion);
 
+    /**
+     * @brief Adds or updates a rule.
+     * @param rule Rule struct to add or update.
+     * @return true if added or updated, false if list is full.
+     */
+    bool set_rule_config(rule rule);
+
     /**
      * @brief Retrieves a climate configuration by ID.
      * @param id Unique identifier of the climate config.
@@ -180,6 +297,13 @@ public:
      */
     motion get_motion_config(uint8_t id);
 
+    /**
+     * @brief Retrieves a rule by ID.
+     * @param id Unique identifier of the rule.
+     * @return rule struct (returns default if not found).
+     */
+    rule get_rule_config(uint8_t id);
+
     /**
      * @brief Deletes a climate configuration by ID.
      * @param id Unique identifier of the climate config to delete.
@@ -198,11 +322,20 @@ public:
      */
     void delete_motion_config(uint8_t id);
 
+    /**
+     * @brief Deletes a rule by ID.
+     * @param id Unique identifier of the rule to delete.
+     */
+    void delete_rule_config(uint8_t id);
+
     /**
      * @brief Returns a pointer to the internal configuration data.
      * @return Pointer to config_data structure.
      */
     config_data *get_configs();
+
+    bool is_dirty() const { return dirty != 0; }
+    const ConfigStats &get_stats() const { return stats; }
 };
 
 #endif // CONFIG_ENGINE_H
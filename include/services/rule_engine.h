@@ -0,0 +1,128 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <Arduino.h>
+#include <services/config_engine.h>
+#include <communication/mqtt_manager.h>
+#include <devices/relay_control.h>
+#include <modules/mux.h>
+#include <transporter.pb.h>
+
+#define RULE_MAX_COMPILED (MAX_RULES + 3 * MAX_CLIMATE) ///< Configured rules plus the default climate alarms
+#define RULE_NO_OUTPUT 0xFF                             ///< Output index of rules that only publish
+#define RULE_DEFAULT_ID 0xFF                            ///< Rule id used for the default climate alarms
+
+/**
+ * @struct RuleStats
+ * @brief Counters describing rule evaluation.
+ */
+struct RuleStats
+{
+    uint32_t evaluations; ///< Rule checks against a sample
+    uint32_t transitions; ///< Rules that became active or cleared
+    uint32_t actions;     ///< Buzzer, relay or publish actions taken
+};
+
+/**
+ * @class RuleEngine
+ * @brief Evaluates threshold rules against sensor samples.
+ *
+ * Rules from ConfigEngine are compiled into a flat table of precomputed thresholds. Each
+ * buzzer or relay output is shared by every rule that drives it and is on while any of them
+ * is active. When no rules are configured, the previous built-in climate alarm (above 35 °C,
+ * 80 % humidity or an AQI of 300) is compiled for every climate module with a buzzer.
+ */
+class RuleEngine
+{
+private:
+    struct CompiledRule
+    {
+        uint8_t id;
+        uint8_t sensor;      ///< transporter_RuleSensor
+        uint8_t sensor_id;   ///< Climate or LDR id
+        uint8_t action;      ///< transporter_RuleAction
+        uint8_t output;      ///< Index in the output table, or RULE_NO_OUTPUT
+        bool above;          ///< Fires above rather than below the threshold
+        bool active;         ///< Current state
+        float on_threshold;  ///< Value past which the rule becomes active
+        float off_threshold; ///< Value the reading must return to before the rule clears
+    };
+
+    struct Output
+    {
+        uint8_t action;       ///< transporter_RuleAction
+        uint8_t port;         ///< Buzzer mux port or relay port
+        uint8_t relay_type;   ///< Relay type for relay outputs
+        uint8_t active_count; ///< Active rules driving this output
+    };
+
+    CompiledRule rules[RULE_MAX_COMPILED];
+    Output outputs[RULE_MAX_COMPILED];
+    uint8_t rule_count = 0;
+    uint8_t output_count = 0;
+
+    Mux *mux = nullptr;
+    RelayControl *relayControl = nullptr;
+    MQTTManager *mqtt = nullptr;
+    char eventTopic[MQTT_MAX_TOPIC_LENGTH];
+    RuleStats stats = {0};
+
+    /**
+     * @brief Appends a rule to the compiled table.
+     * @return false if the table is full
+     */
+    bool add(const rule &r);
+
+    /**
+     * @brief Returns the output shared by rules with the same action and port, adding it if needed.
+     */
+    uint8_t find_output(uint8_t action, uint8_t port, uint8_t relay_type);
+
+    /**
+     * @brief Switches a buzzer or relay output.
+     */
+    void drive(const Output &output, bool on);
+
+    /**
+     * @brief Publishes a RuleEvent for a rule that changed state.
+     */
+    void publish_event(const CompiledRule &r, float value);
+
+public:
+    RuleEngine();
+
+    /**
+     * @brief Sets the devices driven by rule actions.
+     * @param mux Mux used for buzzer outputs
+     * @param relayControl Relay controller used for relay outputs
+     * @param mqtt MQTT manager used for publish actions
+     * @param deviceId Device ID embedded in the event topic
+     */
+    void init(Mux *mux, RelayControl *relayControl, MQTTManager *mqtt, const String &deviceId);
+
+    /**
+     * @brief Rebuilds the rule table from the configuration. Active outputs are switched off.
+     * @param config Configuration holding the rules and climate modules
+     */
+    void compile(const config_data *config);
+
+    /**
+     * @brief Evaluates every rule watching a reading and applies the resulting actions.
+     * @param sensor transporter_RuleSensor of the reading
+     * @param sensor_id Climate or LDR id
+     * @param value Sampled value
+     */
+    void evaluate(uint8_t sensor, uint8_t sensor_id, float value);
+
+    /**
+     * @brief Returns the number of compiled rules.
+     */
+    uint8_t size() const { return rule_count; }
+
+    /**
+     * @brief Returns the evaluation counters.
+     */
+    const RuleStats &get_stats() const { return stats; }
+};
+
+#endif // RULE_ENGINE_H
@@ -0,0 +1,133 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+
+#define SCHEDULER_MAX_TASKS 16    ///< Maximum number of registered tasks
+#define SCHEDULER_MAX_IDLE_MS 100 ///< Upper bound on the idle time returned by run()
+#define SCHEDULER_PROFILE_INTERVAL 60000 ///< Period of the SHAAS_PROFILE report in milliseconds
+
+/**
+ * @brief Task priorities, highest first. Due tasks run in this order.
+ */
+typedef enum
+{
+    TASK_CRITICAL, ///< Access control and other latency-sensitive work
+    TASK_HIGH,     ///< Communication and actuator feedback
+    TASK_NORMAL,   ///< Regular sensor sampling
+    TASK_LOW       ///< Background telemetry
+} task_priority;
+
+/**
+ * @struct TaskStats
+ * @brief Run time and jitter statistics collected for each task.
+ */
+struct TaskStats
+{
+    uint32_t runs;                ///< Number of completed runs
+    unsigned long last_run_us;    ///< Duration of the last run
+    unsigned long max_run_us;     ///< Longest run
+    unsigned long total_run_us;   ///< Accumulated run time
+    unsigned long last_jitter_ms; ///< Delay between deadline (or notification) and start of the last run
+    unsigned long max_jitter_ms;  ///< Largest delay seen
+    uint32_t allocations;         ///< Heap allocations made while running (counted in SHAAS_PROFILE builds)
+};
+
+/**
+ * @class Scheduler
+ * @brief Deadline-driven cooperative scheduler for the main loop.
+ *
+ * Components register periodic tasks (run every `period_ms`) or event tasks (run once after
+ * notify()). Each call to run() executes the due tasks in priority order and returns how long
+ * the caller may idle before the next deadline.
+ */
+class Scheduler
+{
+private:
+    struct Task
+    {
+        const char *name;
+        std::function<void()> callback;
+        unsigned long period_ms; ///< 0 for event tasks
+        unsigned long due_ms;    ///< Next deadline, or notification time for event tasks
+        task_priority priority;
+        bool pending;            ///< Event task has been notified
+        TaskStats stats;
+    };
+
+    Task tasks[SCHEDULER_MAX_TASKS];
+    uint8_t task_count = 0;
+
+    /**
+     * @brief Returns true if a task should run at the given time.
+     */
+    bool is_due(const Task &task, unsigned long now) const;
+
+    /**
+     * @brief Executes a task and records its statistics.
+     */
+    void execute(Task &task, unsigned long now);
+
+public:
+    /**
+     * @brief Registers a task that runs every period.
+     * @param name Static name used in reports
+     * @param period_ms Interval between runs in milliseconds
+     * @param priority Task priority
+     * @param callback Work to execute
+     * @return Task id, or -1 if the task table is full
+     */
+    int add_periodic(const char *name, unsigned long period_ms, task_priority priority, std::function<void()> callback);
+
+    /**
+     * @brief Registers a task that runs only after notify().
+     * @param name Static name used in reports
+     * @param priority Task priority
+     * @param callback Work to execute
+     * @return Task id, or -1 if the task table is full
+     */
+    int add_event(const char *name, task_priority priority, std::function<void()> callback);
+
+    /**
+     * @brief Marks a task as ready to run on the next call to run().
+     * @param id Task id returned at registration
+     */
+    void notify(int id);
+
+    /**
+     * @brief Runs every due task once, in priority order.
+     * @return Milliseconds until the next deadline, capped at SCHEDULER_MAX_IDLE_MS
+     */
+    unsigned long run();
+
+    /**
+     * @brief Returns the number of registered tasks.
+     */
+    uint8_t size() const { return task_count; }
+
+    /**
+     * @brief Returns the name of a task.
+     */
+    const char *get_name(int id) const;
+
+    /**
+     * @brief Returns the statistics of a task.
+     */
+    const TaskStats *get_stats(int id) const;
+
+    /**
+     * @brief Clears the statistics of every task.
+     */
+    void reset_stats();
+
+    /**
+     * @brief Prints one line per task with its run count, average and worst run time, worst jitter and
+     *        heap allocations.
+     * @param out Destination, usually Serial
+     * @param window_ms Time covered by the statistics, used to compute each task's CPU share
+     */
+    void report(Print &out, unsigned long window_ms) const;
+};
+
+#endif // SCHEDULER_H
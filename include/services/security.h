@@ -4,6 +4,48 @@
 #include <modules/rfid.h>
 #include <devices/lock.h>
 #include <services/whitelist_manager.h>
+#include <services/scheduler.h>
+
+#define AUTH_METRICS_INTERVAL 300000UL ///< Period of the AuthMetrics report in milliseconds
+#define LATENCY_BUCKETS 12             ///< Bucket i counts durations below 128 << i microseconds; the last one is open-ended
+
+/**
+ * @brief Stages of the card-to-unlock pipeline. The order matches transporter_AuthStage.
+ */
+enum class AuthStage : uint8_t
+{
+    CARD_DETECT,      ///< PICC_IsNewCardPresent
+    CARD_READ,        ///< PICC_ReadCardSerial
+    WHITELIST_LOOKUP, ///< Whitelist decision
+    LOCK_COMMAND,     ///< Servo write
+    CARD_TO_UNLOCK,   ///< From the start of the card detection to the servo write
+    COUNT
+};
+
+/**
+ * @struct LatencyHistogram
+ * @brief Durations of one stage in fixed power-of-two buckets, so recording needs no floating point.
+ */
+struct LatencyHistogram
+{
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+};
+
+/**
+ * @struct AccessStats
+ * @brief Card-to-decision timing, from a completed card read to the lock command.
+ */
+struct AccessStats
+{
+    uint32_t decisions;
+    uint32_t granted;
+    unsigned long last_decision_us;
+    unsigned long max_decision_us;
+    LatencyHistogram latency[(uint8_t)AuthStage::COUNT]; ///< Cleared after every AuthMetrics report
+};
 
 /**
  * @class Security
@@ -16,20 +58,38 @@ private:
     RFID *rfid;                  ///< Pointer to RFID module
     Lock *lock;                  ///< Pointer to Lock module
     WhiteListManager *whitelist; ///< Pointer to WhiteListManager for authentication/registration
+    MQTTManager *mqtt = nullptr; ///< Publishes the AuthMetrics reports
+    String metrics_topic;
 
     bool _awaiting_auth_response = false;
     bool _awaiting_register_response = false;
     bool _register_mode = false; ///< Flag for registration mode
     uint32_t _operation_start_time = 0;
     static constexpr uint32_t TIMEOUT = 3000; // Timeout for async responses
+    static constexpr uint32_t POLL_INTERVAL = 20; // Card reader polling interval
+    AccessStats stats = {0};
+    unsigned long metrics_window_start = 0;
+
+    /**
+     * @brief Adds a duration to the histogram of a stage.
+     */
+    void record(AuthStage stage, unsigned long us);
+
+    /**
+     * @brief Publishes the stage histograms as AuthMetrics and starts a new window.
+     */
+    void publish_metrics();
 
 public:
     Security(WhiteListManager *whitelist);
     ~Security();
 
-    bool init(WhiteListManager *whitelist);
+    bool init(WhiteListManager *whitelist, MQTTManager *mqtt, const String &device_uid);
     void enable_register_mode();
     void handle();
+    void register_tasks(Scheduler &scheduler);
+    const AccessStats &get_stats() const { return stats; }
+    const RFID &get_reader() const { return *rfid; }
 };
 
 #endif // SECURITY_H
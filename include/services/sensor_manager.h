@@ -4,14 +4,54 @@
 #include <Arduino.h>
 #include <services/config_engine.h>
 #include <communication/mqtt_manager.h>
+#include <devices/relay_control.h>
+#include <services/scheduler.h>
+#include <services/rule_engine.h>
 #include <sensors/climate.h>
 #include <sensors/ldr.h>
 #include <sensors/pir.h>
 #include <modules/mux.h>
+#include <utils/object_pool.h>
 #include <utils/protobuf.h>
 #include <pb_encode.h>
 #include <transporter.pb.h>
 
+#ifndef TELEMETRY_BATCHED
+#define TELEMETRY_BATCHED 0 ///< 1 publishes one TelemetryBatch per sampling window instead of one message per reading
+#endif
+
+/**
+ * @brief How sensor readings are published.
+ */
+enum class TelemetryMode
+{
+    PER_READING, ///< One message per reading on the per-type topics
+    BATCHED      ///< One TelemetryBatch per sampling window on `arduino/<id>/telemetry`
+};
+
+/**
+ * @struct AutomationStats
+ * @brief Counters for relays driven locally by motion sensors
+ */
+struct AutomationStats
+{
+    uint32_t actuations;           ///< Relay commands sent
+    uint32_t failures;             ///< Relay commands that could not be sent
+    unsigned long last_latency_us; ///< PIR edge to serial command, last switch-on
+    unsigned long max_latency_us;  ///< PIR edge to serial command, worst case
+};
+
+/**
+ * @struct ReconcileStats
+ * @brief Module changes applied at runtime by reconcile()
+ */
+struct ReconcileStats
+{
+    uint32_t added;   ///< Modules created for new sensor IDs
+    uint32_t removed; ///< Modules deleted because their ID left the configuration
+    uint32_t moved;   ///< Modules kept but switched to a new port
+};
+
 /**
  * @class SensorManager
  * @brief Manages sensor operations based on configuration from ConfigEngine
@@ -19,6 +59,7 @@
  * This class handles:
  * - Reading from configured sensors (Climate, LDR, Motion)
  * - Processing sensor data
+ * - Evaluating threshold rules (see RuleEngine)
  * - Publishing data to appropriate MQTT topics
  */
 class SensorManager
@@ -26,35 +67,71 @@ class SensorManager
 private:
     ConfigEngine *configEngine;
     MQTTManager *mqtt;
+    RelayControl *relayControl;
     String deviceId;
     Mux *mux;
+    RuleEngine ruleEngine;
+
+    // Sensor modules live in fixed pools sized by the board profile, so reconciling never uses the heap
+    ObjectPool<Climate, MAX_CLIMATE> climatePool;
+    ObjectPool<LDR, MAX_LDR> ldrPool;
+    ObjectPool<PIR, MAX_MOTION> pirPool;
 
     // Sensor module arrays
     Climate *climateModules[MAX_CLIMATE] = {nullptr};
     LDR *ldrModules[MAX_LDR] = {nullptr};
     PIR *pirModules[MAX_MOTION] = {nullptr};
+    unsigned long lastMotionReport[MAX_MOTION] = {0};
 
-    // Sensor reading timestamps
-    unsigned long lastClimateReadTime = 0;
-    unsigned long lastLdrReadTime = 0;
-    unsigned long lastMotionReadTime = 0;
+    // Last published values, used for report-by-exception
+    struct ClimateReport
+    {
+        float temperature;
+        float humidity;
+        uint32_t aqi;
+        unsigned long time;
+        bool valid;
+    };
+    struct LdrReport
+    {
+        uint32_t value;
+        unsigned long time;
+        bool valid;
+    };
+    ClimateReport climateReports[MAX_CLIMATE] = {};
+    LdrReport ldrReports[MAX_LDR] = {};
+    uint32_t suppressedReadings = 0;
+    AutomationStats automationStats = {0};
+    ReconcileStats reconcileStats = {0};
+
+    // Batched telemetry. The batch counts are fixed in transporter.proto; a sample that finds its array
+    // full sends the batch early, so a board larger than the default profile splits a window over
+    // several messages
+    TelemetryMode telemetryMode = TelemetryMode::PER_READING;
+    transporter_TelemetryBatch batch = transporter_TelemetryBatch_init_zero;
+    char telemetryTopic[MQTT_MAX_TOPIC_LENGTH];
+
+    // Per-reading topics, built once so publishing does not allocate
+    char climateTopic[MQTT_MAX_TOPIC_LENGTH];
+    char ldrTopic[MQTT_MAX_TOPIC_LENGTH];
+    char relayTopic[MQTT_MAX_TOPIC_LENGTH];
 
     // Constants
     const unsigned long SENSOR_READ_INTERVAL = 5000; // 5 seconds
-    const unsigned long SENSOR_READ_INTERVAL_MOTION = 100;
+    const unsigned long SENSOR_READ_INTERVAL_MOTION = 20; // sampling only, publishes happen on edges
 
     /**
-     * @brief Read climate sensors and publish data
+     * @brief Read climate sensors and publish readings that left their deadband
      */
     void processClimateSensors();
 
     /**
-     * @brief Read LDR sensors and publish data
+     * @brief Read LDR sensors and publish readings that left their deadband
      */
     void processLdrSensors();
 
     /**
-     * @brief Check motion sensors and publish data if motion detected
+     * @brief Poll motion sensors and publish occupancy changes and heartbeats
      */
     void processMotionSensors();
 
@@ -83,11 +160,43 @@ private:
     void publishRelayState(uint8_t type, uint8_t port, uint8_t state);
 
     /**
-     * @brief Set buzzer state through mux
-     * @param port Mux channel for buzzer
-     * @param state Buzzer state (HIGH/LOW)
+     * @brief Publish the occupancy state of a motion sensor
+     * @param index Index of the sensor in the motion configuration
+     * @param occupied Occupancy state
+     */
+    void reportMotion(int index, bool occupied);
+
+    /**
+     * @brief Drive the relay of a motion sensor directly and record the edge-to-command latency
+     * @param index Index of the sensor in the motion configuration
+     * @param occupied Occupancy state
+     */
+    void actuateRelay(int index, bool occupied);
+
+    /**
+     * @brief Returns the offset of a new sample from the start of the current batch window
      */
-    void setBuzzerState(uint8_t port, uint8_t state);
+    uint32_t batchOffset();
+
+    /**
+     * @brief Append a climate reading to the current batch
+     */
+    void addClimateSample(uint8_t id, float temperature, float humidity, uint32_t aqi);
+
+    /**
+     * @brief Append an LDR reading to the current batch
+     */
+    void addLdrSample(uint8_t id, uint32_t value);
+
+    /**
+     * @brief Append a motion state change to the current batch
+     */
+    void addMotionSample(uint8_t id, bool detected);
+
+    /**
+     * @brief Publish the current batch, if it holds any samples, and start a new window
+     */
+    void flushTelemetryBatch();
 
 public:
     /**
@@ -105,15 +214,67 @@ public:
      * @param configEngine Pointer to ConfigEngine instance
      * @param mqtt Pointer to MQTTManager instance
      * @param mux Pointer to Mux instance
+     * @param relayControl Pointer to RelayControl instance used by local automation
      * @param deviceId Device ID string
      * @return True if initialization successful
      */
-    bool init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux, const String &deviceId);
+    bool init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux, RelayControl *relayControl, const String &deviceId);
+
+    /**
+     * @brief Register the climate, LDR and motion sampling tasks
+     * @param scheduler Scheduler driving the main loop
+     */
+    void register_tasks(Scheduler &scheduler);
+
+    /**
+     * @brief Select per-reading or batched publishing. Pending samples are flushed first.
+     * @param mode Telemetry mode
+     */
+    void set_telemetry_mode(TelemetryMode mode);
+
+    /**
+     * @brief Create, delete and re-port modules so they match the configuration, and recompile the
+     *        threshold rules. Called after every configuration change instead of a reboot.
+     */
+    void reconcile();
+
+    /**
+     * @brief Returns the rule engine evaluating the sensor readings
+     */
+    const RuleEngine &get_rule_engine() const { return ruleEngine; }
 
     /**
-     * @brief Update method to be called in the main loop
+     * @brief Returns the number of readings not published because they stayed within their deadband
      */
-    void update();
+    uint32_t get_suppressed_count() const { return suppressedReadings; }
+
+    /**
+     * @brief Returns the local motion-to-relay automation counters
+     */
+    const AutomationStats &get_automation_stats() const { return automationStats; }
+
+    /**
+     * @brief Returns the module changes applied by reconcile()
+     */
+    const ReconcileStats &get_reconcile_stats() const { return reconcileStats; }
+
+    /**
+     * @brief Returns the occupancy of the climate module pool
+     */
+    const PoolStats &get_climate_pool_stats() const { return climatePool.get_stats(); }
+
+    /**
+     * @brief Returns the occupancy of the LDR module pool
+     */
+    const PoolStats &get_ldr_pool_stats() const { return ldrPool.get_stats(); }
+
+    /**
+     * @brief Returns the occupancy of the PIR module pool
+     */
+    const PoolStats &get_pir_pool_stats() const { return pirPool.get_stats(); }
 };
 
+static_assert(sizeof(config_data) + sizeof(SensorManager) <= BOARD_PROFILE.ram_budget,
+              "the board profile's modules exceed its RAM budget");
+
 #endif // SENSOR_MANAGER_H
\ No newline at end of file
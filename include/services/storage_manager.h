@@ -0,0 +1,292 @@
+#ifndef STORAGE_MANAGER_H
+#define STORAGE_MANAGER_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#define STORAGE_SIZE 8192          ///< Data flash exposed through EEPROM on the UNO R4 WiFi
+#define STORAGE_MAGIC 0x53484153UL ///< Marks a written blob partition header
+
+/**
+ * @brief Named regions of persistent storage. The order matches STORAGE_LAYOUT.
+ */
+enum class Partition : uint8_t
+{
+    NETWORK,          ///< Provisioning JSON written by ConfigManager
+    LEGACY_WHITELIST, ///< Pre-log whitelist, only read to import it
+    MODULES,          ///< Sensor, relay and rule configuration written by ConfigEngine
+    WHITELIST,        ///< Whitelist record log written by WhiteListManager
+    ACCESS_LOG,       ///< Ring journal of access events written by AccessJournal
+    COUNT
+};
+
+/**
+ * @brief How a partition is accessed.
+ */
+enum class PartitionKind : uint8_t
+{
+    BLOB, ///< Written as a whole into alternating A/B slots behind a header with version, length and CRC32
+    RAW   ///< Record-structured; the client owns the format and uses bounds-checked byte access
+};
+
+/**
+ * @brief Placement of a partition. Blob partitions have a second slot; raw ones leave it empty.
+ *
+ * Raw accesses address the first slot. Raw clients keep their magic words or length byte within the
+ * first clear_size bytes, which is what invalidate() clears.
+ */
+struct partition_layout
+{
+    const char *name;
+    PartitionKind kind;
+    uint16_t offset;      ///< First (A) slot
+    uint16_t size;
+    uint16_t slot_offset; ///< Second (B) slot
+    uint16_t slot_size;
+    uint16_t clear_size;  ///< Bytes invalidate() zeroes at the start of each slot, a multiple of 4
+};
+
+/**
+ * @struct partition_header
+ * @brief Header stored at the start of every blob slot.
+ */
+struct partition_header
+{
+    uint32_t magic;    ///< STORAGE_MAGIC once written
+    uint8_t id;        ///< Partition the blob belongs to
+    uint8_t version;   ///< Client schema version
+    uint16_t length;   ///< Payload length in bytes
+    uint16_t sequence; ///< Incremented on every write; the valid slot with the newer value wins
+    uint16_t reserved;
+    uint32_t crc;      ///< CRC32 of the header fields above and the payload
+};
+
+// The network B slot sits after the 64 bytes the legacy whitelist still occupies
+constexpr partition_layout STORAGE_LAYOUT[] = {
+    {"network", PartitionKind::BLOB, 0, 512, 576, 448, 4},
+    {"legacy_whitelist", PartitionKind::RAW, 512, 64, 0, 0, 4},
+    {"modules", PartitionKind::BLOB, 1024, 512, 1536, 512, 4},
+    {"whitelist", PartitionKind::RAW, 2048, 5824, 0, 0, 32}, // both log header copies
+    {"access_log", PartitionKind::RAW, 7872, 320, 0, 0, 4},
+};
+
+constexpr bool ranges_overlap(uint16_t a, uint16_t a_size, uint16_t b, uint16_t b_size)
+{
+    return a_size && b_size && a < b + b_size && b < a + a_size;
+}
+
+/**
+ * @brief Returns true if every slot fits the device and no two slots overlap.
+ */
+constexpr bool storage_layout_valid()
+{
+    for (size_t i = 0; i < sizeof(STORAGE_LAYOUT) / sizeof(STORAGE_LAYOUT[0]); i++)
+    {
+        const partition_layout &a = STORAGE_LAYOUT[i];
+        if (a.offset + a.size > STORAGE_SIZE || a.slot_offset + a.slot_size > STORAGE_SIZE)
+            return false;
+        if (a.kind == PartitionKind::BLOB &&
+            (a.size <= sizeof(partition_header) || a.slot_size <= sizeof(partition_header)))
+            return false;
+        if (ranges_overlap(a.offset, a.size, a.slot_offset, a.slot_size))
+            return false;
+        if (a.clear_size == 0 || a.clear_size % sizeof(uint32_t) || a.clear_size > a.size ||
+            (a.slot_size && a.clear_size > a.slot_size))
+            return false;
+
+        for (size_t j = i + 1; j < sizeof(STORAGE_LAYOUT) / sizeof(STORAGE_LAYOUT[0]); j++)
+        {
+            const partition_layout &b = STORAGE_LAYOUT[j];
+            if (ranges_overlap(a.offset, a.size, b.offset, b.size) ||
+                ranges_overlap(a.offset, a.size, b.slot_offset, b.slot_size) ||
+                ranges_overlap(a.slot_offset, a.slot_size, b.offset, b.size) ||
+                ranges_overlap(a.slot_offset, a.slot_size, b.slot_offset, b.slot_size))
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(STORAGE_LAYOUT) / sizeof(STORAGE_LAYOUT[0]) == (size_t)Partition::COUNT,
+              "STORAGE_LAYOUT needs one entry per Partition");
+static_assert(storage_layout_valid(), "storage partitions overlap or exceed STORAGE_SIZE");
+
+/**
+ * @brief Size of the first slot of a partition in bytes.
+ */
+constexpr uint16_t partition_size(Partition partition)
+{
+    return STORAGE_LAYOUT[(uint8_t)partition].size;
+}
+
+/**
+ * @brief Bytes available to the client: the whole partition for raw ones, the smaller slot payload for blobs.
+ */
+constexpr uint16_t partition_capacity(Partition partition)
+{
+    return STORAGE_LAYOUT[(uint8_t)partition].kind == PartitionKind::BLOB
+               ? (partition_size(partition) < STORAGE_LAYOUT[(uint8_t)partition].slot_size
+                      ? partition_size(partition)
+                      : STORAGE_LAYOUT[(uint8_t)partition].slot_size) -
+                     sizeof(partition_header)
+               : partition_size(partition);
+}
+
+/**
+ * @brief Counters describing blob partition accesses.
+ */
+struct StorageStats
+{
+    uint32_t reads;             ///< Blob reads attempted
+    uint32_t writes;            ///< Blob writes
+    uint32_t corrupt;           ///< Blob slots rejected by the header or CRC check
+    uint32_t bytes_written;     ///< Blob bytes that differed from flash and were programmed
+    uint32_t bytes_skipped;     ///< Blob bytes already holding the right value
+    unsigned long last_read_us; ///< Time taken by the last blob read, including the CRC check
+};
+
+/**
+ * @class StorageManager
+ * @brief Single owner of the EEPROM layout.
+ *
+ * Every client reads and writes through a named partition. Blob partitions carry a header with
+ * the client's schema version, the payload length and a CRC32, so a torn or corrupted blob is
+ * rejected at boot before it is parsed. Each blob write goes to the slot not holding the newest
+ * copy and only programs bytes that differ from flash, so a power cut mid-commit leaves the last
+ * good copy intact. Raw partitions hold record-structured data whose format the client validates
+ * itself; accesses outside the partition are ignored.
+ */
+class StorageManager
+{
+private:
+    StorageStats stats = {0};
+    int8_t current[(uint8_t)Partition::COUNT]; ///< Slot holding the newest valid blob, -1 if none, -2 if not located yet
+    uint16_t sequence[(uint8_t)Partition::COUNT];
+
+    static uint16_t address(Partition partition, uint16_t offset)
+    {
+        return STORAGE_LAYOUT[(uint8_t)partition].offset + offset;
+    }
+
+    static uint16_t slot_address(Partition partition, uint8_t slot)
+    {
+        return slot == 0 ? STORAGE_LAYOUT[(uint8_t)partition].offset : STORAGE_LAYOUT[(uint8_t)partition].slot_offset;
+    }
+
+    /**
+     * @brief Validates the header and CRC of one slot.
+     */
+    bool check_slot(Partition partition, uint8_t slot, partition_header &header);
+
+    /**
+     * @brief Finds the slot holding the newest valid blob.
+     */
+    void locate(Partition partition);
+
+    /**
+     * @brief Programs only the bytes that differ from flash.
+     */
+    void program(uint16_t address, const uint8_t *data, uint16_t length);
+
+public:
+    StorageManager();
+
+    /**
+     * @brief Starts the EEPROM driver.
+     */
+    void begin();
+
+    /**
+     * @brief Reads the newest valid copy of a blob partition.
+     * @param partition Blob partition to read
+     * @param version Expected schema version
+     * @param data Destination buffer
+     * @param length In: size of the buffer. Out: length of the stored payload
+     * @return false if no slot is valid, or the newest copy is from another version or larger than the buffer
+     */
+    bool read(Partition partition, uint8_t version, void *data, uint16_t &length);
+
+    /**
+     * @brief Reports the schema version of the newest valid copy of a blob partition, so a client can
+     *        read and upgrade a copy written by older firmware.
+     * @return false if no slot is valid
+     */
+    bool stored_version(Partition partition, uint8_t &version);
+
+    /**
+     * @brief Writes a blob into the older slot. The header is written last, so a torn write fails the CRC
+     *        check and the previous copy stays current.
+     * @param partition Blob partition to write
+     * @param version Schema version stored with the payload
+     * @param data Payload
+     * @param length Payload length, at most partition_capacity(partition)
+     * @return false if the payload does not fit
+     */
+    bool write(Partition partition, uint8_t version, const void *data, uint16_t length);
+
+    /**
+     * @brief Invalidates a partition by clearing its slot headers, or the first word of a raw partition.
+     *        Costs a few byte writes instead of rewriting the whole partition.
+     */
+    void invalidate(Partition partition);
+
+    /**
+     * @brief Invalidates every partition, which is what a factory reset needs.
+     */
+    void format();
+
+    /**
+     * @brief Reads one byte of a partition; returns 0xFF outside it.
+     */
+    uint8_t read_byte(Partition partition, uint16_t offset) const
+    {
+        if (offset >= partition_size(partition))
+            return 0xFF;
+        return EEPROM.read(address(partition, offset));
+    }
+
+    /**
+     * @brief Writes one byte of a partition; ignored outside it.
+     */
+    void write_byte(Partition partition, uint16_t offset, uint8_t value)
+    {
+        if (offset >= partition_size(partition))
+            return;
+        EEPROM.write(address(partition, offset), value);
+    }
+
+    /**
+     * @brief Reads a value stored at an offset of a partition.
+     * @return false if the value does not fit the partition
+     */
+    template <typename T>
+    bool get(Partition partition, uint16_t offset, T &value) const
+    {
+        if (offset + sizeof(T) > partition_size(partition))
+            return false;
+        EEPROM.get(address(partition, offset), value);
+        return true;
+    }
+
+    /**
+     * @brief Writes a value at an offset of a partition.
+     * @return false if the value does not fit the partition
+     */
+    template <typename T>
+    bool put(Partition partition, uint16_t offset, const T &value)
+    {
+        if (offset + sizeof(T) > partition_size(partition))
+            return false;
+        EEPROM.put(address(partition, offset), value);
+        return true;
+    }
+
+    /**
+     * @brief Extends a CRC32 (IEEE 802.3, reflected) over a buffer. Start with crc = 0.
+     */
+    static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length);
+
+    const StorageStats &get_stats() const { return stats; }
+};
+
+#endif // STORAGE_MANAGER_H
@@ -0,0 +1,63 @@
+#ifndef SYSTEM_CLOCK_H
+#define SYSTEM_CLOCK_H
+
+#include <Arduino.h>
+#include <services/scheduler.h>
+
+#define CLOCK_POLL_INTERVAL 60000UL   ///< Retry period while the clock is not synced
+#define CLOCK_SYNC_INTERVAL 3600000UL ///< Period of the network time refresh once synced
+#define CLOCK_MAX_AGE_MS 86400000UL   ///< Time after the last successful sync during which the clock is trusted
+
+/**
+ * @class SystemClock
+ * @brief Wall clock kept from the network time of the WiFi module.
+ *
+ * The epoch is fetched with WiFi.getTime() and extrapolated with millis() between syncs. The
+ * clock is only reported as synced if the last successful sync is recent enough, so callers can
+ * fail closed when the time is unknown.
+ */
+class SystemClock
+{
+private:
+    uint32_t epoch = 0;           ///< Unix time at the last successful sync
+    unsigned long synced_ms = 0;  ///< millis() at the last successful sync
+    bool synced = false;
+    uint32_t failures = 0;
+
+public:
+    /**
+     * @brief Fetches the network time. Keeps the previous time if the module has none yet.
+     * @return true if the clock was updated
+     */
+    bool sync();
+
+    /**
+     * @brief Syncs if the clock was never synced or the last sync is older than CLOCK_SYNC_INTERVAL.
+     */
+    void update();
+
+    /**
+     * @brief Sets the clock from an external source.
+     * @param seconds Unix time in seconds
+     */
+    void set(uint32_t seconds);
+
+    /**
+     * @brief Returns true if the clock was synced within CLOCK_MAX_AGE_MS.
+     */
+    bool is_synced() const;
+
+    /**
+     * @brief Returns the current Unix time in seconds, or 0 if the clock was never synced.
+     */
+    uint32_t now() const;
+
+    /**
+     * @brief Registers the periodic time refresh, retried every CLOCK_POLL_INTERVAL until it succeeds.
+     */
+    void register_tasks(Scheduler &scheduler);
+
+    uint32_t get_failures() const { return failures; }
+};
+
+#endif // SYSTEM_CLOCK_H
@@ -6,20 +6,38 @@
 #include <communication/wifi_manager.h>
 #include <communication/mqtt_manager.h>
 #include <communication/serial_module.h>
+#include <communication/topic_router.h>
 #include <services/whitelist_manager.h>
+#include <services/access_journal.h>
 #include <services/sensor_manager.h>
 #include <services/config_engine.h>
 #include <services/security.h>
+#include <services/scheduler.h>
+#include <services/storage_manager.h>
+#include <services/system_clock.h>
 #include <devices/relay_control.h>
 
 #include <modules/mux.h>
 
+#include <utils/heap_probe.h>
 #include <utils/protobuf.h>
 
 #include <pb_decode.h>
 #include <pb_encode.h>
 #include <transporter.pb.h>
 
+/**
+ * @brief Counters describing inbound MQTT message handling.
+ */
+struct MqttRxStats
+{
+    uint32_t messages;     ///< Messages dispatched to a handler
+    uint32_t bytes;        ///< Payload bytes dispatched
+    uint32_t unrouted;     ///< Messages without a matching route
+    unsigned long last_us; ///< Handling time of the last message
+    unsigned long max_us;  ///< Longest handling time seen
+};
+
 enum class SystemState
 {
     WAIT_CONFIG,
@@ -38,14 +56,28 @@ private:
 
     Mux mux;
     Config config;
+    StorageManager storage;
+    SystemClock systemClock;
     ConfigEngine configEngine;
     SerialModule serialModule;
     RelayControl relayControl;
     ConfigManager configManager;
     SensorManager sensorManager;
     WhiteListManager whitelistManager;
+    AccessJournal accessJournal;
+    TopicRouter<SystemMonitor> router;
+    Scheduler scheduler;
+    bool tasks_registered = false;
 
     SystemState state = SystemState::WAIT_CONFIG;
+    MqttRxStats rx_stats = {0};
+    uint32_t profiled_allocations = 0; // heap_allocations() at the last profile report
+
+    // Credentials received over MQTT are tried before they are saved; on failure the previous ones return
+    WiFiConfig requested_wifi;
+    WiFiConfig previous_wifi;
+    bool wifi_requested = false;
+    bool wifi_trial = false;
 
     // Static pointer to the singleton instance
     static SystemMonitor *instance;
@@ -57,20 +89,205 @@ private:
         {
             MqttClient &mqttClient = instance->mqtt->getMqttClient();
 
+            // The client only hands out the topic as a String: the one heap allocation per received message
             String topic = mqttClient.messageTopic();
 
-            String msg = "";
-            char c;
-            for (int i = 0; i < messageSize; i++)
-            {
-                c = mqttClient.read();
-                msg += c;
-            }
+            instance->mqtt_callback_manager(topic.c_str(), mqttClient, messageSize);
+
+            // Discard anything the handler left unread so the client stays in sync
+            uint8_t discard[16];
+            while (mqttClient.available() > 0 && mqttClient.read(discard, sizeof(discard)) > 0)
+                ;
+        }
+    }
+
+    // Registered once configured, so automation, card reads and storage keep running while WiFi or
+    // MQTT is down
+    void register_tasks()
+    {
+        mqtt->register_tasks(scheduler);
+        security->register_tasks(scheduler);
+        whitelistManager.register_tasks(scheduler);
+        accessJournal.register_tasks(scheduler);
+        configEngine.register_tasks(scheduler);
+        systemClock.register_tasks(scheduler);
+        relayControl.register_tasks(scheduler);
+        sensorManager.register_tasks(scheduler);
+#ifdef SHAAS_PROFILE
+        scheduler.add_periodic("profile", SCHEDULER_PROFILE_INTERVAL, TASK_LOW, [this]()
+                               { profile_report(); });
+#endif
+        tasks_registered = true;
+    }
 
-            instance->mqtt_callback_manager(topic.c_str(), (uint8_t *)msg.c_str(), messageSize);
+#ifdef SHAAS_PROFILE
+    // Prints " name=in_use/capacity name_peak=high_water", plus the failed creates if there were any
+    static void print_pool(const char *name, const PoolStats &pool)
+    {
+        Serial.print(" ");
+        Serial.print(name);
+        Serial.print("=");
+        Serial.print(pool.in_use);
+        Serial.print("/");
+        Serial.print(pool.capacity);
+        Serial.print(" ");
+        Serial.print(name);
+        Serial.print("_peak=");
+        Serial.print(pool.high_water);
+        if (pool.exhausted)
+        {
+            Serial.print(" ");
+            Serial.print(name);
+            Serial.print("_exhausted=");
+            Serial.print(pool.exhausted);
         }
     }
 
+    // Prints the access decisions and the card reader counters
+    void print_access()
+    {
+        const AccessStats &access = security->get_stats();
+        const WhitelistStats &lookups = whitelistManager.get_stats();
+        Serial.print("access: decisions=");
+        Serial.print(access.decisions);
+        Serial.print(" granted=");
+        Serial.print(access.granted);
+        Serial.print(" max_decision_us=");
+        Serial.print(access.max_decision_us);
+        Serial.print(" max_lookup_us=");
+        Serial.print(lookups.max_lookup_us);
+        Serial.print(" entries=");
+        Serial.print(whitelistManager.size());
+        Serial.print(" log_bytes=");
+        Serial.print(whitelistManager.log_size());
+        Serial.print(" compactions=");
+        Serial.print(lookups.compactions);
+        Serial.print(" scheduled=");
+        Serial.print(whitelistManager.scheduled_count());
+        Serial.print(" window_rejects=");
+        Serial.print(lookups.window_rejects);
+        Serial.print(" clock_synced=");
+        Serial.println(systemClock.is_synced());
+
+        const RFID &reader = security->get_reader();
+        const RfidStats &reads = reader.get_stats();
+        Serial.print("rfid: mode=");
+        Serial.print(reader.get_detection() == RfidDetection::IRQ ? "irq" : "poll");
+        Serial.print(" interval_ms=");
+        Serial.print(reader.get_poll_interval());
+        Serial.print(" polls=");
+        Serial.print(reads.polls);
+        Serial.print(" skipped=");
+        Serial.print(reads.skipped);
+        Serial.print(" kicks=");
+        Serial.print(reads.kicks);
+        Serial.print(" interrupts=");
+        Serial.print(reads.interrupts);
+        Serial.print(" busy_us=");
+        Serial.println(reads.busy_us);
+    }
+
+    // Prints per-subsystem time and the MQTT, rule and automation counters, then starts a new window
+    void profile_report()
+    {
+        Serial.println("--- profile ---");
+        scheduler.report(Serial, SCHEDULER_PROFILE_INTERVAL);
+        scheduler.reset_stats();
+
+        uint32_t allocations = heap_allocations();
+        Serial.print("heap: allocations=");
+        Serial.print(allocations - profiled_allocations);
+        Serial.print(" total=");
+        Serial.println(allocations);
+        profiled_allocations = allocations;
+
+        const PublishQueueStats &tx = mqtt->get_queue_stats();
+        Serial.print("mqtt tx: sent=");
+        Serial.print(tx.sent);
+        Serial.print(" bytes=");
+        Serial.print(tx.bytes_sent);
+        Serial.print(" dropped=");
+        Serial.print(tx.dropped);
+        Serial.print(" high_water=");
+        Serial.println(tx.high_water);
+
+        Serial.print("mqtt rx: messages=");
+        Serial.print(rx_stats.messages);
+        Serial.print(" bytes=");
+        Serial.print(rx_stats.bytes);
+        Serial.print(" unrouted=");
+        Serial.print(rx_stats.unrouted);
+        Serial.print(" max_us=");
+        Serial.println(rx_stats.max_us);
+
+        const RuleStats &rules = sensorManager.get_rule_engine().get_stats();
+        Serial.print("rules: evaluations=");
+        Serial.print(rules.evaluations);
+        Serial.print(" transitions=");
+        Serial.print(rules.transitions);
+        Serial.print(" suppressed_readings=");
+        Serial.println(sensorManager.get_suppressed_count());
+
+        print_access();
+
+        const JournalStats &journal = accessJournal.get_stats();
+        Serial.print("journal: pending=");
+        Serial.print(accessJournal.pending());
+        Serial.print(" appended=");
+        Serial.print(journal.appended);
+        Serial.print(" uploaded=");
+        Serial.print(journal.uploaded);
+        Serial.print(" overwritten=");
+        Serial.println(journal.overwritten);
+
+        const ReconcileStats &modules = sensorManager.get_reconcile_stats();
+        Serial.print("modules: added=");
+        Serial.print(modules.added);
+        Serial.print(" removed=");
+        Serial.print(modules.removed);
+        Serial.print(" moved=");
+        Serial.println(modules.moved);
+
+        Serial.print("pools:");
+        print_pool("climate", sensorManager.get_climate_pool_stats());
+        print_pool("ldr", sensorManager.get_ldr_pool_stats());
+        print_pool("pir", sensorManager.get_pir_pool_stats());
+        Serial.println();
+
+        const ConfigStats &changes = configEngine.get_stats();
+        Serial.print("config: updates=");
+        Serial.print(changes.updates);
+        Serial.print(" unchanged=");
+        Serial.print(changes.unchanged);
+        Serial.print(" commits=");
+        Serial.print(changes.commits);
+        Serial.print(" records=");
+        Serial.print(changes.records);
+        Serial.print(" dirty=");
+        Serial.println(configEngine.is_dirty());
+
+        const StorageStats &stored = storage.get_stats();
+        Serial.print("storage: reads=");
+        Serial.print(stored.reads);
+        Serial.print(" writes=");
+        Serial.print(stored.writes);
+        Serial.print(" bytes_written=");
+        Serial.print(stored.bytes_written);
+        Serial.print(" bytes_skipped=");
+        Serial.print(stored.bytes_skipped);
+        Serial.print(" corrupt=");
+        Serial.print(stored.corrupt);
+        Serial.print(" last_read_us=");
+        Serial.println(stored.last_read_us);
+
+        const AutomationStats &automation = sensorManager.get_automation_stats();
+        Serial.print("automation: actuations=");
+        Serial.print(automation.actuations);
+        Serial.print(" max_latency_us=");
+        Serial.println(automation.max_latency_us);
+    }
+#endif
+
     void configureBasicConfig()
     {
         Serial.print("SystemMonitor: MQTT Broker: ");
@@ -85,75 +302,35 @@ private:
         wifi->begin();
         mqtt->begin();                             // Use the static wrapper
         mqtt->set_callback(mqtt_callback_wrapper); // Set the callback
-        configEngine.init();
-        whitelistManager.init(mqtt, config.device_uid);
-        state = SystemState::CONNECT_WIFI;
-    }
-
-public:
-    void init()
-    {
-        Serial.println("SystemMonitor: Initializing...");
-        configManager.begin();
-        instance = this; // Set the singleton instance
-
-        if (configManager.load(config))
+        configEngine.init(&storage);
+        if (configEngine.get_stats().migrated_from)
         {
-            configureBasicConfig();
+            Serial.print("SystemMonitor: Config upgraded from schema v");
+            Serial.print(configEngine.get_stats().migrated_from);
+            Serial.print(" to v");
+            Serial.print(CONFIG_VERSION);
+            Serial.print(" in ");
+            Serial.print(configEngine.get_stats().migrate_us);
+            Serial.println(" us");
         }
-        else
+        accessJournal.init(&storage, mqtt, &systemClock, config.device_uid);
+        whitelistManager.set_clock(&systemClock);
+        whitelistManager.set_journal(&accessJournal);
+        whitelistManager.init(&storage, mqtt, config.device_uid);
+
+        // Access decisions are made and journaled without a broker; the journal uploads them later
+        security = new Security(&whitelistManager);
+        if (!security->init(&whitelistManager, mqtt, config.device_uid))
         {
-            Serial.println("SystemMonitor: No config found, starting Bluetooth");
-            bt = new BluetoothManager([this](const Config &c, const String &json)
-                                      {
-                                          Serial.println("SystemMonitor: Bluetooth config received");
-                                          config = c;
-                                          configManager.save(json);
-                                          configureBasicConfig(); });
-            bt->begin();
-        }
-
-        if (serialModule.init(Serial1))
-        {
-            Serial.println("SystemMonitor: SerialModule initialized successfully");
-
-            if (relayControl.init(&serialModule))
-            {
-                Serial.println("SystemMonitor: RelayControl initialized successfully");
-            }
-            else
-            {
-                Serial.println("SystemMonitor: Failed to initialize RelayControl");
-            }
-        }
-        else
-        {
-            Serial.println("SystemMonitor: Failed to initialize SerialModule");
-        }
-
-        int muxSelectionPins[] = {10, 5, 8, 9};               // S0, S1, S2, S3 pins
-        mux.init(3, muxSelectionPins, 4, DIGITAL, MUX_INPUT); // Signal pin on A0
-
-        // After MQTT and ConfigEngine are initialized:
-        if (state == SystemState::CONNECT_WIFI || state == SystemState::CONNECT_MQTT)
-        {
-            // Initialize SensorManager with mux
-            if (sensorManager.init(&configEngine, mqtt, &mux, config.device_uid))
-            {
-                Serial.println("SystemMonitor: SensorManager initialized successfully");
-            }
-            else
-            {
-                Serial.println("SystemMonitor: Failed to initialize SensorManager");
-            }
+            Serial.println("SystemMonitor: Failed to initialize Security");
         }
+        register_tasks();
+        state = SystemState::CONNECT_WIFI;
     }
 
-    void update()
+    // Connects WiFi and MQTT and falls back when either drops; the scheduler runs regardless
+    void advance_state()
     {
-        static unsigned long last_status_check = 0;
-        const unsigned long status_interval = 5000; // Check every 5 seconds
-
         switch (state)
         {
         case SystemState::WAIT_CONFIG:
@@ -166,8 +343,22 @@ public:
         case SystemState::CONNECT_WIFI:
             if (wifi->update())
             {
+                if (wifi_trial)
+                {
+                    Config saved;
+                    saved.wifi = config.wifi;
+                    configManager.update_config(saved);
+                    wifi_trial = false;
+                }
                 state = SystemState::CONNECT_MQTT;
             }
+            else if (wifi_trial && wifi->failed())
+            {
+                Serial.println("SystemMonitor: New WiFi credentials failed, restoring the previous ones");
+                config.wifi = previous_wifi;
+                wifi_trial = false;
+                wifi->reconnect(config.wifi);
+            }
             break;
 
         case SystemState::CONNECT_MQTT:
@@ -182,8 +373,6 @@ public:
 
             if (mqtt->is_connected())
             {
-                whitelistManager.init(mqtt, config.device_uid);
-
                 uint8_t buffer[256];
                 pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
                 transporter_RelayStateSync relayStateSync = transporter_RelayStateSync_init_zero;
@@ -196,31 +385,26 @@ public:
                 }
 
                 String relayStateTopic = "arduino/" + config.device_uid + "/relay/full";
-                mqtt->publish(relayStateTopic.c_str(), buffer, stream.bytes_written);
+                mqtt->publish(relayStateTopic.c_str(), buffer, stream.bytes_written, PublishPriority::URGENT);
                 mqtt->publish("device/arduino/test", "Test message from SystemMonitor");
 
-                if (!security)
+                // Rebuilt on every connect, so the topics follow the current device_uid
+                router.begin(this, config.device_uid);
+                router.add("wifi", &SystemMonitor::handle_wifi_credentials);
+                router.add("rfid", &SystemMonitor::handle_security);
+                router.add("config", &SystemMonitor::handle_config_manager);
+                router.add("config/remove", &SystemMonitor::handle_config_removal);
+                router.add("relay", &SystemMonitor::handle_relay_toggle);
+                router.add("factory_reset", &SystemMonitor::handle_factory_reset);
+
+                for (uint8_t i = 0; i < router.size(); i++)
                 {
-                    security = new Security(&whitelistManager);
-                    if (!security->init(&whitelistManager))
-                    {
-                        Serial.println("SystemMonitor: Failed to initialize Security");
-                        return;
-                    }
+                    mqtt->subscribe(router.topic(i));
                 }
 
-                String wifi_config = "arduino/" + config.device_uid + "/wifi";
-                String rfid_topic = "arduino/" + config.device_uid + "/rfid";
-                String config_topic = "arduino/" + config.device_uid + "/config";
-                String config_removal = "arduino/" + config.device_uid + "/config/remove";
-                String relay_state = "arduino/" + config.device_uid + "/relay";
-                String factory_reset = "arduino/" + config.device_uid + "/factory_reset";
-                mqtt->subscribe(wifi_config.c_str());
-                mqtt->subscribe(rfid_topic.c_str());
-                mqtt->subscribe(config_topic.c_str());
-                mqtt->subscribe(config_removal.c_str());
-                mqtt->subscribe(relay_state.c_str());
-                mqtt->subscribe(factory_reset.c_str());
+                // Lets the backend answer with only the whitelist changes this device is missing
+                whitelistManager.publish_status();
+
                 state = SystemState::READY;
             }
             break;
@@ -238,66 +422,139 @@ public:
                 state = SystemState::CONNECT_MQTT;
                 return;
             }
+            if (wifi_requested)
+            {
+                // Outside the MQTT callback, so the client is not torn down while it reads
+                Serial.println("SystemMonitor: Reconnecting with new WiFi credentials");
+                wifi_requested = false;
+                previous_wifi = config.wifi;
+                config.wifi = requested_wifi;
+                wifi_trial = true;
+                wifi->reconnect(config.wifi);
+                state = SystemState::CONNECT_WIFI;
+                return;
+            }
 
-            mqtt->update();
-            whitelistManager.update();
-            security->handle();
-            relayControl.handleResponses();
-            sensorManager.update();
             break;
         }
     }
 
-    void mqtt_callback_manager(const char *topic, uint8_t *payload, unsigned int length)
+public:
+    void init()
     {
-        String wifi_config = "arduino/" + config.device_uid + "/wifi";
-        String rfid_topic = "arduino/" + config.device_uid + "/rfid";
-        String config_module = "arduino/" + config.device_uid + "/config";
-        String config_removal = "arduino/" + config.device_uid + "/config/remove";
-        String relay_state = "arduino/" + config.device_uid + "/relay";
-        String factory_reset = "arduino/" + config.device_uid + "/factory_reset";
-        if (strcmp(topic, wifi_config.c_str()) == 0)
-        {
-            handle_wifi_credentials(payload, length);
-        }
+        Serial.println("SystemMonitor: Initializing...");
+        storage.begin();
+        configManager.begin(&storage);
+        instance = this; // Set the singleton instance
 
-        if (strcmp(topic, rfid_topic.c_str()) == 0)
+        if (configManager.load(config))
         {
-            handle_security(payload, length);
+            configureBasicConfig();
         }
-
-        if (strcmp(topic, config_module.c_str()) == 0)
+        else
         {
-            handle_config_manager(payload, length);
+            Serial.println("SystemMonitor: No config found, starting Bluetooth");
+            bt = new BluetoothManager([this](const Config &c, const String &json)
+                                      {
+                                          Serial.println("SystemMonitor: Bluetooth config received");
+                                          config = c;
+                                          configManager.save(json);
+                                          configureBasicConfig(); });
+            bt->begin();
         }
 
-        if (strcmp(topic, config_removal.c_str()) == 0)
+        if (serialModule.init(Serial1))
         {
-            handle_config_removal(payload, length);
-        }
+            Serial.println("SystemMonitor: SerialModule initialized successfully");
 
-        if (strcmp(topic, relay_state.c_str()) == 0)
+            if (relayControl.init(&serialModule))
+            {
+                Serial.println("SystemMonitor: RelayControl initialized successfully");
+            }
+            else
+            {
+                Serial.println("SystemMonitor: Failed to initialize RelayControl");
+            }
+        }
+        else
         {
-            handle_relay_toggle(payload, length);
+            Serial.println("SystemMonitor: Failed to initialize SerialModule");
         }
 
-        if (strcmp(topic, factory_reset.c_str()) == 0)
+        int muxSelectionPins[MUX_SELECT_PINS] = {10, 5, 8, 9};              // S0, S1, S2, S3 pins
+        mux.init(3, muxSelectionPins, MUX_SELECT_PINS, DIGITAL, MUX_INPUT); // Signal pin on A0
+
+        // After MQTT and ConfigEngine are initialized:
+        if (state == SystemState::CONNECT_WIFI || state == SystemState::CONNECT_MQTT)
         {
-            for (int i = 0; i < EEPROM.length(); i++)
+            // Initialize SensorManager with mux
+            if (sensorManager.init(&configEngine, mqtt, &mux, &relayControl, config.device_uid))
+            {
+                Serial.println("SystemMonitor: SensorManager initialized successfully");
+            }
+            else
             {
-                EEPROM.write(i, 0);
+                Serial.println("SystemMonitor: Failed to initialize SensorManager");
             }
+        }
+    }
 
-            NVIC_SystemReset();
+    /**
+     * @brief Advances the state machine and, once configured, runs the tasks that are due in every
+     *        state, so local automation does not wait for WiFi or the broker.
+     * @return Milliseconds the caller may idle before the next deadline
+     */
+    unsigned long update()
+    {
+        advance_state();
+        if (!tasks_registered)
+            return SCHEDULER_MAX_IDLE_MS;
+        return scheduler.run();
+    }
+
+    SystemState get_state() const { return state; }
+
+    Scheduler &get_scheduler() { return scheduler; }
+
+    void mqtt_callback_manager(const char *topic, Client &client, size_t length)
+    {
+        int route = router.match(topic);
+        if (route < 0)
+        {
+            rx_stats.unrouted++;
+            Serial.print("SystemMonitor: No route for topic ");
+            Serial.println(topic);
+            return;
         }
+
+        unsigned long start = micros();
+        pb_istream_t stream = pb_istream_from_client(client, length);
+        router.invoke(route, &stream);
+
+        rx_stats.messages++;
+        rx_stats.bytes += length;
+        rx_stats.last_us = micros() - start;
+        if (rx_stats.last_us > rx_stats.max_us)
+            rx_stats.max_us = rx_stats.last_us;
+    }
+
+    const MqttRxStats &get_rx_stats() const { return rx_stats; }
+    const Security *get_security() const { return security; }
+    const WhiteListManager &get_whitelist() const { return whitelistManager; }
+    const AccessJournal &get_journal() const { return accessJournal; }
+    SensorManager &get_sensor_manager() { return sensorManager; }
+
+    void handle_factory_reset(pb_istream_t *stream)
+    {
+        storage.format();
+        NVIC_SystemReset();
     }
 
-    void handle_config_removal(uint8_t *payload, unsigned int length)
+    void handle_config_removal(pb_istream_t *stream)
     {
         Serial.println("SystemMonitor: Received ConfigRemoval");
-        pb_istream_t stream = pb_istream_from_buffer(payload, length);
         transporter_ConfigRemoval config_removal = transporter_ConfigRemoval_init_zero;
-        if (pb_decode(&stream, transporter_ConfigRemoval_fields, &config_removal))
+        if (pb_decode(stream, transporter_ConfigRemoval_fields, &config_removal))
         {
             switch (config_removal.which_payload)
             {
@@ -310,77 +567,73 @@ public:
             case transporter_ConfigRemoval_motion_tag:
                 configEngine.delete_motion_config(config_removal.payload.motion.id);
                 break;
+            case transporter_ConfigRemoval_rule_tag:
+                configEngine.delete_rule_config(config_removal.payload.rule.id);
+                break;
             default:
                 break;
             }
 
-            NVIC_SystemReset();
+            sensorManager.reconcile();
         }
         else
         {
             Serial.print("SystemMonitor: Failed to decode ConfigRemoval: ");
-            Serial.println(PB_GET_ERROR(&stream));
+            Serial.println(PB_GET_ERROR(stream));
         }
     }
 
-    void handle_wifi_credentials(uint8_t *payload, unsigned int length)
+    void handle_wifi_credentials(pb_istream_t *stream)
     {
-        Config config;
         char ssid[32], password[32];
 
-        pb_istream_t stream = pb_istream_from_buffer(payload, length);
         transporter_WifiCredentials wifi_credentials = transporter_WifiCredentials_init_zero;
         wifi_credentials.ssid.funcs.decode = decode_string;
         wifi_credentials.password.funcs.decode = decode_string;
         wifi_credentials.ssid.arg = (void *)ssid;
         wifi_credentials.password.arg = (void *)password;
 
-        if (pb_decode(&stream, transporter_WifiCredentials_fields, &wifi_credentials))
+        if (pb_decode(stream, transporter_WifiCredentials_fields, &wifi_credentials))
         {
-            Serial.print("SystemMonitor: Received WiFi credentials: ");
-            Serial.print(ssid);
-            Serial.print(", ");
-            Serial.println(password);
+            Serial.print("SystemMonitor: Received WiFi credentials for ");
+            Serial.println(ssid);
 
-            config.wifi.ssid = String(ssid);
-            config.wifi.password = String(password);
-            configManager.update_config(config);
-
-            NVIC_SystemReset();
+            requested_wifi.ssid = String(ssid);
+            requested_wifi.password = String(password);
+            wifi_requested = true;
         }
         else
         {
             Serial.print("SystemMonitor: Failed to decode WiFi credentials: ");
-            Serial.println(PB_GET_ERROR(&stream));
+            Serial.println(PB_GET_ERROR(stream));
         }
     }
 
-    void handle_relay_toggle(uint8_t *payload, unsigned int length)
+    void handle_relay_toggle(pb_istream_t *stream)
     {
-        pb_istream_t stream = pb_istream_from_buffer(payload, length);
         transporter_RelayState relayState = transporter_RelayState_init_zero;
 
-        if (pb_decode(&stream, transporter_RelayState_fields, &relayState))
+        if (pb_decode(stream, transporter_RelayState_fields, &relayState))
         {
             relayControl.toggleRelay(relayState.type, relayState.port, relayState.state);
         }
         else
         {
             Serial.print("SystemMonitor: Failed to decode RelayState: ");
-            Serial.println(PB_GET_ERROR(&stream));
+            Serial.println(PB_GET_ERROR(stream));
         }
     }
 
-    void handle_security(uint8_t *payload, unsigned int length)
+    void handle_security(pb_istream_t *stream)
     {
         CallbackSharedData shared_data = {0};
-        pb_istream_t stream = pb_istream_from_buffer(payload, length);
+        shared_data.whitelist = &whitelistManager;
 
         transporter_RfidEnvelope rfidEnvelope = transporter_RfidEnvelope_init_zero;
         rfidEnvelope.cb_payload.funcs.decode = msg_callback;
         rfidEnvelope.cb_payload.arg = &shared_data;
 
-        if (pb_decode(&stream, transporter_RfidEnvelope_fields, &rfidEnvelope))
+        if (pb_decode(stream, transporter_RfidEnvelope_fields, &rfidEnvelope))
         {
             switch (rfidEnvelope.which_payload)
             {
@@ -389,9 +642,7 @@ public:
                 whitelistManager.set_mode_registration();
                 break;
             case transporter_RfidEnvelope_revoke_request_tag:
-                uint8_t uid_copy[MAX_UID_LENGTH];
-                memcpy(uid_copy, shared_data.uid_buffer, shared_data.uid_length);
-                whitelistManager.delete_uid(uid_copy, shared_data.uid_length);
+                whitelistManager.delete_uid(shared_data.uid_buffer, shared_data.uid_length);
                 break;
             default:
                 break;
@@ -400,80 +651,150 @@ public:
         else
         {
             Serial.print("SystemMonitor: Failed to decode RFID envelope: ");
-            Serial.println(PB_GET_ERROR(&stream));
+            Serial.println(PB_GET_ERROR(stream));
         }
     };
 
-    void handle_config_manager(uint8_t *payload, unsigned int length)
+    static void to_climate(const transporter_Climate &message, climate &c)
+    {
+        c.id = message.id;
+        c.dht22_port = message.dht22_port;
+        c.aqi_port = message.aqi_port;
+        c.has_buzzer = message.has_buzzers;
+        c.buzzer_port = message.buzzer_port;
+        c.relative_deadband = message.relative_deadband;
+        c.temperature_deadband = message.temperature_deadband;
+        c.humidity_deadband = message.humidity_deadband;
+        c.aqi_deadband = message.aqi_deadband;
+        c.max_silent_s = message.max_silent_s;
+    }
+
+    static void to_ldr(const transporter_LDR &message, ldr &l)
+    {
+        l.id = message.id;
+        l.port = message.port;
+        l.relative_deadband = message.relative_deadband;
+        l.deadband = message.deadband;
+        l.max_silent_s = message.max_silent_s;
+    }
+
+    static void to_motion(const transporter_Motion &message, motion &m)
+    {
+        m.id = message.id;
+        m.port = message.port;
+        m.relay_type = message.relay_type;
+        m.relay_port = message.relay_port;
+        m.debounce_ms = message.debounce_ms;
+        m.hold_s = message.hold_s;
+        m.heartbeat_s = message.heartbeat_s;
+        m.local_automation = message.local_automation;
+    }
+
+    // Appends one module of a FullConfig to the staged configuration as it is decoded. A module past
+    // the board profile's capacity fails the decode, so the whole FullConfig is rejected.
+    static bool decode_full_config_module(pb_istream_t *stream, const pb_field_t *field, void **arg)
+    {
+        config_data *staged = (config_data *)*arg;
+
+        if (field->tag == transporter_FullConfig_climates_tag)
+        {
+            transporter_Climate message = transporter_Climate_init_zero;
+            if (staged->climate_size >= MAX_CLIMATE)
+                PB_RETURN_ERROR(stream, "too many climates for the board profile");
+            if (!pb_decode(stream, transporter_Climate_fields, &message))
+                return false;
+            to_climate(message, staged->climates[staged->climate_size++]);
+        }
+        else if (field->tag == transporter_FullConfig_ldrs_tag)
+        {
+            transporter_LDR message = transporter_LDR_init_zero;
+            if (staged->ldr_size >= MAX_LDR)
+                PB_RETURN_ERROR(stream, "too many LDRs for the board profile");
+            if (!pb_decode(stream, transporter_LDR_fields, &message))
+                return false;
+            to_ldr(message, staged->ldrs[staged->ldr_size++]);
+        }
+        else if (field->tag == transporter_FullConfig_motions_tag)
+        {
+            transporter_Motion message = transporter_Motion_init_zero;
+            if (staged->motion_size >= MAX_MOTION)
+                PB_RETURN_ERROR(stream, "too many motions for the board profile");
+            if (!pb_decode(stream, transporter_Motion_fields, &message))
+                return false;
+            to_motion(message, staged->motions[staged->motion_size++]);
+        }
+        return true;
+    }
+
+    // Runs before a ConfigTopic payload is decoded; routes the modules of a FullConfig into the
+    // staged configuration instead of fixed-size arrays in the message.
+    static bool prepare_config_payload(pb_istream_t *stream, const pb_field_t *field, void **arg)
+    {
+        if (field->tag == transporter_ConfigTopic_full_config_tag)
+        {
+            transporter_FullConfig *full_config = (transporter_FullConfig *)field->pData;
+            full_config->climates.funcs.decode = decode_full_config_module;
+            full_config->climates.arg = *arg;
+            full_config->ldrs.funcs.decode = decode_full_config_module;
+            full_config->ldrs.arg = *arg;
+            full_config->motions.funcs.decode = decode_full_config_module;
+            full_config->motions.arg = *arg;
+        }
+        return true;
+    }
+
+    void handle_config_manager(pb_istream_t *stream)
     {
         Serial.println("Recieved Config");
-        pb_istream_t stream = pb_istream_from_buffer(payload, length);
 
+        config_data _config = default_config;
         transporter_ConfigTopic config = transporter_ConfigTopic_init_zero;
-        if (pb_decode(&stream, transporter_ConfigTopic_fields, &config))
+        config.cb_payload.funcs.decode = prepare_config_payload;
+        config.cb_payload.arg = &_config;
+
+        if (pb_decode(stream, transporter_ConfigTopic_fields, &config))
         {
-            config_data _config;
-            ldr l, ldrs[MAX_LDR];
-            motion m, motions[MAX_MOTION];
-            climate c, climates[MAX_CLIMATE];
+            ldr l;
+            motion m;
+            climate c;
+            rule r;
 
             switch (config.which_payload)
             {
             case transporter_ConfigTopic_climate_tag:
-                c.id = config.payload.climate.id;
-                c.dht22_port = config.payload.climate.dht22_port;
-                c.aqi_port = config.payload.climate.aqi_port;
-                c.has_buzzer = config.payload.climate.has_buzzers;
-                c.buzzer_port = config.payload.climate.buzzer_port;
-
+                to_climate(config.payload.climate, c);
                 configEngine.set_climate_config(c);
                 break;
 
             case transporter_ConfigTopic_ldr_tag:
-                l.id = config.payload.ldr.id;
-                l.port = config.payload.ldr.port;
+                to_ldr(config.payload.ldr, l);
                 configEngine.set_ldr_config(l);
                 break;
 
             case transporter_ConfigTopic_motion_tag:
-                m.id = config.payload.motion.id;
-                m.port = config.payload.motion.port;
-                m.relay_type = config.payload.motion.relay_type;
-                m.relay_port = config.payload.motion.relay_port;
-
+                to_motion(config.payload.motion, m);
                 configEngine.set_motion_config(m);
                 break;
 
-            case transporter_ConfigTopic_full_config_tag:
-
-                for (int i = 0; i < config.payload.full_config.climates_count; i++)
-                {
-                    _config.climates[i].id = config.payload.full_config.climates[i].id;
-                    _config.climates[i].dht22_port = config.payload.full_config.climates[i].dht22_port;
-                    _config.climates[i].aqi_port = config.payload.full_config.climates[i].aqi_port;
-                    _config.climates[i].has_buzzer = config.payload.full_config.climates[i].has_buzzers;
-                    _config.climates[i].buzzer_port = config.payload.full_config.climates[i].buzzer_port;
-                }
-
-                for (int i = 0; i < config.payload.full_config.ldrs_count; i++)
-                {
-                    _config.ldrs[i].id = config.payload.full_config.ldrs[i].id;
-                    _config.ldrs[i].port = config.payload.full_config.ldrs[i].port;
-                }
-
-                for (int i = 0; i < config.payload.full_config.motions_count; i++)
-                {
-                    _config.motions[i].id = config.payload.full_config.motions[i].id;
-                    _config.motions[i].port = config.payload.full_config.motions[i].port;
-                    _config.motions[i].relay_type = config.payload.full_config.motions[i].relay_type;
-                    _config.motions[i].relay_port = config.payload.full_config.motions[i].relay_port;
-                }
+            case transporter_ConfigTopic_rule_tag:
+                r.id = config.payload.rule.id;
+                r.sensor = config.payload.rule.sensor;
+                r.sensor_id = config.payload.rule.sensor_id;
+                r.comparator = config.payload.rule.comparator;
+                r.action = config.payload.rule.action;
+                r.port = config.payload.rule.port;
+                r.relay_type = config.payload.rule.relay_type;
+                r.threshold = config.payload.rule.threshold;
+                r.hysteresis = config.payload.rule.hysteresis;
+
+                configEngine.set_rule_config(r);
+                break;
 
-                _config.version = 1;
-                _config.size = sizeof(_config);
-                _config.climate_size = config.payload.full_config.climates_count;
-                _config.ldr_size = config.payload.full_config.ldrs_count;
-                _config.motion_size = config.payload.full_config.motions_count;
+            case transporter_ConfigTopic_full_config_tag:
+                // The modules were staged in _config while they were decoded.
+                // Rules are not part of FullConfig; keep the stored ones
+                _config.rule_size = configEngine.get_configs()->rule_size;
+                memcpy(_config.rules, configEngine.get_configs()->rules, sizeof(_config.rules));
 
                 configEngine.set_full_config(_config);
                 break;
@@ -481,7 +802,12 @@ public:
                 break;
             }
 
-            configEngine.save_config();
+            sensorManager.reconcile();
+        }
+        else
+        {
+            Serial.print("SystemMonitor: Failed to decode config: ");
+            Serial.println(PB_GET_ERROR(stream));
         }
     }
 
@@ -1,16 +1,49 @@
 #ifndef WHITELIST_MANAGER_H
 #define WHITELIST_MANAGER_H
 
-#define W_EEPROM_SIZE 1024
-#define W_EEPROM_ADDR 512
+#define W_LEGACY_SIZE 5 // entries of the legacy variable-length list, imported once into the log
 #define MAX_UID_LENGTH 8
-#define MAX_WHITELIST_SIZE 5
+#define MAX_WHITELIST_SIZE 500
+
+// Append-only record log in the whitelist partition: two header copies followed by fixed-size
+// [type][len][uid x MAX_UID_LENGTH] records. A version record carries the sync version in place of a UID;
+// a scheduled entry is a window record immediately followed by its UID record, appended together. Records are replayed from [0, gap_start) and
+// [gap_end, log_end); compaction moves live records from gap_end down to gap_start a few at a
+// time, so the gap only ever holds garbage. Every header change is written to the other copy with a
+// new sequence number and a CRC, so a power cut mid-write leaves the previous header in force.
+#define W_STORE_MAGIC 0x574C4F47UL
+#define W_LOG_ADDR (2 * sizeof(whitelist_log_header))
+#define W_LOG_SIZE (partition_size(Partition::WHITELIST) - W_LOG_ADDR)
+#define W_RECORD_LIVE 0x4C
+#define W_RECORD_TOMBSTONE 0x54
+#define W_RECORD_VERSION 0x56
+#define W_RECORD_WINDOW 0x57
+#define W_RECORD_SCHEDULED 0x53
+#define W_NO_RECORD 0xFFFF
+#define W_RECORD_SIZE (2 + MAX_UID_LENGTH)
+#define W_COMPACT_THRESHOLD (W_LOG_SIZE * 3 / 4) // compaction starts once the log passes this fill
+#define W_COMPACT_INTERVAL 50
+#define W_COMPACT_RECORDS 8 // records examined per compaction step
+
+// Bloom filter over the stored UIDs
+#define W_BLOOM_BITS 4096
+#define W_BLOOM_HASHES 4
+
+#define W_MAX_WINDOWS 32 // scheduled entries; their windows are kept in RAM so lookups stay off storage
+#define W_SECONDS_PER_DAY 86400UL
+
+// One mark per log record, set on the records a snapshot confirms
+#define W_SYNC_MARK_BYTES ((W_LOG_SIZE / W_RECORD_SIZE + 7) / 8)
 
 #include <functional>
 
 #include <Arduino.h>
-#include <EEPROM.h>
+#include <pb.h>
 #include <communication/mqtt_manager.h>
+#include <services/access_journal.h>
+#include <services/scheduler.h>
+#include <services/storage_manager.h>
+#include <services/system_clock.h>
 
 enum class WhiteListMode
 {
@@ -24,31 +57,142 @@ struct uid_args
     size_t length;
 };
 
+// Validity of a scheduled entry in UTC, stored in the payload of its window record. Start and end are
+// whole days; weekday bit 0 is Sunday and hour bit h covers h:00 to h:59.
+struct access_window
+{
+    uint16_t start_day; // first valid day since the epoch
+    uint16_t end_day;   // last valid day
+    uint8_t weekdays;
+    uint8_t hours[3];
+};
+
+static_assert(sizeof(access_window) <= MAX_UID_LENGTH, "access_window must fit a record payload");
+
+struct whitelist_log_header
+{
+    uint32_t magic;
+    uint16_t log_end;
+    uint16_t gap_start;
+    uint16_t gap_end;
+    uint16_t sequence; // incremented on every commit; the valid copy with the newer value wins
+    uint32_t crc;      // CRC32 of the fields above
+};
+
+static_assert(W_LOG_ADDR <= STORAGE_LAYOUT[(uint8_t)Partition::WHITELIST].clear_size,
+              "invalidate() must clear both whitelist header copies");
+
+static_assert((MAX_WHITELIST_SIZE + W_MAX_WINDOWS + 1) * W_RECORD_SIZE <= W_LOG_SIZE,
+              "the whitelist partition must hold a full list with its windows and version record");
+
+struct WhitelistStats
+{
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t bloom_rejects;  // lookups answered without touching storage
+    uint32_t storage_probes; // records compared during binary searches
+    unsigned long last_lookup_us;
+    unsigned long max_lookup_us;
+    uint32_t compactions;    // completed compaction passes
+    uint32_t window_rejects; // listed cards refused by their access window or an unsynced clock
+};
+
 class WhiteListManager
 {
     String device_uid, registration_request_id = "";
     MQTTManager *mqtt;
+    StorageManager *storage = nullptr;
     WhiteListMode mode = WhiteListMode::AUTHENTICATION;
     uint8_t uid_buffer[MAX_UID_LENGTH];
     size_t uid_length = 0;
     bool new_uid_received = false;
+    bool uid_whitelisted = false;
+    AccessReason last_reason = AccessReason::NOT_LISTED; // why the last lookup decided as it did
     bool awating_response = false;
+    Scheduler *scheduler = nullptr;
+    int task_id = -1;
+
+    // Log offsets of the live records sorted by UID and the Bloom filter; records stay in storage
+    uint16_t sorted[MAX_WHITELIST_SIZE];
+    uint16_t record_count = 0;
+    uint8_t bloom[W_BLOOM_BITS / 8];
+    whitelist_log_header header = {0};
+    uint8_t header_copy = 0; // copy holding the committed header
+    uint16_t dead_bytes = 0; // superseded records and tombstones still in the log
+    bool compacting = false;
+    uint16_t pass_end = 0;   // log_end when the running compaction pass started
+
+    // Version of the last snapshot or delta applied, and the sum of the FNV-1a hashes of the stored UIDs
+    uint32_t version = 0;
+    uint16_t version_offset = W_NO_RECORD;
+    uint32_t set_hash = 0;
+    uint8_t sync_marks[W_SYNC_MARK_BYTES];
+    bool syncing = false;
+
+    // Windows of the scheduled entries, keyed by the log offset of their UID record
+    struct window_slot
+    {
+        uint16_t offset;
+        access_window window;
+    };
+    window_slot windows[W_MAX_WINDOWS];
+    uint8_t window_count = 0;
+    const SystemClock *clock = nullptr;
+    AccessJournal *journal = nullptr;
+    WhitelistStats stats = {0};
 
 public:
-    void init(MQTTManager *mqtt_manager, const String &device_uid);
+    void init(StorageManager *storage, MQTTManager *mqtt_manager, const String &device_uid);
     void update();
+    void register_tasks(Scheduler &scheduler);
     bool is_whitelisted(uint8_t *uid, size_t length);
     void reset_response() { awating_response = false; }
     void delete_uid(uint8_t *uid, size_t length);
-    void set_uid(uint8_t *uid, size_t length);
+    bool set_uid(uint8_t *uid, size_t length);
     void set_mode_registration();
     void set_registration_request_id(const String &id) { registration_request_id = id; }
+    void set_clock(const SystemClock *clock) { this->clock = clock; }
+    void set_journal(AccessJournal *journal) { this->journal = journal; }
+    bool apply_snapshot(pb_istream_t *stream);
+    bool apply_delta(pb_istream_t *stream);
+    void publish_status();
 
     bool get_response() const { return awating_response; }
     WhiteListMode get_mode() const { return mode; }
+    uint16_t size() const { return record_count; }
+    uint8_t scheduled_count() const { return window_count; }
+    uint16_t log_size() const { return header.log_end; }
+    uint32_t get_version() const { return version; }
+    uint32_t get_hash() const { return set_hash; }
+    const WhitelistStats &get_stats() const { return stats; }
 
 private:
-    void save_to_eeprom(uint8_t *uid, size_t length);
+    void load_from_eeprom();
+    void replay(uint16_t from, uint16_t to);
+    void load_windows();
+    void import_legacy();
+    bool save_to_eeprom(const uint8_t *uid, size_t length, const access_window *window = nullptr);
+    int find_window(uint16_t offset) const;
+    bool update_window(uint16_t old_offset, uint16_t offset, const access_window *window);
+    bool window_allows(const access_window &window) const;
+    void set_version(uint32_t value);
+    void set_mark(uint16_t offset, bool value);
+    bool get_mark(uint16_t offset) const;
+    void drop_unconfirmed(uint16_t limit);
+    static bool decode_sync_entry(pb_istream_t *stream, const pb_field_t *field, void **arg);
+    bool append_record(uint8_t type, const uint8_t *data, size_t length, const access_window *window = nullptr);
+    void write_record(uint16_t offset, uint8_t type, const uint8_t *data, size_t length);
+    void start_compaction();
+    bool compact_step(uint8_t records);
+    void compact_all();
+    void finish_compaction();
+    void bloom_add(const uint8_t *uid, size_t length);
+    bool bloom_test(const uint8_t *uid, size_t length) const;
+    int search(const uint8_t *uid, size_t length, bool &found);
+    int compare_record(uint16_t offset, const uint8_t *uid, size_t length) const;
+    uint8_t read_record(uint16_t offset, uint8_t *uid) const;
+    bool read_header();
+    void commit_header();
     void publish_uid_for_registration();
 };
 
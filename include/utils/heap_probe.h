@@ -0,0 +1,15 @@
+#ifndef HEAP_PROBE_H
+#define HEAP_PROBE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Returns the number of heap allocations since boot.
+ *
+ * Counted in SHAAS_PROFILE and native builds, where the linker wraps malloc, calloc and realloc (see
+ * the uno_r4_wifi_profile and native environments); operator new and String reach the heap through
+ * them. Other builds always return 0.
+ */
+uint32_t heap_allocations();
+
+#endif // HEAP_PROBE_H
@@ -0,0 +1,79 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <Arduino.h>
+#include <new>
+#include <utility>
+
+/**
+ * @struct PoolStats
+ * @brief Occupancy of an ObjectPool.
+ */
+struct PoolStats
+{
+    uint8_t capacity;   ///< Slots in the pool
+    uint8_t in_use;     ///< Slots holding an object
+    uint8_t high_water; ///< Most slots in use at once
+    uint32_t exhausted; ///< create() calls that found no free slot
+};
+
+/**
+ * @class ObjectPool
+ * @brief Fixed-capacity storage for up to N objects of type T, constructed in place.
+ *
+ * The slots are part of the owning object, so creating and destroying objects never touches the
+ * heap and cannot fragment it. create() returns nullptr once every slot is taken.
+ */
+template <typename T, uint8_t N>
+class ObjectPool
+{
+private:
+    alignas(T) uint8_t slots[N][sizeof(T)];
+    bool used[N] = {false};
+    PoolStats stats = {N, 0, 0, 0};
+
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * @brief Constructs an object in a free slot.
+     * @return The object, or nullptr if the pool is full
+     */
+    template <typename... Args>
+    T *create(Args &&...args)
+    {
+        for (uint8_t i = 0; i < N; i++)
+        {
+            if (used[i])
+                continue;
+
+            used[i] = true;
+            if (++stats.in_use > stats.high_water)
+                stats.high_water = stats.in_use;
+            return new (slots[i]) T(std::forward<Args>(args)...);
+        }
+
+        stats.exhausted++;
+        return nullptr;
+    }
+
+    /**
+     * @brief Destroys an object created by this pool and frees its slot. Ignores nullptr.
+     */
+    void destroy(T *object)
+    {
+        if (!object)
+            return;
+
+        uint8_t i = ((uint8_t *)object - slots[0]) / sizeof(T);
+        object->~T();
+        used[i] = false;
+        stats.in_use--;
+    }
+
+    const PoolStats &get_stats() const { return stats; }
+};
+
+#endif // OBJECT_POOL_H
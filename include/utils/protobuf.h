@@ -1,15 +1,18 @@
 #if !defined(PROTOBUF_H)
 #define PROTOBUF_H
 
+#include <Arduino.h>
 #include <pb.h>
 #include <pb_encode.h>
+#include <services/whitelist_manager.h>
 
 struct CallbackSharedData
 {
-    char registration_id[128]; // For register request
-    uint8_t *uid_buffer;       // For revoke request UID
-    size_t uid_length;         // Length of UID
-    bool has_uid;              // Flag to indicate if we received a UID
+    char registration_id[128];          // For register request
+    uint8_t uid_buffer[MAX_UID_LENGTH]; // For revoke request UID
+    size_t uid_length;                  // Length of UID
+    bool has_uid;                       // Flag to indicate if we received a UID
+    WhiteListManager *whitelist;        // Applies snapshots and deltas while they are decoded
 };
 
 struct WifiCredentials
@@ -20,6 +23,15 @@ struct WifiCredentials
     size_t password_length;
 };
 
+/**
+ * @brief Creates a nanopb input stream that pulls bytes straight from a network client. A read fails
+ *        at once if it asks for more bytes than available() says the message still has.
+ * @param client Client positioned at the start of the payload whose available() counts the bytes
+ *        left in the message and whose read() waits for those in flight, as MqttClient does
+ * @param length Number of payload bytes available to the stream
+ */
+pb_istream_t pb_istream_from_client(Client &client, size_t length);
+
 bool encode_callback(pb_ostream_t *stream, const pb_field_t *field, void *const *arg);
 
 bool encode_string(pb_ostream_t *stream, const pb_field_t *field, void *const *arg);
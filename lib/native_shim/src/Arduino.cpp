@@ -0,0 +1,431 @@
+#include <Arduino.h>
+
+#include <chrono>
+
+// --- Clock ---
+
+static unsigned long skipped_us = 0;
+
+static unsigned long host_us()
+{
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+unsigned long micros()
+{
+    return host_us() + skipped_us;
+}
+
+unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+    skipped_us += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    skipped_us += us;
+}
+
+void yield()
+{
+}
+
+void sim::advance_us(unsigned long us)
+{
+    skipped_us += us;
+}
+
+// --- Pins and interrupts ---
+
+struct pin_state
+{
+    uint8_t mode;
+    int level;
+    int analog;
+    void (*isr)();
+    int isr_mode;
+};
+
+static pin_state pins[NUM_PINS];
+static sim::pin_reader digital_reader = nullptr;
+static bool interrupts_enabled = true;
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= NUM_PINS)
+        return;
+
+    pins[pin].mode = mode;
+    if (mode == INPUT_PULLUP)
+        pins[pin].level = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < NUM_PINS)
+        pins[pin].level = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (digital_reader)
+        return digital_reader(pin);
+
+    return pin < NUM_PINS ? pins[pin].level : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return pin < NUM_PINS ? pins[pin].analog : 0;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    if (pin < NUM_PINS)
+        pins[pin].analog = value;
+}
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+    return pin < NUM_PINS ? pin : -1;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode)
+{
+    if (interrupt < 0 || interrupt >= NUM_PINS)
+        return;
+
+    pins[interrupt].isr = isr;
+    pins[interrupt].isr_mode = mode;
+}
+
+void detachInterrupt(int interrupt)
+{
+    if (interrupt >= 0 && interrupt < NUM_PINS)
+        pins[interrupt].isr = nullptr;
+}
+
+void noInterrupts()
+{
+    interrupts_enabled = false;
+}
+
+void interrupts()
+{
+    interrupts_enabled = true;
+}
+
+bool isPrintable(int c)
+{
+    return c >= 0x20 && c < 0x7F;
+}
+
+void NVIC_SystemReset()
+{
+    printf("NVIC_SystemReset\n");
+    exit(0);
+}
+
+void sim::set_digital(uint8_t pin, int level)
+{
+    if (pin >= NUM_PINS)
+        return;
+
+    pin_state &state = pins[pin];
+    level = level ? HIGH : LOW;
+    bool falling = state.level == HIGH && level == LOW;
+    bool rising = state.level == LOW && level == HIGH;
+    state.level = level;
+
+    if (!state.isr || !interrupts_enabled)
+        return;
+
+    if ((state.isr_mode == FALLING && falling) || (state.isr_mode == RISING && rising) ||
+        (state.isr_mode == CHANGE && (falling || rising)))
+        state.isr();
+}
+
+int sim::get_digital(uint8_t pin)
+{
+    return pin < NUM_PINS ? pins[pin].level : LOW;
+}
+
+void sim::set_analog(uint8_t pin, int value)
+{
+    if (pin < NUM_PINS)
+        pins[pin].analog = value;
+}
+
+void sim::set_digital_reader(pin_reader reader)
+{
+    digital_reader = reader;
+}
+
+// --- String ---
+
+bool String::reserve_exact(unsigned int size)
+{
+    if (size <= capacity && buffer)
+        return true;
+
+    char *grown = (char *)realloc(buffer, size + 1);
+    if (!grown)
+        return false;
+
+    if (!buffer)
+        grown[0] = '\0';
+    buffer = grown;
+    capacity = size;
+    return true;
+}
+
+String &String::copy(const char *text, unsigned int length)
+{
+    if (!reserve_exact(length))
+        return *this;
+
+    memmove(buffer, text, length);
+    buffer[length] = '\0';
+    len = length;
+    return *this;
+}
+
+String::String(const char *text)
+{
+    if (text)
+        copy(text, strlen(text));
+}
+
+String::String(const String &other)
+{
+    copy(other.c_str(), other.len);
+}
+
+String::String(String &&other) : buffer(other.buffer), len(other.len), capacity(other.capacity)
+{
+    other.buffer = nullptr;
+    other.len = 0;
+    other.capacity = 0;
+}
+
+String::String(char c)
+{
+    copy(&c, 1);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base)
+{
+}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base)
+{
+}
+
+String::String(long value, unsigned char base)
+{
+    char text[34];
+    snprintf(text, sizeof(text), base == HEX ? "%lx" : "%ld", value);
+    copy(text, strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+    char text[34];
+    snprintf(text, sizeof(text), base == HEX ? "%lx" : "%lu", value);
+    copy(text, strlen(text));
+}
+
+String::~String()
+{
+    free(buffer);
+}
+
+String &String::operator=(const String &other)
+{
+    if (this != &other)
+        copy(other.c_str(), other.len);
+    return *this;
+}
+
+String &String::operator=(String &&other)
+{
+    if (this != &other)
+    {
+        free(buffer);
+        buffer = other.buffer;
+        len = other.len;
+        capacity = other.capacity;
+        other.buffer = nullptr;
+        other.len = 0;
+        other.capacity = 0;
+    }
+    return *this;
+}
+
+String &String::operator=(const char *text)
+{
+    if (!text)
+    {
+        len = 0;
+        if (buffer)
+            buffer[0] = '\0';
+        return *this;
+    }
+    return copy(text, strlen(text));
+}
+
+unsigned char String::reserve(unsigned int size)
+{
+    return reserve_exact(size);
+}
+
+unsigned char String::concat(const char *text, unsigned int length)
+{
+    if (!text)
+        return 0;
+    if (length == 0)
+        return 1;
+    if (!reserve_exact(len + length))
+        return 0;
+
+    memcpy(buffer + len, text, length);
+    len += length;
+    buffer[len] = '\0';
+    return 1;
+}
+
+unsigned char String::concat(const String &other)
+{
+    return concat(other.c_str(), other.len);
+}
+
+unsigned char String::concat(const char *text)
+{
+    return text ? concat(text, strlen(text)) : 0;
+}
+
+unsigned char String::concat(char c)
+{
+    return concat(&c, 1);
+}
+
+bool String::equals(const char *text) const
+{
+    return strcmp(c_str(), text ? text : "") == 0;
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String &lhs, char rhs)
+{
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+// --- Print and streams ---
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::print_number(unsigned long value, int base, bool negative)
+{
+    char text[34];
+    if (base == HEX)
+        snprintf(text, sizeof(text), "%lX", value);
+    else
+        snprintf(text, sizeof(text), negative ? "-%lu" : "%lu", value);
+    return write(text);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == DEC && value < 0)
+        return print_number(-(unsigned long)value, base, true);
+    return print_number((unsigned long)value, base, false);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    unsigned long start = millis();
+
+    while (count < length && millis() - start < timeout_ms)
+    {
+        int c = read();
+        if (c < 0)
+        {
+            yield();
+            continue;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+static bool serial_echo = true;
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (console && serial_echo)
+        putchar(c);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (console && serial_echo)
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void sim::set_serial_echo(bool echo)
+{
+    serial_echo = echo;
+}
+
+HardwareSerial Serial(true);
+HardwareSerial Serial1(false);
@@ -0,0 +1,262 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino core the firmware uses.
+ *
+ * String keeps its text on the heap through malloc and realloc as on the board, so the heap probe
+ * sees the same allocations. Everything else is static.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <native_sim.h>
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define NUM_PINS 20
+
+#define F(string_literal) (string_literal)
+
+template <class A, class B>
+auto min(const A &a, const B &b) -> decltype(a < b ? a : b)
+{
+    return b < a ? b : a;
+}
+
+template <class A, class B>
+auto max(const A &a, const B &b) -> decltype(a < b ? a : b)
+{
+    return a < b ? b : a;
+}
+
+// --- Time ---
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// --- Pins and interrupts ---
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+void noInterrupts();
+void interrupts();
+
+bool isPrintable(int c);
+void NVIC_SystemReset();
+
+// --- String ---
+
+class String
+{
+private:
+    char *buffer = nullptr;
+    unsigned int len = 0;
+    unsigned int capacity = 0;
+
+    bool reserve_exact(unsigned int size);
+    String &copy(const char *text, unsigned int length);
+
+public:
+    String(const char *text = "");
+    String(const String &other);
+    String(String &&other);
+    explicit String(char c);
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    ~String();
+
+    String &operator=(const String &other);
+    String &operator=(String &&other);
+    String &operator=(const char *text);
+
+    unsigned char reserve(unsigned int size);
+    unsigned char concat(const String &other);
+    unsigned char concat(const char *text);
+    unsigned char concat(const char *text, unsigned int length);
+    unsigned char concat(char c);
+
+    String &operator+=(const String &other)
+    {
+        concat(other);
+        return *this;
+    }
+    String &operator+=(const char *text)
+    {
+        concat(text);
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        concat(c);
+        return *this;
+    }
+
+    const char *c_str() const { return buffer ? buffer : ""; }
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    char operator[](unsigned int index) const { return index < len ? buffer[index] : 0; }
+
+    bool equals(const char *text) const;
+    bool operator==(const String &other) const { return equals(other.c_str()); }
+    bool operator==(const char *text) const { return equals(text); }
+    bool operator!=(const String &other) const { return !equals(other.c_str()); }
+    bool operator!=(const char *text) const { return !equals(text); }
+
+    friend String operator+(const String &lhs, const String &rhs);
+    friend String operator+(const String &lhs, const char *rhs);
+    friend String operator+(const char *lhs, const String &rhs);
+    friend String operator+(const String &lhs, char rhs);
+};
+
+// Declared for libraries that adapt the core's String types (ArduinoJson)
+class StringSumHelper : public String
+{
+public:
+    using String::String;
+};
+
+// --- Print and streams ---
+
+class Print;
+
+class Printable
+{
+public:
+    virtual ~Printable() = default;
+    virtual size_t printTo(Print &out) const = 0;
+};
+
+class Print
+{
+private:
+    size_t print_number(unsigned long value, int base, bool negative);
+
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print_number(value, base, false); }
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC) { return print_number(value, base, false); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC) { return print_number(value, base, false); }
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable &printable) { return printable.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+
+    template <typename T>
+    size_t println(const T &value, int format)
+    {
+        size_t n = print(value, format);
+        return n + println();
+    }
+};
+
+class Stream : public Print
+{
+protected:
+    unsigned long timeout_ms = 1000;
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { timeout_ms = timeout; }
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+};
+
+class Client : public Stream
+{
+public:
+    virtual int connect(const char *host, uint16_t port) = 0;
+    virtual int read(uint8_t *buffer, size_t size) = 0;
+    using Stream::read;
+    virtual void flush() {}
+    virtual void stop() {}
+    virtual uint8_t connected() = 0;
+    virtual operator bool() { return connected(); }
+};
+
+/**
+ * @brief Serial port. Serial copies its output to stdout (see sim::set_serial_echo()); Serial1 leads
+ *        to the relay board and discards it.
+ */
+class HardwareSerial : public Stream
+{
+private:
+    bool console;
+
+public:
+    explicit HardwareSerial(bool console) : console(console) {}
+
+    void begin(unsigned long baud) {}
+    void end() {}
+    operator bool() { return true; }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif // NATIVE_ARDUINO_H
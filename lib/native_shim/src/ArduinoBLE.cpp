@@ -0,0 +1,3 @@
+#include <ArduinoBLE.h>
+
+BLELocalDevice BLE;
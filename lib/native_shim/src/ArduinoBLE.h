@@ -0,0 +1,59 @@
+/**
+ * @file ArduinoBLE.h
+ * @brief Host stand-in for ArduinoBLE. Nothing connects; provisioning over BLE is not simulated.
+ */
+
+#ifndef NATIVE_ARDUINO_BLE_H
+#define NATIVE_ARDUINO_BLE_H
+
+#include <Arduino.h>
+
+#define BLERead 0x02
+#define BLEWrite 0x08
+#define BLENotify 0x10
+
+enum BLECharacteristicEvent
+{
+    BLESubscribed = 0,
+    BLEUnsubscribed = 1,
+    BLERead_Event = 2,
+    BLEWritten = 3
+};
+
+class BLEDevice
+{
+};
+
+class BLECharacteristic
+{
+public:
+    typedef void (*event_handler)(BLEDevice device, BLECharacteristic characteristic);
+
+    BLECharacteristic(const char *uuid, uint8_t properties, int value_size) {}
+
+    int valueLength() const { return 0; }
+    const uint8_t *value() const { return nullptr; }
+    void setEventHandler(int event, event_handler handler) {}
+};
+
+class BLEService
+{
+public:
+    BLEService(const char *uuid) {}
+    void addCharacteristic(BLECharacteristic &characteristic) {}
+};
+
+class BLELocalDevice
+{
+public:
+    int begin() { return 1; }
+    void setLocalName(const char *name) {}
+    void setAdvertisedService(BLEService &service) {}
+    void addService(BLEService &service) {}
+    int advertise() { return 1; }
+    void poll() {}
+};
+
+extern BLELocalDevice BLE;
+
+#endif // NATIVE_ARDUINO_BLE_H
@@ -0,0 +1,251 @@
+#include <ArduinoMqttClient.h>
+
+#define BROKER_TOPICS 32
+#define BROKER_SUBSCRIPTIONS 32
+#define BROKER_INBOX 8
+#define BROKER_MESSAGE_SIZE 2048
+
+struct inbound_message
+{
+    char topic[MQTT_CLIENT_TOPIC_SIZE];
+    uint8_t payload[BROKER_MESSAGE_SIZE];
+    size_t length;
+    uint32_t bytes_per_ms;
+};
+
+static bool online = true;
+static uint32_t epoch = 0; // sessions opened before the last drop_sessions() are closed
+static sim::topic_stats topics[BROKER_TOPICS];
+static uint8_t topic_count = 0;
+static uint32_t messages = 0;
+static uint32_t bytes = 0;
+static char subscribed[BROKER_SUBSCRIPTIONS][MQTT_CLIENT_TOPIC_SIZE];
+static uint8_t subscribe_count = 0;
+static inbound_message inbox[BROKER_INBOX];
+static uint8_t inbox_head = 0;
+static uint8_t inbox_count = 0;
+
+void sim::broker_reset()
+{
+    topic_count = 0;
+    messages = 0;
+    bytes = 0;
+    subscribe_count = 0;
+    inbox_head = 0;
+    inbox_count = 0;
+}
+
+void sim::set_broker(bool available)
+{
+    online = available;
+}
+
+void sim::drop_sessions()
+{
+    epoch++;
+}
+
+bool sim::inject_message(const char *topic, const uint8_t *payload, size_t length, uint32_t bytes_per_ms)
+{
+    if (inbox_count == BROKER_INBOX || length > BROKER_MESSAGE_SIZE || strlen(topic) >= MQTT_CLIENT_TOPIC_SIZE)
+        return false;
+
+    inbound_message &message = inbox[(inbox_head + inbox_count) % BROKER_INBOX];
+    strcpy(message.topic, topic);
+    memcpy(message.payload, payload, length);
+    message.length = length;
+    message.bytes_per_ms = bytes_per_ms;
+    inbox_count++;
+    return true;
+}
+
+uint32_t sim::published_messages()
+{
+    return messages;
+}
+
+uint32_t sim::published_bytes()
+{
+    return bytes;
+}
+
+const sim::topic_stats *sim::find_topic(const char *topic)
+{
+    for (uint8_t i = 0; i < topic_count; i++)
+    {
+        if (strcmp(topics[i].topic, topic) == 0)
+            return &topics[i];
+    }
+    return nullptr;
+}
+
+uint8_t sim::subscriptions()
+{
+    return subscribe_count;
+}
+
+const char *sim::subscription(uint8_t index)
+{
+    return index < subscribe_count && index < BROKER_SUBSCRIPTIONS ? subscribed[index] : nullptr;
+}
+
+static void deliver(const char *topic, const uint8_t *payload, size_t length)
+{
+    messages++;
+    bytes += length;
+
+    sim::topic_stats *stats = (sim::topic_stats *)sim::find_topic(topic);
+    if (!stats)
+    {
+        if (topic_count == BROKER_TOPICS)
+            return;
+
+        stats = &topics[topic_count++];
+        memset(stats, 0, sizeof(*stats));
+        strncpy(stats->topic, topic, sizeof(stats->topic) - 1);
+    }
+
+    stats->messages++;
+    stats->bytes += length;
+    stats->last_length = min(length, sizeof(stats->last_payload));
+    memcpy(stats->last_payload, payload, stats->last_length);
+}
+
+int MqttClient::connect(const char *host, uint16_t port)
+{
+    session = online;
+    session_epoch = epoch;
+    return session;
+}
+
+uint8_t MqttClient::connected()
+{
+    if (session_epoch != epoch)
+        session = false;
+    return session;
+}
+
+void MqttClient::poll()
+{
+    if (!connected() || !inbox_count)
+        return;
+
+    inbound_message &message = inbox[inbox_head];
+    strcpy(rx_topic, message.topic);
+    rx_payload = message.payload;
+    rx_length = message.length;
+    rx_index = 0;
+    rx_start_ms = millis();
+    rx_bytes_per_ms = message.bytes_per_ms;
+
+    if (on_message)
+        on_message((int)rx_length);
+
+    // Whatever the callback left unread is skipped, as the library does
+    rx_payload = nullptr;
+    rx_length = 0;
+    rx_index = 0;
+    inbox_head = (inbox_head + 1) % BROKER_INBOX;
+    inbox_count--;
+}
+
+int MqttClient::subscribe(const char *topic, uint8_t qos)
+{
+    if (!connected())
+        return 0;
+
+    if (subscribe_count < BROKER_SUBSCRIPTIONS)
+        strncpy(subscribed[subscribe_count], topic, MQTT_CLIENT_TOPIC_SIZE - 1);
+    subscribe_count++;
+    return 1;
+}
+
+int MqttClient::beginMessage(const char *topic, bool retain, uint8_t qos, bool dup)
+{
+    if (!connected() || strlen(topic) >= sizeof(tx_topic))
+        return 0;
+
+    strcpy(tx_topic, topic);
+    tx_length = 0;
+    tx_open = true;
+    return 1;
+}
+
+int MqttClient::beginMessage(const char *topic, unsigned long size, bool retain, uint8_t qos, bool dup)
+{
+    return beginMessage(topic, retain, qos, dup);
+}
+
+size_t MqttClient::write(const uint8_t *buffer, size_t size)
+{
+    if (!tx_open)
+        return 0;
+
+    size = min(size, sizeof(tx_payload) - tx_length);
+    memcpy(tx_payload + tx_length, buffer, size);
+    tx_length += size;
+    return size;
+}
+
+int MqttClient::endMessage()
+{
+    if (!tx_open)
+        return 0;
+
+    tx_open = false;
+    if (!connected())
+        return 0;
+
+    deliver(tx_topic, tx_payload, tx_length);
+    return 1;
+}
+
+size_t MqttClient::rx_arrived() const
+{
+    if (!rx_bytes_per_ms)
+        return rx_length;
+
+    return min((size_t)((millis() - rx_start_ms + 1) * rx_bytes_per_ms), rx_length);
+}
+
+int MqttClient::available()
+{
+    return rx_payload ? (int)(rx_length - rx_index) : 0;
+}
+
+int MqttClient::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int MqttClient::read(uint8_t *buffer, size_t size)
+{
+    size = min(size, (size_t)available());
+
+    // Like the library's timed read, wait for bytes in flight until one is late by the timeout
+    size_t done = 0;
+    unsigned long last_byte = millis();
+    while (done < size)
+    {
+        size_t ready = min(rx_arrived() - rx_index, size - done);
+        if (ready == 0)
+        {
+            if (millis() - last_byte >= MQTT_CLIENT_READ_TIMEOUT_MS)
+                break;
+            delay(1);
+            continue;
+        }
+
+        memcpy(buffer + done, rx_payload + rx_index, ready);
+        rx_index += ready;
+        done += ready;
+        last_byte = millis();
+    }
+    return (int)done;
+}
+
+int MqttClient::peek()
+{
+    return rx_payload && rx_arrived() > rx_index ? rx_payload[rx_index] : -1;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file ArduinoMqttClient.h
+ * @brief Host stand-in for ArduinoMqttClient, talking to an in-process broker.
+ *
+ * Published messages are counted per topic by the broker (see native_sim.h). Inbound messages
+ * queued with sim::inject_message() are delivered from poll() through the onMessage callback, and
+ * their payload is read through the Client interface as on the board: available() counts the bytes
+ * left in the message and read() waits for those still in flight. Like the library, a message
+ * started without a size buffers at most MQTT_CLIENT_TX_PAYLOAD_SIZE bytes and drops the rest.
+ */
+
+#ifndef NATIVE_ARDUINO_MQTT_CLIENT_H
+#define NATIVE_ARDUINO_MQTT_CLIENT_H
+
+#include <Arduino.h>
+
+#define MQTT_CLIENT_TX_PAYLOAD_SIZE 256 ///< The library's default transmit payload buffer
+#define MQTT_CLIENT_TOPIC_SIZE 128
+#define MQTT_CLIENT_READ_TIMEOUT_MS 1000 ///< The library's wait for the next payload byte
+
+class MqttClient : public Client
+{
+private:
+    Client *client;
+    void (*on_message)(int size) = nullptr;
+    bool session = false;
+    uint32_t session_epoch = 0; ///< Broker epoch the session was opened in
+
+    // Message being published
+    bool tx_open = false;
+    char tx_topic[MQTT_CLIENT_TOPIC_SIZE];
+    uint8_t tx_payload[MQTT_CLIENT_TX_PAYLOAD_SIZE];
+    size_t tx_length = 0;
+
+    // Message being received
+    char rx_topic[MQTT_CLIENT_TOPIC_SIZE];
+    const uint8_t *rx_payload = nullptr;
+    size_t rx_length = 0;
+    size_t rx_index = 0;
+    unsigned long rx_start_ms = 0;
+    uint32_t rx_bytes_per_ms = 0;
+
+    size_t rx_arrived() const;
+
+public:
+    MqttClient(Client *client) : client(client) {}
+    MqttClient(Client &client) : client(&client) {}
+
+    void setId(const char *id) {}
+    void setUsernamePassword(const char *username, const char *password) {}
+    void setKeepAliveInterval(unsigned long interval) {}
+    void setConnectionTimeout(unsigned long timeout) {}
+
+    int connect(const char *host, uint16_t port = 1883) override;
+    uint8_t connected() override;
+    void stop() override { session = false; }
+
+    void poll();
+    void onMessage(void (*callback)(int size)) { on_message = callback; }
+    int subscribe(const char *topic, uint8_t qos = 0);
+
+    int beginMessage(const char *topic, bool retain = false, uint8_t qos = 0, bool dup = false);
+    int beginMessage(const char *topic, unsigned long size, bool retain = false, uint8_t qos = 0, bool dup = false);
+    int endMessage();
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    String messageTopic() const { return String(rx_topic); }
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+};
+
+#endif // NATIVE_ARDUINO_MQTT_CLIENT_H
@@ -0,0 +1,36 @@
+#include <DHT.h>
+
+#define DHT_READ_US 4500       // Start signal and 40 bits
+#define DHT_MIN_INTERVAL_MS 2000
+
+static float temperature = 21.0f;
+static float humidity = 45.0f;
+
+void sim::set_climate(float t, float h)
+{
+    temperature = t;
+    humidity = h;
+}
+
+void DHT::read()
+{
+    unsigned long now = millis();
+    if (has_read && now - last_read_ms < DHT_MIN_INTERVAL_MS)
+        return;
+
+    sim::advance_us(DHT_READ_US);
+    last_read_ms = now;
+    has_read = true;
+}
+
+float DHT::readTemperature(bool fahrenheit, bool force)
+{
+    read();
+    return fahrenheit ? temperature * 1.8f + 32 : temperature;
+}
+
+float DHT::readHumidity(bool force)
+{
+    read();
+    return humidity;
+}
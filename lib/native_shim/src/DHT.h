@@ -0,0 +1,33 @@
+/**
+ * @file DHT.h
+ * @brief Host stand-in for the Adafruit DHT driver. Readings come from sim::set_climate().
+ *
+ * Like the driver, a read blocks for the bit-banged transfer and is reused for two seconds.
+ */
+
+#ifndef NATIVE_DHT_H
+#define NATIVE_DHT_H
+
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT22 22
+
+class DHT
+{
+private:
+    uint8_t pin;
+    unsigned long last_read_ms = 0;
+    bool has_read = false;
+
+    void read();
+
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : pin(pin) {}
+
+    void begin(uint8_t pull_time_us = 55) {}
+    float readTemperature(bool fahrenheit = false, bool force = false);
+    float readHumidity(bool force = false);
+};
+
+#endif // NATIVE_DHT_H
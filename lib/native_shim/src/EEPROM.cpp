@@ -0,0 +1,62 @@
+#include <EEPROM.h>
+
+static uint8_t memory[EEPROM_SIZE];
+static bool erased = false;
+static long writes_left = -1;
+static bool failed = false;
+static uint32_t writes = 0;
+
+void sim::eeprom_erase()
+{
+    memset(memory, 0xFF, sizeof(memory));
+    erased = true;
+    writes_left = -1;
+    failed = false;
+    writes = 0;
+}
+
+void sim::eeprom_fail_after(long count)
+{
+    writes_left = count;
+    failed = false;
+}
+
+bool sim::eeprom_failed()
+{
+    return failed;
+}
+
+uint32_t sim::eeprom_writes()
+{
+    return writes;
+}
+
+uint8_t EEPROMClass::read(int address) const
+{
+    if (!erased)
+        sim::eeprom_erase();
+
+    return address >= 0 && address < EEPROM_SIZE ? memory[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (!erased)
+        sim::eeprom_erase();
+
+    if (address < 0 || address >= EEPROM_SIZE)
+        return;
+
+    if (writes_left == 0)
+    {
+        failed = true;
+        return;
+    }
+    if (writes_left > 0)
+        writes_left--;
+
+    memory[address] = value;
+    writes++;
+}
+
+EEPROMClass EEPROM;
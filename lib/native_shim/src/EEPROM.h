@@ -0,0 +1,51 @@
+/**
+ * @file EEPROM.h
+ * @brief Host stand-in for the UNO R4 data flash, 8 KB erased to 0xFF.
+ *
+ * sim::eeprom_fail_after() drops writes from a given point on, so tests can cut the power in the
+ * middle of a save and reload what survived.
+ */
+
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+#include <Arduino.h>
+
+#define EEPROM_SIZE 8192
+
+class EEPROMClass
+{
+public:
+    void begin() {}
+    uint16_t length() const { return EEPROM_SIZE; }
+
+    uint8_t read(int address) const;
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value)
+    {
+        if (read(address) != value)
+            write(address, value);
+    }
+
+    template <typename T>
+    T &get(int address, T &value) const
+    {
+        uint8_t *bytes = (uint8_t *)&value;
+        for (size_t i = 0; i < sizeof(T); i++)
+            bytes[i] = read(address + i);
+        return value;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        const uint8_t *bytes = (const uint8_t *)&value;
+        for (size_t i = 0; i < sizeof(T); i++)
+            update(address + i, bytes[i]);
+        return value;
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_H
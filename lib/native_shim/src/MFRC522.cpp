@@ -0,0 +1,226 @@
+#include <MFRC522.h>
+#include <SPI.h>
+
+#define SPI_TRANSFER_US 5      // One register access: address and data byte at 4 MHz plus chip select
+#define CARD_ANSWER_US 300     // Frame out, card response and FIFO read-back
+#define READER_TIMEOUT_US 25000 // Timer set up by PCD_Init; a command nobody answers ends with it
+
+#define COM_IRQ_SET1 0x80
+#define COM_IRQ_TX 0x40
+#define COM_IRQ_RX 0x20
+#define COM_IRQ_IDLE 0x10
+#define COM_IRQ_TIMER 0x01
+#define COM_IEN_IRQ_INV 0x80
+#define BIT_FRAMING_START_SEND 0x80
+
+static byte registers[64];
+static byte fifo[64];
+static uint8_t fifo_length = 0;
+static uint32_t transfers = 0;
+static int irq_pin = -1;
+
+static byte card_uid[10];
+static uint8_t card_size = 0;
+static bool card_present = false;
+static bool card_halted = false;
+
+// The IRQ output is active when an enabled interrupt request is pending; IRqInv makes it active low
+static void update_irq_line()
+{
+    if (irq_pin < 0)
+        return;
+
+    byte enabled = registers[MFRC522::ComIEnReg >> 1];
+    bool active = registers[MFRC522::ComIrqReg >> 1] & enabled & 0x7F;
+    bool inverted = enabled & COM_IEN_IRQ_INV;
+    sim::set_digital(irq_pin, active != inverted ? HIGH : LOW);
+}
+
+static void spi_transfer()
+{
+    transfers++;
+    sim::advance_us(SPI_TRANSFER_US);
+}
+
+static bool card_answers(byte command)
+{
+    if (!card_present)
+        return false;
+
+    if (command == MFRC522::PICC_CMD_WUPA)
+        card_halted = false;
+    return !card_halted;
+}
+
+// Runs the command in CommandReg once the frame is started. Only the answer to REQA/WUPA and the
+// selection frames are modelled; their content is not needed by the firmware.
+static void transceive()
+{
+    byte command = fifo_length ? fifo[0] : 0;
+    fifo_length = 0;
+
+    byte &irq = registers[MFRC522::ComIrqReg >> 1];
+    irq |= COM_IRQ_TX;
+
+    if (card_answers(command))
+    {
+        sim::advance_us(CARD_ANSWER_US);
+        irq |= COM_IRQ_RX | COM_IRQ_IDLE;
+    }
+    else
+    {
+        irq |= COM_IRQ_TIMER;
+    }
+    update_irq_line();
+}
+
+void MFRC522::PCD_Init()
+{
+    memset(registers, 0, sizeof(registers));
+    fifo_length = 0;
+    for (int i = 0; i < 8; i++)
+        spi_transfer();
+}
+
+void MFRC522::PCD_WriteRegister(PCD_Register reg, byte value)
+{
+    spi_transfer();
+    byte index = reg >> 1;
+
+    switch (reg)
+    {
+    case ComIrqReg:
+        if (value & COM_IRQ_SET1)
+            registers[index] |= value & 0x7F;
+        else
+            registers[index] &= ~(value & 0x7F);
+        break;
+
+    case FIFODataReg:
+        if (fifo_length < sizeof(fifo))
+            fifo[fifo_length++] = value;
+        break;
+
+    case FIFOLevelReg:
+        if (value & 0x80)
+            fifo_length = 0;
+        break;
+
+    case BitFramingReg:
+        registers[index] = value & ~BIT_FRAMING_START_SEND;
+        if ((value & BIT_FRAMING_START_SEND) && registers[CommandReg >> 1] == PCD_Transceive)
+            transceive();
+        break;
+
+    default:
+        registers[index] = value;
+        break;
+    }
+
+    update_irq_line();
+}
+
+byte MFRC522::PCD_ReadRegister(PCD_Register reg)
+{
+    spi_transfer();
+
+    if (reg == FIFOLevelReg)
+        return fifo_length;
+    if (reg == VersionReg)
+        return 0x92;
+    return registers[reg >> 1];
+}
+
+// What the library does for one frame: stop the running command, clear the requests and the FIFO,
+// load the frame, start the transceive and poll ComIrqReg until the card answered or the timer expired
+static bool exchange(MFRC522 &reader, byte command, byte bit_framing)
+{
+    reader.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Idle);
+    reader.PCD_WriteRegister(MFRC522::ComIrqReg, 0x7F);
+    reader.PCD_WriteRegister(MFRC522::FIFOLevelReg, 0x80);
+    reader.PCD_WriteRegister(MFRC522::FIFODataReg, command);
+    reader.PCD_WriteRegister(MFRC522::BitFramingReg, bit_framing);
+    reader.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+    reader.PCD_WriteRegister(MFRC522::BitFramingReg, bit_framing | BIT_FRAMING_START_SEND);
+
+    byte irq = reader.PCD_ReadRegister(MFRC522::ComIrqReg);
+    if (irq & COM_IRQ_RX)
+    {
+        reader.PCD_ReadRegister(MFRC522::ErrorReg);
+        reader.PCD_ReadRegister(MFRC522::FIFOLevelReg);
+        return true;
+    }
+
+    // The library keeps reading ComIrqReg until the timer request shows up
+    transfers += READER_TIMEOUT_US / SPI_TRANSFER_US;
+    sim::advance_us(READER_TIMEOUT_US);
+    return false;
+}
+
+bool MFRC522::PICC_IsNewCardPresent()
+{
+    // Reset baud rates and modulation width, then REQA as a 7-bit short frame
+    PCD_WriteRegister(TxModeReg, 0x00);
+    PCD_WriteRegister(RxModeReg, 0x00);
+    PCD_WriteRegister(ModWidthReg, 0x26);
+    PCD_WriteRegister(CollReg, 0x80);
+    return exchange(*this, PICC_CMD_REQA, 0x07);
+}
+
+bool MFRC522::PICC_ReadCardSerial()
+{
+    // Anticollision and select for each cascade level: 4-byte UIDs need one, 7-byte two, 10-byte three
+    uint8_t levels = card_size <= 4 ? 1 : card_size <= 7 ? 2 : 3;
+    for (uint8_t level = 0; level < levels; level++)
+    {
+        if (!exchange(*this, 0x93 + 2 * level, 0x00) || !exchange(*this, 0x93 + 2 * level, 0x00))
+            return false;
+    }
+
+    uid.size = card_size;
+    memcpy(uid.uidByte, card_uid, card_size);
+    uid.sak = 0x08;
+    return true;
+}
+
+MFRC522::StatusCode MFRC522::PICC_HaltA()
+{
+    // A halted card does not answer; the library takes the timeout as success
+    card_halted = true;
+    exchange(*this, PICC_CMD_HLTA, 0x00);
+    return STATUS_OK;
+}
+
+void MFRC522::PCD_StopCrypto1()
+{
+    PCD_ReadRegister(Status2Reg);
+    PCD_WriteRegister(Status2Reg, 0x00);
+}
+
+void sim::present_card(const uint8_t *uid, uint8_t size)
+{
+    size = min(size, (uint8_t)sizeof(card_uid));
+    memcpy(card_uid, uid, size);
+    card_size = size;
+    card_present = true;
+    card_halted = false;
+}
+
+void sim::remove_card()
+{
+    card_present = false;
+    card_halted = false;
+}
+
+void sim::set_rfid_irq_pin(int pin)
+{
+    irq_pin = pin;
+    update_irq_line();
+}
+
+uint32_t sim::spi_transfers()
+{
+    return transfers;
+}
+
+SPIClass SPI;
@@ -0,0 +1,94 @@
+/**
+ * @file MFRC522.h
+ * @brief Host model of an MFRC522 reader behind SPI, with one card that can be put in its field.
+ *
+ * Register accesses are counted as SPI transfers and advance the simulated clock by the time they
+ * take on the bus; a command that waits for the card costs its air time, or the reader's 25 ms
+ * timeout when nothing answers. ComIrqReg and ComIEnReg behave as on the chip and drive the IRQ
+ * line wired with sim::set_rfid_irq_pin(), so interrupt-driven detection can be exercised.
+ */
+
+#ifndef NATIVE_MFRC522_H
+#define NATIVE_MFRC522_H
+
+#include <Arduino.h>
+
+class MFRC522
+{
+public:
+    enum PCD_Register : byte
+    {
+        CommandReg = 0x01 << 1,
+        ComIEnReg = 0x02 << 1,
+        DivIEnReg = 0x03 << 1,
+        ComIrqReg = 0x04 << 1,
+        DivIrqReg = 0x05 << 1,
+        ErrorReg = 0x06 << 1,
+        Status1Reg = 0x07 << 1,
+        Status2Reg = 0x08 << 1,
+        FIFODataReg = 0x09 << 1,
+        FIFOLevelReg = 0x0A << 1,
+        WaterLevelReg = 0x0B << 1,
+        ControlReg = 0x0C << 1,
+        BitFramingReg = 0x0D << 1,
+        CollReg = 0x0E << 1,
+        ModeReg = 0x11 << 1,
+        TxModeReg = 0x12 << 1,
+        RxModeReg = 0x13 << 1,
+        TxControlReg = 0x14 << 1,
+        TxASKReg = 0x15 << 1,
+        ModWidthReg = 0x24 << 1,
+        TModeReg = 0x2A << 1,
+        TPrescalerReg = 0x2B << 1,
+        TReloadRegH = 0x2C << 1,
+        TReloadRegL = 0x2D << 1,
+        VersionReg = 0x37 << 1
+    };
+
+    enum PCD_Command : byte
+    {
+        PCD_Idle = 0x00,
+        PCD_CalcCRC = 0x03,
+        PCD_Transmit = 0x04,
+        PCD_Receive = 0x08,
+        PCD_Transceive = 0x0C,
+        PCD_SoftReset = 0x0F
+    };
+
+    enum PICC_Command : byte
+    {
+        PICC_CMD_REQA = 0x26,
+        PICC_CMD_WUPA = 0x52,
+        PICC_CMD_HLTA = 0x50
+    };
+
+    enum StatusCode : byte
+    {
+        STATUS_OK,
+        STATUS_ERROR,
+        STATUS_COLLISION,
+        STATUS_TIMEOUT
+    };
+
+    typedef struct
+    {
+        byte size;
+        byte uidByte[10];
+        byte sak;
+    } Uid;
+
+    Uid uid;
+
+    MFRC522(byte chip_select_pin, byte reset_pin) {}
+
+    void PCD_Init();
+    void PCD_WriteRegister(PCD_Register reg, byte value);
+    byte PCD_ReadRegister(PCD_Register reg);
+
+    bool PICC_IsNewCardPresent();
+    bool PICC_ReadCardSerial();
+    StatusCode PICC_HaltA();
+    void PCD_StopCrypto1();
+};
+
+#endif // NATIVE_MFRC522_H
@@ -0,0 +1,20 @@
+/**
+ * @file SPI.h
+ * @brief Host stand-in for the SPI bus. The MFRC522 model charges the time of its transfers.
+ */
+
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+#include <Arduino.h>
+
+class SPIClass
+{
+public:
+    void begin() {}
+    void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif // NATIVE_SPI_H
@@ -0,0 +1,18 @@
+#include <SerialTransfer.h>
+
+static uint32_t packets = 0;
+
+uint8_t SerialTransfer::sendData(const uint16_t &length, const uint8_t packet_id)
+{
+    if (!port)
+        return 0;
+
+    packets++;
+    return (uint8_t)length;
+}
+
+uint32_t sim::serial_packets()
+{
+    return packets;
+}
+
@@ -0,0 +1,49 @@
+/**
+ * @file SerialTransfer.h
+ * @brief Host stand-in for SerialTransfer. Packets to the relay board are counted and dropped;
+ *        nothing is received.
+ */
+
+#ifndef NATIVE_SERIAL_TRANSFER_H
+#define NATIVE_SERIAL_TRANSFER_H
+
+#include <Arduino.h>
+
+#define SERIAL_TRANSFER_BUFFER_SIZE 254
+
+class SerialTransfer
+{
+private:
+    Stream *port = nullptr;
+
+public:
+    uint8_t packetBuff[SERIAL_TRANSFER_BUFFER_SIZE];
+    int8_t status = 0;
+
+    void begin(Stream &stream, bool debug = true, Stream &debug_port = Serial, uint32_t timeout = 50)
+    {
+        port = &stream;
+    }
+
+    uint8_t available() { return 0; }
+
+    template <typename T>
+    uint16_t txObj(const T &value, const uint16_t &index = 0, const uint16_t &length = sizeof(T))
+    {
+        uint16_t end = min((uint16_t)(index + length), (uint16_t)SERIAL_TRANSFER_BUFFER_SIZE);
+        memcpy(packetBuff + index, &value, end - index);
+        return end;
+    }
+
+    template <typename T>
+    uint16_t rxObj(T &value, const uint16_t &index = 0, const uint16_t &length = sizeof(T))
+    {
+        uint16_t end = min((uint16_t)(index + length), (uint16_t)SERIAL_TRANSFER_BUFFER_SIZE);
+        memcpy(&value, packetBuff + index, end - index);
+        return end;
+    }
+
+    uint8_t sendData(const uint16_t &length, const uint8_t packet_id = 0);
+};
+
+#endif // NATIVE_SERIAL_TRANSFER_H
@@ -0,0 +1,29 @@
+/**
+ * @file Servo.h
+ * @brief Host stand-in for the Servo library; keeps the last angle.
+ */
+
+#ifndef NATIVE_SERVO_H
+#define NATIVE_SERVO_H
+
+#include <Arduino.h>
+
+class Servo
+{
+private:
+    int pin = -1;
+    int angle = 0;
+
+public:
+    uint8_t attach(int pin)
+    {
+        this->pin = pin;
+        return 1;
+    }
+    void detach() { pin = -1; }
+    bool attached() { return pin >= 0; }
+    void write(int value) { angle = value; }
+    int read() { return angle; }
+};
+
+#endif // NATIVE_SERVO_H
@@ -0,0 +1,65 @@
+#include <WiFi.h>
+
+static bool available = true;
+static bool associated = false;
+static unsigned long network_epoch = 0;
+static unsigned long network_epoch_ms = 0;
+static char ssid[33];
+
+size_t IPAddress::printTo(Print &out) const
+{
+    size_t n = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (i)
+            n += out.print('.');
+        n += out.print(octets[i]);
+    }
+    return n;
+}
+
+int WiFiClass::begin(const char *name, const char *password)
+{
+    strncpy(ssid, name ? name : "", sizeof(ssid) - 1);
+    associated = available;
+    return status();
+}
+
+int WiFiClass::disconnect()
+{
+    associated = false;
+    return WL_DISCONNECTED;
+}
+
+int WiFiClass::status()
+{
+    return associated && available ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+const char *WiFiClass::SSID()
+{
+    return ssid;
+}
+
+unsigned long WiFiClass::getTime()
+{
+    if (!network_epoch || status() != WL_CONNECTED)
+        return 0;
+
+    return network_epoch + (millis() - network_epoch_ms) / 1000;
+}
+
+void sim::set_wifi(bool connected)
+{
+    available = connected;
+    if (!connected)
+        associated = false;
+}
+
+void sim::set_network_time(unsigned long epoch)
+{
+    network_epoch = epoch;
+    network_epoch_ms = millis();
+}
+
+WiFiClass WiFi;
@@ -0,0 +1,55 @@
+/**
+ * @file WiFi.h
+ * @brief Host stand-in for WiFiS3. The association and the NTP time are set by the test.
+ */
+
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <Arduino.h>
+
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+class IPAddress : public Printable
+{
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+    size_t printTo(Print &out) const override;
+};
+
+class WiFiClient : public Client
+{
+public:
+    int connect(const char *host, uint16_t port) override { return 1; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int read(uint8_t *buffer, size_t size) override { return -1; }
+    int peek() override { return -1; }
+    uint8_t connected() override { return 1; }
+};
+
+class WiFiClass
+{
+public:
+    int begin(const char *ssid, const char *password);
+    int disconnect();
+    int status();
+    IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+    IPAddress gatewayIP() { return IPAddress(192, 168, 1, 1); }
+    IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+    IPAddress dnsIP() { return IPAddress(192, 168, 1, 1); }
+    long RSSI() { return -55; }
+    const char *SSID();
+    unsigned long getTime();
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
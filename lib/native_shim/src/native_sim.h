@@ -0,0 +1,178 @@
+/**
+ * @file native_sim.h
+ * @brief Controls of the simulated board the native environment runs the firmware on.
+ *
+ * The shim in this library stands in for the Arduino core and the device libraries on the host.
+ * millis() and micros() follow the host clock plus every delay(), so a loop that idles through
+ * delay() covers a simulated day in seconds while task run times are still measured on the host.
+ * Tests use the functions below to drive inputs and inspect what the firmware sent.
+ */
+
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sim
+{
+    // --- Clock ---
+
+    /**
+     * @brief Moves the simulated clock forward without spending host time.
+     */
+    void advance_us(unsigned long us);
+
+    // --- Pins ---
+
+    typedef int (*pin_reader)(uint8_t pin);
+
+    /**
+     * @brief Drives an input pin. A falling or rising edge runs the interrupt attached to the pin.
+     */
+    void set_digital(uint8_t pin, int level);
+
+    /**
+     * @brief Returns the level of a pin, as last written by the firmware or set_digital().
+     */
+    int get_digital(uint8_t pin);
+
+    /**
+     * @brief Sets the value analogRead() returns for a pin.
+     */
+    void set_analog(uint8_t pin, int value);
+
+    /**
+     * @brief Lets a test compute digitalRead() itself, e.g. to model the multiplexer. nullptr restores
+     *        the pin levels.
+     */
+    void set_digital_reader(pin_reader reader);
+
+    // --- Serial ---
+
+    /**
+     * @brief Enables or silences the copy of Serial output on stdout.
+     */
+    void set_serial_echo(bool echo);
+
+    // --- EEPROM ---
+
+    /**
+     * @brief Erases the EEPROM to 0xFF and clears the write counter and any pending failure.
+     */
+    void eeprom_erase();
+
+    /**
+     * @brief Simulates a power cut: every byte write after the next `writes` is dropped. -1 disarms.
+     */
+    void eeprom_fail_after(long writes);
+
+    /**
+     * @brief Returns true once a write was dropped by eeprom_fail_after().
+     */
+    bool eeprom_failed();
+
+    /**
+     * @brief Returns the number of byte writes that reached the EEPROM.
+     */
+    uint32_t eeprom_writes();
+
+    // --- WiFi ---
+
+    void set_wifi(bool connected);
+
+    /**
+     * @brief Sets the Unix time WiFi.getTime() returns; 0 means NTP has not answered yet.
+     */
+    void set_network_time(unsigned long epoch);
+
+    // --- Sensors ---
+
+    /**
+     * @brief Sets the reading of every DHT22. NAN simulates a failed read.
+     */
+    void set_climate(float temperature, float humidity);
+
+    // --- RFID (MFRC522 register model behind SPI) ---
+
+    /**
+     * @brief Places a card in the reader's field. It answers REQA until it is halted.
+     */
+    void present_card(const uint8_t *uid, uint8_t size);
+
+    /**
+     * @brief Takes the card out of the field.
+     */
+    void remove_card();
+
+    /**
+     * @brief Wires the MFRC522 IRQ output to a pin. The line is active low, as configured by the firmware.
+     */
+    void set_rfid_irq_pin(int pin);
+
+    /**
+     * @brief Returns the number of SPI transfers made to the reader.
+     */
+    uint32_t spi_transfers();
+
+    // --- MQTT broker ---
+
+    /**
+     * @brief Publish statistics of one topic.
+     */
+    struct topic_stats
+    {
+        char topic[64];
+        uint32_t messages;
+        uint32_t bytes;
+        uint8_t last_payload[512];
+        size_t last_length;
+    };
+
+    /**
+     * @brief Forgets published messages, subscriptions and queued inbound messages.
+     */
+    void broker_reset();
+
+    /**
+     * @brief Lets MqttClient::connect() succeed or fail.
+     */
+    void set_broker(bool online);
+
+    /**
+     * @brief Closes every open client session, as a broker restart would. Clients reconnect on their
+     *        next update.
+     */
+    void drop_sessions();
+
+    /**
+     * @brief Queues an inbound message; it is delivered on the client's next poll().
+     * @param bytes_per_ms Network speed. 0 delivers the whole payload at once; otherwise available()
+     *        grows as the simulated clock advances.
+     * @return false if the inbound queue is full or the message is too long
+     */
+    bool inject_message(const char *topic, const uint8_t *payload, size_t length, uint32_t bytes_per_ms = 0);
+
+    uint32_t published_messages();
+    uint32_t published_bytes();
+
+    /**
+     * @brief Returns the statistics of a topic, or nullptr if nothing was published on it.
+     */
+    const topic_stats *find_topic(const char *topic);
+
+    /**
+     * @brief Returns the number of subscribe() calls, and the topic of each.
+     */
+    uint8_t subscriptions();
+    const char *subscription(uint8_t index);
+
+    // --- Serial link to the relay board ---
+
+    /**
+     * @brief Returns the number of packets sent through SerialTransfer.
+     */
+    uint32_t serial_packets();
+}
+
+#endif // NATIVE_SIM_H
@@ -21,6 +21,21 @@ PB_BIND(transporter_RegisterResponse, transporter_RegisterResponse, AUTO)
 PB_BIND(transporter_RevokeRequest, transporter_RevokeRequest, AUTO)
 
 
+PB_BIND(transporter_AccessWindow, transporter_AccessWindow, AUTO)
+
+
+PB_BIND(transporter_WhitelistEntry, transporter_WhitelistEntry, AUTO)
+
+
+PB_BIND(transporter_WhitelistSnapshot, transporter_WhitelistSnapshot, AUTO)
+
+
+PB_BIND(transporter_WhitelistDelta, transporter_WhitelistDelta, AUTO)
+
+
+PB_BIND(transporter_WhitelistStatus, transporter_WhitelistStatus, AUTO)
+
+
 PB_BIND(transporter_RfidEnvelope, transporter_RfidEnvelope, AUTO)
 
 
@@ -33,6 +48,9 @@ PB_BIND(transporter_LDR, transporter_LDR, AUTO)
 PB_BIND(transporter_Motion, transporter_Motion, AUTO)
 
 
+PB_BIND(transporter_Rule, transporter_Rule, AUTO)
+
+
 PB_BIND(transporter_FullConfig, transporter_FullConfig, AUTO)
 
 
@@ -48,6 +66,9 @@ PB_BIND(transporter_LDRRemoval, transporter_LDRRemoval, AUTO)
 PB_BIND(transporter_MotionRemoval, transporter_MotionRemoval, AUTO)
 
 
+PB_BIND(transporter_RuleRemoval, transporter_RuleRemoval, AUTO)
+
+
 PB_BIND(transporter_ConfigRemoval, transporter_ConfigRemoval, AUTO)
 
 
@@ -63,8 +84,28 @@ PB_BIND(transporter_ClimateData, transporter_ClimateData, AUTO)
 PB_BIND(transporter_LDRData, transporter_LDRData, AUTO)
 
 
+PB_BIND(transporter_ClimateSample, transporter_ClimateSample, AUTO)
+
+
+PB_BIND(transporter_LDRSample, transporter_LDRSample, AUTO)
+
+
+PB_BIND(transporter_MotionSample, transporter_MotionSample, AUTO)
+
+
+PB_BIND(transporter_TelemetryBatch, transporter_TelemetryBatch, AUTO)
+
+
+PB_BIND(transporter_RuleEvent, transporter_RuleEvent, AUTO)
+
+
+PB_BIND(transporter_LatencyHistogram, transporter_LatencyHistogram, AUTO)
+
 
+PB_BIND(transporter_AuthMetrics, transporter_AuthMetrics, AUTO)
 
 
+PB_BIND(transporter_AccessEvent, transporter_AccessEvent, AUTO)
 
 
+PB_BIND(transporter_AccessLog, transporter_AccessLog, AUTO)
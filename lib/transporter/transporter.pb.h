@@ -21,6 +21,40 @@ typedef enum _transporter_RelayStateType {
     transporter_RelayStateType_ON = 1
 } transporter_RelayStateType;
 
+typedef enum _transporter_RuleSensor {
+    transporter_RuleSensor_TEMPERATURE = 0,
+    transporter_RuleSensor_HUMIDITY = 1,
+    transporter_RuleSensor_AQI = 2,
+    transporter_RuleSensor_LIGHT = 3
+} transporter_RuleSensor;
+
+typedef enum _transporter_RuleComparator {
+    transporter_RuleComparator_ABOVE = 0,
+    transporter_RuleComparator_BELOW = 1
+} transporter_RuleComparator;
+
+typedef enum _transporter_RuleAction {
+    transporter_RuleAction_BUZZER = 0,
+    transporter_RuleAction_RELAY = 1,
+    transporter_RuleAction_PUBLISH = 2
+} transporter_RuleAction;
+
+typedef enum _transporter_AuthStage {
+    transporter_AuthStage_CARD_DETECT = 0,
+    transporter_AuthStage_CARD_READ = 1,
+    transporter_AuthStage_WHITELIST_LOOKUP = 2,
+    transporter_AuthStage_LOCK_COMMAND = 3,
+    transporter_AuthStage_CARD_TO_UNLOCK = 4
+} transporter_AuthStage;
+
+typedef enum _transporter_AccessReason {
+    transporter_AccessReason_LISTED = 0,
+    transporter_AccessReason_NOT_LISTED = 1,
+    transporter_AccessReason_OUTSIDE_WINDOW = 2,
+    transporter_AccessReason_CLOCK_UNSYNCED = 3,
+    transporter_AccessReason_REGISTRATION = 4
+} transporter_AccessReason;
+
 /* Struct definitions */
 typedef struct _transporter_WifiCredentials {
     pb_callback_t ssid;
@@ -46,6 +80,37 @@ typedef struct _transporter_RevokeRequest {
     transporter_UID uid;
 } transporter_RevokeRequest;
 
+typedef struct _transporter_AccessWindow {
+    uint32_t start;
+    uint32_t end;
+    uint32_t weekdays;
+    uint32_t hours;
+} transporter_AccessWindow;
+
+typedef struct _transporter_WhitelistEntry {
+    pb_callback_t uid;
+    bool has_window;
+    transporter_AccessWindow window;
+} transporter_WhitelistEntry;
+
+typedef struct _transporter_WhitelistSnapshot {
+    uint32_t version;
+    pb_callback_t entries;
+} transporter_WhitelistSnapshot;
+
+typedef struct _transporter_WhitelistDelta {
+    uint32_t base_version;
+    uint32_t version;
+    pb_callback_t added;
+    pb_callback_t removed;
+} transporter_WhitelistDelta;
+
+typedef struct _transporter_WhitelistStatus {
+    uint32_t version;
+    uint32_t hash;
+    uint32_t count;
+} transporter_WhitelistStatus;
+
 typedef struct _transporter_RfidEnvelope {
     pb_callback_t cb_payload;
     pb_size_t which_payload;
@@ -53,6 +118,9 @@ typedef struct _transporter_RfidEnvelope {
         transporter_RegisterRequest register_request;
         transporter_RegisterResponse register_response;
         transporter_RevokeRequest revoke_request;
+        transporter_WhitelistSnapshot whitelist_snapshot;
+        transporter_WhitelistDelta whitelist_delta;
+        transporter_WhitelistStatus whitelist_status;
     } payload;
 } transporter_RfidEnvelope;
 
@@ -62,11 +130,19 @@ typedef struct _transporter_Climate {
     uint32_t aqi_port;
     bool has_buzzers;
     uint32_t buzzer_port;
+    uint32_t temperature_deadband;
+    uint32_t humidity_deadband;
+    uint32_t aqi_deadband;
+    bool relative_deadband;
+    uint32_t max_silent_s;
 } transporter_Climate;
 
 typedef struct _transporter_LDR {
     uint32_t id;
     uint32_t port;
+    uint32_t deadband;
+    bool relative_deadband;
+    uint32_t max_silent_s;
 } transporter_LDR;
 
 typedef struct _transporter_Motion {
@@ -74,24 +150,39 @@ typedef struct _transporter_Motion {
     uint32_t port;
     uint32_t relay_port;
     transporter_RelayType relay_type;
+    uint32_t debounce_ms;
+    uint32_t hold_s;
+    uint32_t heartbeat_s;
+    bool local_automation;
 } transporter_Motion;
 
+typedef struct _transporter_Rule {
+    uint32_t id;
+    transporter_RuleSensor sensor;
+    uint32_t sensor_id;
+    transporter_RuleComparator comparator;
+    float threshold;
+    float hysteresis;
+    transporter_RuleAction action;
+    uint32_t port;
+    transporter_RelayType relay_type;
+} transporter_Rule;
+
 typedef struct _transporter_FullConfig {
-    pb_size_t climates_count;
-    transporter_Climate climates[2];
-    pb_size_t ldrs_count;
-    transporter_LDR ldrs[2];
-    pb_size_t motions_count;
-    transporter_Motion motions[4];
+    pb_callback_t climates;
+    pb_callback_t ldrs;
+    pb_callback_t motions;
 } transporter_FullConfig;
 
 typedef struct _transporter_ConfigTopic {
+    pb_callback_t cb_payload;
     pb_size_t which_payload;
     union {
         transporter_Climate climate;
         transporter_LDR ldr;
         transporter_Motion motion;
         transporter_FullConfig full_config;
+        transporter_Rule rule;
     } payload;
 } transporter_ConfigTopic;
 
@@ -107,12 +198,17 @@ typedef struct _transporter_MotionRemoval {
     uint32_t id;
 } transporter_MotionRemoval;
 
+typedef struct _transporter_RuleRemoval {
+    uint32_t id;
+} transporter_RuleRemoval;
+
 typedef struct _transporter_ConfigRemoval {
     pb_size_t which_payload;
     union {
         transporter_ClimateRemoval climate;
         transporter_LDRRemoval ldr;
         transporter_MotionRemoval motion;
+        transporter_RuleRemoval rule;
     } payload;
 } transporter_ConfigRemoval;
 
@@ -138,6 +234,73 @@ typedef struct _transporter_LDRData {
     uint32_t value;
 } transporter_LDRData;
 
+typedef struct _transporter_ClimateSample {
+    uint32_t id;
+    float temperature;
+    float humidity;
+    uint32_t aqi;
+    uint32_t offset_ms;
+} transporter_ClimateSample;
+
+typedef struct _transporter_LDRSample {
+    uint32_t id;
+    uint32_t value;
+    uint32_t offset_ms;
+} transporter_LDRSample;
+
+typedef struct _transporter_MotionSample {
+    uint32_t id;
+    bool detected;
+    uint32_t offset_ms;
+} transporter_MotionSample;
+
+typedef struct _transporter_TelemetryBatch {
+    uint32_t window_start_ms;
+    pb_size_t climates_count;
+    transporter_ClimateSample climates[2];
+    pb_size_t ldrs_count;
+    transporter_LDRSample ldrs[2];
+    pb_size_t motions_count;
+    transporter_MotionSample motions[8];
+} transporter_TelemetryBatch;
+
+typedef struct _transporter_RuleEvent {
+    uint32_t rule_id;
+    bool active;
+    float value;
+} transporter_RuleEvent;
+
+typedef struct _transporter_LatencyHistogram {
+    transporter_AuthStage stage;
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+    pb_size_t buckets_count;
+    uint32_t buckets[12];
+} transporter_LatencyHistogram;
+
+typedef struct _transporter_AuthMetrics {
+    uint32_t window_ms;
+    uint32_t decisions;
+    uint32_t granted;
+    pb_size_t stages_count;
+    transporter_LatencyHistogram stages[2];
+} transporter_AuthMetrics;
+
+typedef struct _transporter_AccessEvent {
+    uint32_t seq;
+    uint32_t uid_digest;
+    bool granted;
+    transporter_AccessReason reason;
+    uint32_t timestamp;
+} transporter_AccessEvent;
+
+typedef struct _transporter_AccessLog {
+    pb_size_t events_count;
+    transporter_AccessEvent events[8];
+    uint32_t lost;
+} transporter_AccessLog;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -152,6 +315,26 @@ extern "C" {
 #define _transporter_RelayStateType_MAX transporter_RelayStateType_ON
 #define _transporter_RelayStateType_ARRAYSIZE ((transporter_RelayStateType)(transporter_RelayStateType_ON+1))
 
+#define _transporter_RuleSensor_MIN transporter_RuleSensor_TEMPERATURE
+#define _transporter_RuleSensor_MAX transporter_RuleSensor_LIGHT
+#define _transporter_RuleSensor_ARRAYSIZE ((transporter_RuleSensor)(transporter_RuleSensor_LIGHT+1))
+
+#define _transporter_RuleComparator_MIN transporter_RuleComparator_ABOVE
+#define _transporter_RuleComparator_MAX transporter_RuleComparator_BELOW
+#define _transporter_RuleComparator_ARRAYSIZE ((transporter_RuleComparator)(transporter_RuleComparator_BELOW+1))
+
+#define _transporter_RuleAction_MIN transporter_RuleAction_BUZZER
+#define _transporter_RuleAction_MAX transporter_RuleAction_PUBLISH
+#define _transporter_RuleAction_ARRAYSIZE ((transporter_RuleAction)(transporter_RuleAction_PUBLISH+1))
+
+#define _transporter_AuthStage_MIN transporter_AuthStage_CARD_DETECT
+#define _transporter_AuthStage_MAX transporter_AuthStage_CARD_TO_UNLOCK
+#define _transporter_AuthStage_ARRAYSIZE ((transporter_AuthStage)(transporter_AuthStage_CARD_TO_UNLOCK+1))
+
+#define _transporter_AccessReason_MIN transporter_AccessReason_LISTED
+#define _transporter_AccessReason_MAX transporter_AccessReason_REGISTRATION
+#define _transporter_AccessReason_ARRAYSIZE ((transporter_AccessReason)(transporter_AccessReason_REGISTRATION+1))
+
 
 
 
@@ -162,6 +345,11 @@ extern "C" {
 
 #define transporter_Motion_relay_type_ENUMTYPE transporter_RelayType
 
+#define transporter_Rule_sensor_ENUMTYPE transporter_RuleSensor
+#define transporter_Rule_comparator_ENUMTYPE transporter_RuleComparator
+#define transporter_Rule_action_ENUMTYPE transporter_RuleAction
+#define transporter_Rule_relay_type_ENUMTYPE transporter_RelayType
+
 
 
 
@@ -175,45 +363,88 @@ extern "C" {
 
 
 
+
+
+
+
+#define transporter_LatencyHistogram_stage_ENUMTYPE transporter_AuthStage
+
+
+#define transporter_AccessEvent_reason_ENUMTYPE transporter_AccessReason
+
+
+
 /* Initializer values for message structs */
 #define transporter_WifiCredentials_init_default {{{NULL}, NULL}, {{NULL}, NULL}}
 #define transporter_UID_init_default             {{{NULL}, NULL}}
 #define transporter_RegisterRequest_init_default {{{NULL}, NULL}}
 #define transporter_RegisterResponse_init_default {{{NULL}, NULL}, false, transporter_UID_init_default}
 #define transporter_RevokeRequest_init_default   {false, transporter_UID_init_default}
+#define transporter_AccessWindow_init_default    {0, 0, 0, 0}
+#define transporter_WhitelistEntry_init_default  {{{NULL}, NULL}, false, transporter_AccessWindow_init_default}
+#define transporter_WhitelistSnapshot_init_default {0, {{NULL}, NULL}}
+#define transporter_WhitelistDelta_init_default  {0, 0, {{NULL}, NULL}, {{NULL}, NULL}}
+#define transporter_WhitelistStatus_init_default {0, 0, 0}
 #define transporter_RfidEnvelope_init_default    {{{NULL}, NULL}, 0, {transporter_RegisterRequest_init_default}}
-#define transporter_Climate_init_default         {0, 0, 0, 0, 0}
-#define transporter_LDR_init_default             {0, 0}
-#define transporter_Motion_init_default          {0, 0, 0, _transporter_RelayType_MIN}
-#define transporter_FullConfig_init_default      {0, {transporter_Climate_init_default, transporter_Climate_init_default}, 0, {transporter_LDR_init_default, transporter_LDR_init_default}, 0, {transporter_Motion_init_default, transporter_Motion_init_default, transporter_Motion_init_default, transporter_Motion_init_default}}
-#define transporter_ConfigTopic_init_default     {0, {transporter_Climate_init_default}}
+#define transporter_Climate_init_default         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
+#define transporter_LDR_init_default             {0, 0, 0, 0, 0}
+#define transporter_Motion_init_default          {0, 0, 0, _transporter_RelayType_MIN, 0, 0, 0, 0}
+#define transporter_Rule_init_default            {0, _transporter_RuleSensor_MIN, 0, _transporter_RuleComparator_MIN, 0, 0, _transporter_RuleAction_MIN, 0, _transporter_RelayType_MIN}
+#define transporter_FullConfig_init_default      {{{NULL}, NULL}, {{NULL}, NULL}, {{NULL}, NULL}}
+#define transporter_ConfigTopic_init_default     {{{NULL}, NULL}, 0, {transporter_Climate_init_default}}
 #define transporter_ClimateRemoval_init_default  {0}
 #define transporter_LDRRemoval_init_default      {0}
 #define transporter_MotionRemoval_init_default   {0}
+#define transporter_RuleRemoval_init_default     {0}
 #define transporter_ConfigRemoval_init_default   {0, {transporter_ClimateRemoval_init_default}}
 #define transporter_RelayState_init_default      {_transporter_RelayType_MIN, 0, _transporter_RelayStateType_MIN}
 #define transporter_RelayStateSync_init_default  {0}
 #define transporter_ClimateData_init_default     {0, 0, 0, 0}
 #define transporter_LDRData_init_default         {0, 0}
+#define transporter_ClimateSample_init_default   {0, 0, 0, 0, 0}
+#define transporter_LDRSample_init_default       {0, 0, 0}
+#define transporter_MotionSample_init_default    {0, 0, 0}
+#define transporter_TelemetryBatch_init_default  {0, 0, {transporter_ClimateSample_init_default, transporter_ClimateSample_init_default}, 0, {transporter_LDRSample_init_default, transporter_LDRSample_init_default}, 0, {transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default, transporter_MotionSample_init_default}}
+#define transporter_RuleEvent_init_default       {0, 0, 0}
+#define transporter_LatencyHistogram_init_default {_transporter_AuthStage_MIN, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define transporter_AuthMetrics_init_default     {0, 0, 0, 0, {transporter_LatencyHistogram_init_default, transporter_LatencyHistogram_init_default}}
+#define transporter_AccessEvent_init_default     {0, 0, 0, _transporter_AccessReason_MIN, 0}
+#define transporter_AccessLog_init_default       {0, {transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default, transporter_AccessEvent_init_default}, 0}
 #define transporter_WifiCredentials_init_zero    {{{NULL}, NULL}, {{NULL}, NULL}}
 #define transporter_UID_init_zero                {{{NULL}, NULL}}
 #define transporter_RegisterRequest_init_zero    {{{NULL}, NULL}}
 #define transporter_RegisterResponse_init_zero   {{{NULL}, NULL}, false, transporter_UID_init_zero}
 #define transporter_RevokeRequest_init_zero      {false, transporter_UID_init_zero}
+#define transporter_AccessWindow_init_zero       {0, 0, 0, 0}
+#define transporter_WhitelistEntry_init_zero     {{{NULL}, NULL}, false, transporter_AccessWindow_init_zero}
+#define transporter_WhitelistSnapshot_init_zero  {0, {{NULL}, NULL}}
+#define transporter_WhitelistDelta_init_zero     {0, 0, {{NULL}, NULL}, {{NULL}, NULL}}
+#define transporter_WhitelistStatus_init_zero    {0, 0, 0}
 #define transporter_RfidEnvelope_init_zero       {{{NULL}, NULL}, 0, {transporter_RegisterRequest_init_zero}}
-#define transporter_Climate_init_zero            {0, 0, 0, 0, 0}
-#define transporter_LDR_init_zero                {0, 0}
-#define transporter_Motion_init_zero             {0, 0, 0, _transporter_RelayType_MIN}
-#define transporter_FullConfig_init_zero         {0, {transporter_Climate_init_zero, transporter_Climate_init_zero}, 0, {transporter_LDR_init_zero, transporter_LDR_init_zero}, 0, {transporter_Motion_init_zero, transporter_Motion_init_zero, transporter_Motion_init_zero, transporter_Motion_init_zero}}
-#define transporter_ConfigTopic_init_zero        {0, {transporter_Climate_init_zero}}
+#define transporter_Climate_init_zero            {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
+#define transporter_LDR_init_zero                {0, 0, 0, 0, 0}
+#define transporter_Motion_init_zero             {0, 0, 0, _transporter_RelayType_MIN, 0, 0, 0, 0}
+#define transporter_Rule_init_zero               {0, _transporter_RuleSensor_MIN, 0, _transporter_RuleComparator_MIN, 0, 0, _transporter_RuleAction_MIN, 0, _transporter_RelayType_MIN}
+#define transporter_FullConfig_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}, {{NULL}, NULL}}
+#define transporter_ConfigTopic_init_zero        {{{NULL}, NULL}, 0, {transporter_Climate_init_zero}}
 #define transporter_ClimateRemoval_init_zero     {0}
 #define transporter_LDRRemoval_init_zero         {0}
 #define transporter_MotionRemoval_init_zero      {0}
+#define transporter_RuleRemoval_init_zero        {0}
 #define transporter_ConfigRemoval_init_zero      {0, {transporter_ClimateRemoval_init_zero}}
 #define transporter_RelayState_init_zero         {_transporter_RelayType_MIN, 0, _transporter_RelayStateType_MIN}
 #define transporter_RelayStateSync_init_zero     {0}
 #define transporter_ClimateData_init_zero        {0, 0, 0, 0}
 #define transporter_LDRData_init_zero            {0, 0}
+#define transporter_ClimateSample_init_zero      {0, 0, 0, 0, 0}
+#define transporter_LDRSample_init_zero          {0, 0, 0}
+#define transporter_MotionSample_init_zero       {0, 0, 0}
+#define transporter_TelemetryBatch_init_zero     {0, 0, {transporter_ClimateSample_init_zero, transporter_ClimateSample_init_zero}, 0, {transporter_LDRSample_init_zero, transporter_LDRSample_init_zero}, 0, {transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero, transporter_MotionSample_init_zero}}
+#define transporter_RuleEvent_init_zero          {0, 0, 0}
+#define transporter_LatencyHistogram_init_zero   {_transporter_AuthStage_MIN, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define transporter_AuthMetrics_init_zero        {0, 0, 0, 0, {transporter_LatencyHistogram_init_zero, transporter_LatencyHistogram_init_zero}}
+#define transporter_AccessEvent_init_zero        {0, 0, 0, _transporter_AccessReason_MIN, 0}
+#define transporter_AccessLog_init_zero          {0, {transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero, transporter_AccessEvent_init_zero}, 0}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define transporter_WifiCredentials_ssid_tag     1
@@ -223,20 +454,59 @@ extern "C" {
 #define transporter_RegisterResponse_id_tag      1
 #define transporter_RegisterResponse_uid_tag     2
 #define transporter_RevokeRequest_uid_tag        1
+#define transporter_AccessWindow_start_tag       1
+#define transporter_AccessWindow_end_tag         2
+#define transporter_AccessWindow_weekdays_tag    3
+#define transporter_AccessWindow_hours_tag       4
+#define transporter_WhitelistEntry_uid_tag       1
+#define transporter_WhitelistEntry_window_tag    2
+#define transporter_WhitelistSnapshot_version_tag 1
+#define transporter_WhitelistSnapshot_entries_tag 2
+#define transporter_WhitelistDelta_base_version_tag 1
+#define transporter_WhitelistDelta_version_tag   2
+#define transporter_WhitelistDelta_added_tag     3
+#define transporter_WhitelistDelta_removed_tag   4
+#define transporter_WhitelistStatus_version_tag  1
+#define transporter_WhitelistStatus_hash_tag     2
+#define transporter_WhitelistStatus_count_tag    3
 #define transporter_RfidEnvelope_register_request_tag 3
 #define transporter_RfidEnvelope_register_response_tag 4
 #define transporter_RfidEnvelope_revoke_request_tag 5
+#define transporter_RfidEnvelope_whitelist_snapshot_tag 6
+#define transporter_RfidEnvelope_whitelist_delta_tag 7
+#define transporter_RfidEnvelope_whitelist_status_tag 8
 #define transporter_Climate_id_tag               1
 #define transporter_Climate_dht22_port_tag       2
 #define transporter_Climate_aqi_port_tag         3
 #define transporter_Climate_has_buzzers_tag      4
 #define transporter_Climate_buzzer_port_tag      5
+#define transporter_Climate_temperature_deadband_tag 6
+#define transporter_Climate_humidity_deadband_tag 7
+#define transporter_Climate_aqi_deadband_tag     8
+#define transporter_Climate_relative_deadband_tag 9
+#define transporter_Climate_max_silent_s_tag     10
 #define transporter_LDR_id_tag                   1
 #define transporter_LDR_port_tag                 2
+#define transporter_LDR_deadband_tag             3
+#define transporter_LDR_relative_deadband_tag    4
+#define transporter_LDR_max_silent_s_tag         5
 #define transporter_Motion_id_tag                1
 #define transporter_Motion_port_tag              2
 #define transporter_Motion_relay_port_tag        3
 #define transporter_Motion_relay_type_tag        4
+#define transporter_Motion_debounce_ms_tag       5
+#define transporter_Motion_hold_s_tag            6
+#define transporter_Motion_heartbeat_s_tag       7
+#define transporter_Motion_local_automation_tag  8
+#define transporter_Rule_id_tag                  1
+#define transporter_Rule_sensor_tag              2
+#define transporter_Rule_sensor_id_tag           3
+#define transporter_Rule_comparator_tag          4
+#define transporter_Rule_threshold_tag           5
+#define transporter_Rule_hysteresis_tag          6
+#define transporter_Rule_action_tag              7
+#define transporter_Rule_port_tag                8
+#define transporter_Rule_relay_type_tag          9
 #define transporter_FullConfig_climates_tag      1
 #define transporter_FullConfig_ldrs_tag          2
 #define transporter_FullConfig_motions_tag       3
@@ -244,12 +514,15 @@ extern "C" {
 #define transporter_ConfigTopic_ldr_tag          3
 #define transporter_ConfigTopic_motion_tag       4
 #define transporter_ConfigTopic_full_config_tag  6
+#define transporter_ConfigTopic_rule_tag         7
 #define transporter_ClimateRemoval_id_tag        1
 #define transporter_LDRRemoval_id_tag            1
 #define transporter_MotionRemoval_id_tag         1
+#define transporter_RuleRemoval_id_tag           1
 #define transporter_ConfigRemoval_climate_tag    2
 #define transporter_ConfigRemoval_ldr_tag        3
 #define transporter_ConfigRemoval_motion_tag     4
+#define transporter_ConfigRemoval_rule_tag       5
 #define transporter_RelayState_type_tag          1
 #define transporter_RelayState_port_tag          2
 #define transporter_RelayState_state_tag         3
@@ -259,6 +532,40 @@ extern "C" {
 #define transporter_ClimateData_aqi_tag          4
 #define transporter_LDRData_id_tag               1
 #define transporter_LDRData_value_tag            2
+#define transporter_ClimateSample_id_tag         1
+#define transporter_ClimateSample_temperature_tag 2
+#define transporter_ClimateSample_humidity_tag   3
+#define transporter_ClimateSample_aqi_tag        4
+#define transporter_ClimateSample_offset_ms_tag  5
+#define transporter_LDRSample_id_tag             1
+#define transporter_LDRSample_value_tag          2
+#define transporter_LDRSample_offset_ms_tag      3
+#define transporter_MotionSample_id_tag          1
+#define transporter_MotionSample_detected_tag    2
+#define transporter_MotionSample_offset_ms_tag   3
+#define transporter_TelemetryBatch_window_start_ms_tag 1
+#define transporter_TelemetryBatch_climates_tag  2
+#define transporter_TelemetryBatch_ldrs_tag      3
+#define transporter_TelemetryBatch_motions_tag   4
+#define transporter_RuleEvent_rule_id_tag        1
+#define transporter_RuleEvent_active_tag         2
+#define transporter_RuleEvent_value_tag          3
+#define transporter_LatencyHistogram_stage_tag   1
+#define transporter_LatencyHistogram_count_tag   2
+#define transporter_LatencyHistogram_total_us_tag 3
+#define transporter_LatencyHistogram_max_us_tag  4
+#define transporter_LatencyHistogram_buckets_tag 5
+#define transporter_AuthMetrics_window_ms_tag    1
+#define transporter_AuthMetrics_decisions_tag    2
+#define transporter_AuthMetrics_granted_tag      3
+#define transporter_AuthMetrics_stages_tag       4
+#define transporter_AccessEvent_seq_tag          1
+#define transporter_AccessEvent_uid_digest_tag   2
+#define transporter_AccessEvent_granted_tag      3
+#define transporter_AccessEvent_reason_tag       4
+#define transporter_AccessEvent_timestamp_tag    5
+#define transporter_AccessLog_events_tag         1
+#define transporter_AccessLog_lost_tag           2
 
 /* Struct field encoding specification for nanopb */
 #define transporter_WifiCredentials_FIELDLIST(X, a) \
@@ -290,28 +597,81 @@ X(a, STATIC,   OPTIONAL, MESSAGE,  uid,               1)
 #define transporter_RevokeRequest_DEFAULT NULL
 #define transporter_RevokeRequest_uid_MSGTYPE transporter_UID
 
+#define transporter_AccessWindow_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   start,             1) \
+X(a, STATIC,   SINGULAR, UINT32,   end,               2) \
+X(a, STATIC,   SINGULAR, UINT32,   weekdays,          3) \
+X(a, STATIC,   SINGULAR, UINT32,   hours,             4)
+#define transporter_AccessWindow_CALLBACK NULL
+#define transporter_AccessWindow_DEFAULT NULL
+
+#define transporter_WhitelistEntry_FIELDLIST(X, a) \
+X(a, CALLBACK, SINGULAR, BYTES,    uid,               1) \
+X(a, STATIC,   OPTIONAL, MESSAGE,  window,            2)
+#define transporter_WhitelistEntry_CALLBACK pb_default_field_callback
+#define transporter_WhitelistEntry_DEFAULT NULL
+#define transporter_WhitelistEntry_window_MSGTYPE transporter_AccessWindow
+
+#define transporter_WhitelistSnapshot_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   version,           1) \
+X(a, CALLBACK, REPEATED, MESSAGE,  entries,           2)
+#define transporter_WhitelistSnapshot_CALLBACK pb_default_field_callback
+#define transporter_WhitelistSnapshot_DEFAULT NULL
+#define transporter_WhitelistSnapshot_entries_MSGTYPE transporter_WhitelistEntry
+
+#define transporter_WhitelistDelta_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   base_version,      1) \
+X(a, STATIC,   SINGULAR, UINT32,   version,           2) \
+X(a, CALLBACK, REPEATED, MESSAGE,  added,             3) \
+X(a, CALLBACK, REPEATED, MESSAGE,  removed,           4)
+#define transporter_WhitelistDelta_CALLBACK pb_default_field_callback
+#define transporter_WhitelistDelta_DEFAULT NULL
+#define transporter_WhitelistDelta_added_MSGTYPE transporter_WhitelistEntry
+#define transporter_WhitelistDelta_removed_MSGTYPE transporter_UID
+
+#define transporter_WhitelistStatus_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   version,           1) \
+X(a, STATIC,   SINGULAR, UINT32,   hash,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   count,             3)
+#define transporter_WhitelistStatus_CALLBACK NULL
+#define transporter_WhitelistStatus_DEFAULT NULL
+
 #define transporter_RfidEnvelope_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,register_request,payload.register_request),   3) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,register_response,payload.register_response),   4) \
-X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,revoke_request,payload.revoke_request),   5)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,revoke_request,payload.revoke_request),   5) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,whitelist_snapshot,payload.whitelist_snapshot),   6) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,whitelist_delta,payload.whitelist_delta),   7) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,whitelist_status,payload.whitelist_status),   8)
 #define transporter_RfidEnvelope_CALLBACK NULL
 #define transporter_RfidEnvelope_DEFAULT NULL
 #define transporter_RfidEnvelope_payload_register_request_MSGTYPE transporter_RegisterRequest
 #define transporter_RfidEnvelope_payload_register_response_MSGTYPE transporter_RegisterResponse
 #define transporter_RfidEnvelope_payload_revoke_request_MSGTYPE transporter_RevokeRequest
+#define transporter_RfidEnvelope_payload_whitelist_snapshot_MSGTYPE transporter_WhitelistSnapshot
+#define transporter_RfidEnvelope_payload_whitelist_delta_MSGTYPE transporter_WhitelistDelta
+#define transporter_RfidEnvelope_payload_whitelist_status_MSGTYPE transporter_WhitelistStatus
 
 #define transporter_Climate_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
 X(a, STATIC,   SINGULAR, UINT32,   dht22_port,        2) \
 X(a, STATIC,   SINGULAR, UINT32,   aqi_port,          3) \
 X(a, STATIC,   SINGULAR, BOOL,     has_buzzers,       4) \
-X(a, STATIC,   SINGULAR, UINT32,   buzzer_port,       5)
+X(a, STATIC,   SINGULAR, UINT32,   buzzer_port,       5) \
+X(a, STATIC,   SINGULAR, UINT32,   temperature_deadband,   6) \
+X(a, STATIC,   SINGULAR, UINT32,   humidity_deadband,   7) \
+X(a, STATIC,   SINGULAR, UINT32,   aqi_deadband,       8) \
+X(a, STATIC,   SINGULAR, BOOL,     relative_deadband,   9) \
+X(a, STATIC,   SINGULAR, UINT32,   max_silent_s,      10)
 #define transporter_Climate_CALLBACK NULL
 #define transporter_Climate_DEFAULT NULL
 
 #define transporter_LDR_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
-X(a, STATIC,   SINGULAR, UINT32,   port,              2)
+X(a, STATIC,   SINGULAR, UINT32,   port,              2) \
+X(a, STATIC,   SINGULAR, UINT32,   deadband,           3) \
+X(a, STATIC,   SINGULAR, BOOL,     relative_deadband,   4) \
+X(a, STATIC,   SINGULAR, UINT32,   max_silent_s,       5)
 #define transporter_LDR_CALLBACK NULL
 #define transporter_LDR_DEFAULT NULL
 
@@ -319,31 +679,50 @@ X(a, STATIC,   SINGULAR, UINT32,   port,              2)
 X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
 X(a, STATIC,   SINGULAR, UINT32,   port,              2) \
 X(a, STATIC,   SINGULAR, UINT32,   relay_port,        3) \
-X(a, STATIC,   SINGULAR, UENUM,    relay_type,        4)
+X(a, STATIC,   SINGULAR, UENUM,    relay_type,        4) \
+X(a, STATIC,   SINGULAR, UINT32,   debounce_ms,       5) \
+X(a, STATIC,   SINGULAR, UINT32,   hold_s,            6) \
+X(a, STATIC,   SINGULAR, UINT32,   heartbeat_s,       7) \
+X(a, STATIC,   SINGULAR, BOOL,     local_automation,   8)
 #define transporter_Motion_CALLBACK NULL
 #define transporter_Motion_DEFAULT NULL
 
+#define transporter_Rule_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
+X(a, STATIC,   SINGULAR, UENUM,    sensor,            2) \
+X(a, STATIC,   SINGULAR, UINT32,   sensor_id,         3) \
+X(a, STATIC,   SINGULAR, UENUM,    comparator,        4) \
+X(a, STATIC,   SINGULAR, FLOAT,    threshold,         5) \
+X(a, STATIC,   SINGULAR, FLOAT,    hysteresis,        6) \
+X(a, STATIC,   SINGULAR, UENUM,    action,            7) \
+X(a, STATIC,   SINGULAR, UINT32,   port,              8) \
+X(a, STATIC,   SINGULAR, UENUM,    relay_type,        9)
+#define transporter_Rule_CALLBACK NULL
+#define transporter_Rule_DEFAULT NULL
+
 #define transporter_FullConfig_FIELDLIST(X, a) \
-X(a, STATIC,   REPEATED, MESSAGE,  climates,          1) \
-X(a, STATIC,   REPEATED, MESSAGE,  ldrs,              2) \
-X(a, STATIC,   REPEATED, MESSAGE,  motions,           3)
-#define transporter_FullConfig_CALLBACK NULL
+X(a, CALLBACK, REPEATED, MESSAGE,  climates,          1) \
+X(a, CALLBACK, REPEATED, MESSAGE,  ldrs,              2) \
+X(a, CALLBACK, REPEATED, MESSAGE,  motions,           3)
+#define transporter_FullConfig_CALLBACK pb_default_field_callback
 #define transporter_FullConfig_DEFAULT NULL
 #define transporter_FullConfig_climates_MSGTYPE transporter_Climate
 #define transporter_FullConfig_ldrs_MSGTYPE transporter_LDR
 #define transporter_FullConfig_motions_MSGTYPE transporter_Motion
 
 #define transporter_ConfigTopic_FIELDLIST(X, a) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,climate,payload.climate),   2) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,ldr,payload.ldr),   3) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,motion,payload.motion),   4) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,full_config,payload.full_config),   6)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,climate,payload.climate),   2) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,ldr,payload.ldr),   3) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,motion,payload.motion),   4) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,full_config,payload.full_config),   6) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (payload,rule,payload.rule),   7)
 #define transporter_ConfigTopic_CALLBACK NULL
 #define transporter_ConfigTopic_DEFAULT NULL
 #define transporter_ConfigTopic_payload_climate_MSGTYPE transporter_Climate
 #define transporter_ConfigTopic_payload_ldr_MSGTYPE transporter_LDR
 #define transporter_ConfigTopic_payload_motion_MSGTYPE transporter_Motion
 #define transporter_ConfigTopic_payload_full_config_MSGTYPE transporter_FullConfig
+#define transporter_ConfigTopic_payload_rule_MSGTYPE transporter_Rule
 
 #define transporter_ClimateRemoval_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   id,                1)
@@ -360,15 +739,22 @@ X(a, STATIC,   SINGULAR, UINT32,   id,                1)
 #define transporter_MotionRemoval_CALLBACK NULL
 #define transporter_MotionRemoval_DEFAULT NULL
 
+#define transporter_RuleRemoval_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   id,                1)
+#define transporter_RuleRemoval_CALLBACK NULL
+#define transporter_RuleRemoval_DEFAULT NULL
+
 #define transporter_ConfigRemoval_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,climate,payload.climate),   2) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,ldr,payload.ldr),   3) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,motion,payload.motion),   4)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,motion,payload.motion),   4) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,rule,payload.rule),   5)
 #define transporter_ConfigRemoval_CALLBACK NULL
 #define transporter_ConfigRemoval_DEFAULT NULL
 #define transporter_ConfigRemoval_payload_climate_MSGTYPE transporter_ClimateRemoval
 #define transporter_ConfigRemoval_payload_ldr_MSGTYPE transporter_LDRRemoval
 #define transporter_ConfigRemoval_payload_motion_MSGTYPE transporter_MotionRemoval
+#define transporter_ConfigRemoval_payload_rule_MSGTYPE transporter_RuleRemoval
 
 #define transporter_RelayState_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UENUM,    type,              1) \
@@ -396,25 +782,116 @@ X(a, STATIC,   SINGULAR, UINT32,   value,             2)
 #define transporter_LDRData_CALLBACK NULL
 #define transporter_LDRData_DEFAULT NULL
 
+#define transporter_ClimateSample_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
+X(a, STATIC,   SINGULAR, FLOAT,    temperature,       2) \
+X(a, STATIC,   SINGULAR, FLOAT,    humidity,          3) \
+X(a, STATIC,   SINGULAR, UINT32,   aqi,               4) \
+X(a, STATIC,   SINGULAR, UINT32,   offset_ms,         5)
+#define transporter_ClimateSample_CALLBACK NULL
+#define transporter_ClimateSample_DEFAULT NULL
+
+#define transporter_LDRSample_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
+X(a, STATIC,   SINGULAR, UINT32,   value,             2) \
+X(a, STATIC,   SINGULAR, UINT32,   offset_ms,         3)
+#define transporter_LDRSample_CALLBACK NULL
+#define transporter_LDRSample_DEFAULT NULL
+
+#define transporter_MotionSample_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   id,                1) \
+X(a, STATIC,   SINGULAR, BOOL,     detected,          2) \
+X(a, STATIC,   SINGULAR, UINT32,   offset_ms,         3)
+#define transporter_MotionSample_CALLBACK NULL
+#define transporter_MotionSample_DEFAULT NULL
+
+#define transporter_TelemetryBatch_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   window_start_ms,   1) \
+X(a, STATIC,   REPEATED, MESSAGE,  climates,          2) \
+X(a, STATIC,   REPEATED, MESSAGE,  ldrs,              3) \
+X(a, STATIC,   REPEATED, MESSAGE,  motions,           4)
+#define transporter_TelemetryBatch_CALLBACK NULL
+#define transporter_TelemetryBatch_DEFAULT NULL
+#define transporter_TelemetryBatch_climates_MSGTYPE transporter_ClimateSample
+#define transporter_TelemetryBatch_ldrs_MSGTYPE transporter_LDRSample
+#define transporter_TelemetryBatch_motions_MSGTYPE transporter_MotionSample
+
+#define transporter_RuleEvent_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   rule_id,           1) \
+X(a, STATIC,   SINGULAR, BOOL,     active,            2) \
+X(a, STATIC,   SINGULAR, FLOAT,    value,             3)
+#define transporter_RuleEvent_CALLBACK NULL
+#define transporter_RuleEvent_DEFAULT NULL
+
+#define transporter_LatencyHistogram_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UENUM,    stage,             1) \
+X(a, STATIC,   SINGULAR, UINT32,   count,             2) \
+X(a, STATIC,   SINGULAR, UINT32,   total_us,          3) \
+X(a, STATIC,   SINGULAR, UINT32,   max_us,            4) \
+X(a, STATIC,   REPEATED, UINT32,   buckets,           5)
+#define transporter_LatencyHistogram_CALLBACK NULL
+#define transporter_LatencyHistogram_DEFAULT NULL
+
+#define transporter_AuthMetrics_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   window_ms,         1) \
+X(a, STATIC,   SINGULAR, UINT32,   decisions,         2) \
+X(a, STATIC,   SINGULAR, UINT32,   granted,           3) \
+X(a, STATIC,   REPEATED, MESSAGE,  stages,            4)
+#define transporter_AuthMetrics_CALLBACK NULL
+#define transporter_AuthMetrics_DEFAULT NULL
+#define transporter_AuthMetrics_stages_MSGTYPE transporter_LatencyHistogram
+
+#define transporter_AccessEvent_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   seq,               1) \
+X(a, STATIC,   SINGULAR, FIXED32,  uid_digest,        2) \
+X(a, STATIC,   SINGULAR, BOOL,     granted,           3) \
+X(a, STATIC,   SINGULAR, UENUM,    reason,            4) \
+X(a, STATIC,   SINGULAR, UINT32,   timestamp,         5)
+#define transporter_AccessEvent_CALLBACK NULL
+#define transporter_AccessEvent_DEFAULT NULL
+
+#define transporter_AccessLog_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, MESSAGE,  events,            1) \
+X(a, STATIC,   SINGULAR, UINT32,   lost,              2)
+#define transporter_AccessLog_CALLBACK NULL
+#define transporter_AccessLog_DEFAULT NULL
+#define transporter_AccessLog_events_MSGTYPE transporter_AccessEvent
+
 extern const pb_msgdesc_t transporter_WifiCredentials_msg;
 extern const pb_msgdesc_t transporter_UID_msg;
 extern const pb_msgdesc_t transporter_RegisterRequest_msg;
 extern const pb_msgdesc_t transporter_RegisterResponse_msg;
 extern const pb_msgdesc_t transporter_RevokeRequest_msg;
+extern const pb_msgdesc_t transporter_AccessWindow_msg;
+extern const pb_msgdesc_t transporter_WhitelistEntry_msg;
+extern const pb_msgdesc_t transporter_WhitelistSnapshot_msg;
+extern const pb_msgdesc_t transporter_WhitelistDelta_msg;
+extern const pb_msgdesc_t transporter_WhitelistStatus_msg;
 extern const pb_msgdesc_t transporter_RfidEnvelope_msg;
 extern const pb_msgdesc_t transporter_Climate_msg;
 extern const pb_msgdesc_t transporter_LDR_msg;
 extern const pb_msgdesc_t transporter_Motion_msg;
+extern const pb_msgdesc_t transporter_Rule_msg;
 extern const pb_msgdesc_t transporter_FullConfig_msg;
 extern const pb_msgdesc_t transporter_ConfigTopic_msg;
 extern const pb_msgdesc_t transporter_ClimateRemoval_msg;
 extern const pb_msgdesc_t transporter_LDRRemoval_msg;
 extern const pb_msgdesc_t transporter_MotionRemoval_msg;
+extern const pb_msgdesc_t transporter_RuleRemoval_msg;
 extern const pb_msgdesc_t transporter_ConfigRemoval_msg;
 extern const pb_msgdesc_t transporter_RelayState_msg;
 extern const pb_msgdesc_t transporter_RelayStateSync_msg;
 extern const pb_msgdesc_t transporter_ClimateData_msg;
 extern const pb_msgdesc_t transporter_LDRData_msg;
+extern const pb_msgdesc_t transporter_ClimateSample_msg;
+extern const pb_msgdesc_t transporter_LDRSample_msg;
+extern const pb_msgdesc_t transporter_MotionSample_msg;
+extern const pb_msgdesc_t transporter_TelemetryBatch_msg;
+extern const pb_msgdesc_t transporter_RuleEvent_msg;
+extern const pb_msgdesc_t transporter_LatencyHistogram_msg;
+extern const pb_msgdesc_t transporter_AuthMetrics_msg;
+extern const pb_msgdesc_t transporter_AccessEvent_msg;
+extern const pb_msgdesc_t transporter_AccessLog_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define transporter_WifiCredentials_fields &transporter_WifiCredentials_msg
@@ -422,20 +899,36 @@ extern const pb_msgdesc_t transporter_LDRData_msg;
 #define transporter_RegisterRequest_fields &transporter_RegisterRequest_msg
 #define transporter_RegisterResponse_fields &transporter_RegisterResponse_msg
 #define transporter_RevokeRequest_fields &transporter_RevokeRequest_msg
+#define transporter_AccessWindow_fields &transporter_AccessWindow_msg
+#define transporter_WhitelistEntry_fields &transporter_WhitelistEntry_msg
+#define transporter_WhitelistSnapshot_fields &transporter_WhitelistSnapshot_msg
+#define transporter_WhitelistDelta_fields &transporter_WhitelistDelta_msg
+#define transporter_WhitelistStatus_fields &transporter_WhitelistStatus_msg
 #define transporter_RfidEnvelope_fields &transporter_RfidEnvelope_msg
 #define transporter_Climate_fields &transporter_Climate_msg
 #define transporter_LDR_fields &transporter_LDR_msg
 #define transporter_Motion_fields &transporter_Motion_msg
+#define transporter_Rule_fields &transporter_Rule_msg
 #define transporter_FullConfig_fields &transporter_FullConfig_msg
 #define transporter_ConfigTopic_fields &transporter_ConfigTopic_msg
 #define transporter_ClimateRemoval_fields &transporter_ClimateRemoval_msg
 #define transporter_LDRRemoval_fields &transporter_LDRRemoval_msg
 #define transporter_MotionRemoval_fields &transporter_MotionRemoval_msg
+#define transporter_RuleRemoval_fields &transporter_RuleRemoval_msg
 #define transporter_ConfigRemoval_fields &transporter_ConfigRemoval_msg
 #define transporter_RelayState_fields &transporter_RelayState_msg
 #define transporter_RelayStateSync_fields &transporter_RelayStateSync_msg
 #define transporter_ClimateData_fields &transporter_ClimateData_msg
 #define transporter_LDRData_fields &transporter_LDRData_msg
+#define transporter_ClimateSample_fields &transporter_ClimateSample_msg
+#define transporter_LDRSample_fields &transporter_LDRSample_msg
+#define transporter_MotionSample_fields &transporter_MotionSample_msg
+#define transporter_TelemetryBatch_fields &transporter_TelemetryBatch_msg
+#define transporter_RuleEvent_fields &transporter_RuleEvent_msg
+#define transporter_LatencyHistogram_fields &transporter_LatencyHistogram_msg
+#define transporter_AuthMetrics_fields &transporter_AuthMetrics_msg
+#define transporter_AccessEvent_fields &transporter_AccessEvent_msg
+#define transporter_AccessLog_fields &transporter_AccessLog_msg
 
 /* Maximum encoded size of messages (where known) */
 /* transporter_WifiCredentials_size depends on runtime parameters */
@@ -443,21 +936,37 @@ extern const pb_msgdesc_t transporter_LDRData_msg;
 /* transporter_RegisterRequest_size depends on runtime parameters */
 /* transporter_RegisterResponse_size depends on runtime parameters */
 /* transporter_RevokeRequest_size depends on runtime parameters */
+/* transporter_WhitelistEntry_size depends on runtime parameters */
+/* transporter_WhitelistSnapshot_size depends on runtime parameters */
+/* transporter_WhitelistDelta_size depends on runtime parameters */
 /* transporter_RfidEnvelope_size depends on runtime parameters */
-#define TRANSPORTER_TRANSPORTER_PB_H_MAX_SIZE    transporter_ConfigTopic_size
+/* transporter_FullConfig_size depends on runtime parameters */
+/* transporter_ConfigTopic_size depends on runtime parameters */
+#define TRANSPORTER_TRANSPORTER_PB_H_MAX_SIZE    transporter_TelemetryBatch_size
+#define transporter_AccessEvent_size             21
+#define transporter_AccessLog_size               190
+#define transporter_AccessWindow_size            24
+#define transporter_AuthMetrics_size             186
 #define transporter_ClimateData_size             22
 #define transporter_ClimateRemoval_size          6
-#define transporter_Climate_size                 26
+#define transporter_ClimateSample_size           28
+#define transporter_Climate_size                 52
 #define transporter_ConfigRemoval_size           8
-#define transporter_ConfigTopic_size             175
-#define transporter_FullConfig_size              172
 #define transporter_LDRData_size                 12
 #define transporter_LDRRemoval_size              6
-#define transporter_LDR_size                     12
+#define transporter_LDRSample_size               18
+#define transporter_LDR_size                     26
+#define transporter_LatencyHistogram_size        82
 #define transporter_MotionRemoval_size           6
-#define transporter_Motion_size                  20
+#define transporter_MotionSample_size            14
+#define transporter_Motion_size                  40
 #define transporter_RelayStateSync_size          0
 #define transporter_RelayState_size              10
+#define transporter_RuleEvent_size               13
+#define transporter_RuleRemoval_size             6
+#define transporter_Rule_size                    36
+#define transporter_TelemetryBatch_size          234
+#define transporter_WhitelistStatus_size         18
 
 #ifdef __cplusplus
 } /* extern "C" */
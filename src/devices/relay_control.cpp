@@ -105,4 +105,14 @@ bool RelayControl::handleResponses()
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Registers the response polling task
+ * @param scheduler Scheduler driving the main loop
+ */
+void RelayControl::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("relay", RELAY_POLL_INTERVAL, TASK_HIGH, [this]()
+                           { handleResponses(); });
+}
@@ -203,6 +203,9 @@ void setup()
 
 void loop()
 {
-  monitor.update();
-  delay(100);
+  unsigned long idle = monitor.update();
+  if (idle > 0)
+  {
+    delay(idle);
+  }
 }
\ No newline at end of file
@@ -2,6 +2,16 @@
 
 #include <SPI.h>
 
+// Set by the IRQ line when a card answers the pending REQA
+static volatile bool card_answered = false;
+static volatile unsigned long answered_us = 0;
+
+static void on_card_irq()
+{
+    card_answered = true;
+    answered_us = micros();
+}
+
 /**
  * @brief Constructor — does not perform hardware initialization.
  */
@@ -31,16 +41,27 @@ RFID::~RFID()
  *
  * SPI.begin() is called and a new MFRC522 instance is allocated accordingly.
  *
- * @param authenticator Pointer to an instance implementing IRFIDAuthenticator.
+ * @param irq_pin Pin wired to the MFRC522 IRQ output, or -1 to poll
  * @return true if initialization was successful.
  */
-bool RFID::init()
+bool RFID::init(int irq_pin)
 {
     SPI.begin();
     // Use fixed pins: SS = 4, RST = 2
     rfid = new MFRC522(4, 2);
     rfid->PCD_Init();
 
+    if (irq_pin >= 0)
+    {
+        // IRQ pin active low, raised by the receiver
+        pinMode(irq_pin, INPUT_PULLUP);
+        rfid->PCD_WriteRegister(MFRC522::ComIEnReg, 0xA0);
+        rfid->PCD_WriteRegister(MFRC522::ComIrqReg, 0x7F);
+        card_answered = false;
+        attachInterrupt(digitalPinToInterrupt(irq_pin), on_card_irq, FALLING);
+        detection = RfidDetection::IRQ;
+    }
+
     return true;
 }
 
@@ -59,15 +80,93 @@ bool RFID::read_card()
         return false;
     }
 
-    if (!rfid->PICC_IsNewCardPresent() || !rfid->PICC_ReadCardSerial())
+    return detection == RfidDetection::IRQ ? serve_irq() : poll_card();
+}
+
+/**
+ * @brief Runs the blocking PICC_IsNewCardPresent handshake only when due. The interval is reset
+ * by a card and doubles on every empty poll once the reader has been idle for RFID_ACTIVE_HOLD_MS.
+ */
+bool RFID::poll_card()
+{
+    unsigned long now = millis();
+    if (now - last_poll_ms < poll_interval_ms)
+    {
+        stats.skipped++;
+        return false;
+    }
+    last_poll_ms = now;
+
+    unsigned long start = micros();
+    bool present = rfid->PICC_IsNewCardPresent();
+    unsigned long detected = micros();
+    stats.polls++;
+    stats.busy_us += detected - start;
+
+    if (!present)
+    {
+        if (now - last_card_ms >= RFID_ACTIVE_HOLD_MS && poll_interval_ms < RFID_POLL_MAX_MS)
+            poll_interval_ms = min(poll_interval_ms * 2, (unsigned long)RFID_POLL_MAX_MS);
+        return false;
+    }
+
+    last_card_ms = now;
+    poll_interval_ms = RFID_POLL_MIN_MS;
+    return read_serial(start);
+}
+
+/**
+ * @brief Serves a pending answer, otherwise starts a REQA with four register writes and returns
+ * without waiting for it.
+ */
+bool RFID::serve_irq()
+{
+    unsigned long start = micros();
+
+    if (card_answered)
     {
+        card_answered = false;
+        stats.interrupts++;
+
+        bool read = read_serial(answered_us);
+        unsigned long cleared = micros();
+        rfid->PCD_WriteRegister(MFRC522::ComIrqReg, 0x7F);
+        // The frames of the read and the halt raised the line again; those are not new cards
+        card_answered = false;
+        stats.busy_us += micros() - cleared;
+        return read;
+    }
+
+    unsigned long now = millis();
+    if (now - last_poll_ms < RFID_POLL_MIN_MS)
+    {
+        stats.skipped++;
         return false;
     }
+    last_poll_ms = now;
 
-    // Pass raw UID bytes to the authenticator
+    rfid->PCD_WriteRegister(MFRC522::ComIrqReg, 0x7F);
+    rfid->PCD_WriteRegister(MFRC522::FIFODataReg, MFRC522::PICC_CMD_REQA);
+    rfid->PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+    rfid->PCD_WriteRegister(MFRC522::BitFramingReg, 0x87); // StartSend, 7-bit short frame
+    stats.kicks++;
+    stats.busy_us += micros() - start;
+    return false;
+}
+
+bool RFID::read_serial(unsigned long start)
+{
+    unsigned long begin = micros();
+    if (!rfid->PICC_ReadCardSerial())
+    {
+        stats.busy_us += micros() - begin;
+        return false;
+    }
+    timing = {start, begin - start, micros() - begin};
 
     rfid->PICC_HaltA();
     rfid->PCD_StopCrypto1();
+    stats.busy_us += micros() - begin;
 
     return true;
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include <sensors/climate.h>
 
 #include <Arduino.h>
+#include <new>
 
 /**
  * @brief Constructs a Climate instance with default values.
@@ -14,13 +15,13 @@ Climate::Climate()
 }
 
 /**
- * @brief Destroys the Climate instance and releases DHT sensor memory.
+ * @brief Destroys the Climate instance and its DHT sensor.
  */
 Climate::~Climate()
 {
     if (dht_sensor)
     {
-        delete dht_sensor;
+        dht_sensor->~DHT();
         dht_sensor = nullptr;
     }
 }
@@ -28,7 +29,7 @@ Climate::~Climate()
 /**
  * @brief Initializes the Climate module.
  *
- * This function sets mux ports, pins, and allocates the DHT sensor.
+ * This function sets mux ports, pins, and constructs the DHT sensor in place.
  * @param d_port Digital mux channel for DHT sensor
  * @param a_port Analog mux channel for air quality sensor
  * @param signal_pin GPIO pin used for DHT data
@@ -45,10 +46,10 @@ bool Climate::init(int id, int d_port, const uint8_t &a_port, int signal_pin, Mu
 
     if (dht_sensor)
     {
-        delete dht_sensor;
+        dht_sensor->~DHT();
     }
 
-    dht_sensor = new DHT(signal_pin, DHT22);
+    dht_sensor = new (dht_storage) DHT(signal_pin, DHT22);
     dht_sensor->begin();
 
     return air_quality_sensor.init();
@@ -10,8 +10,8 @@
  */
 void LDR::init(int id, uint8_t pin)
 {
+    this->id = id;
     _analog_pin = pin;
-    ;
     pinMode(_analog_pin, INPUT);
 }
 
@@ -25,6 +25,16 @@ int LDR::get_id() const
     return id;
 }
 
+/**
+ * @brief Returns the analog pin the LDR is read from.
+ *
+ * @return The analog pin of the LDR.
+ */
+uint8_t LDR::get_port() const
+{
+    return _analog_pin;
+}
+
 /**
  * @brief Reads the current analog value from the LDR sensor.
  *
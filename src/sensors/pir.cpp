@@ -71,3 +71,69 @@ void PIR::detect_movement()
         movement = digitalRead(_port) == HIGH;
     }
 }
+
+/**
+ * @brief Sets the debounce time and occupancy timeout used by poll().
+ * @param debounce_ms Time the raw input must be stable before it is accepted.
+ * @param hold_ms Time occupancy is kept after the last accepted motion.
+ */
+void PIR::configure(unsigned long debounce_ms, unsigned long hold_ms)
+{
+    this->debounce_ms = debounce_ms;
+    this->hold_ms = hold_ms;
+}
+
+/**
+ * @brief Samples the sensor and updates the debounced occupancy state.
+ *
+ * A raw change is accepted once it has been stable for the debounce time. Occupancy
+ * is set on accepted motion and cleared once no motion was seen for the hold time.
+ *
+ * @param now Current time in milliseconds.
+ * @return True if the occupancy state changed.
+ */
+bool PIR::poll(unsigned long now)
+{
+    detect_movement();
+
+    if (movement != candidate)
+    {
+        candidate = movement;
+        candidate_ms = now;
+        edge_us = micros();
+    }
+
+    if (candidate != stable && now - candidate_ms >= debounce_ms)
+        stable = candidate;
+
+    bool previous = occupied;
+    if (stable)
+    {
+        occupied = true;
+        last_seen_ms = now;
+    }
+    else if (occupied && now - last_seen_ms >= hold_ms)
+    {
+        occupied = false;
+    }
+
+    return occupied != previous;
+}
+
+/**
+ * @brief Returns the occupancy state computed by poll().
+ * @return True while motion is present or within the hold time.
+ */
+bool PIR::is_occupied() const
+{
+    return occupied;
+}
+
+/**
+ * @brief Returns when the raw input last changed, for latency measurements.
+ * @return Value of micros() at the last raw edge.
+ */
+unsigned long PIR::get_edge_us() const
+{
+    return edge_us;
+}
@@ -0,0 +1,193 @@
+#include <services/access_journal.h>
+
+#include <pb_encode.h>
+#include <transporter.pb.h>
+
+static_assert(JOURNAL_BATCH <= sizeof(transporter_AccessLog::events) / sizeof(transporter_AccessEvent),
+              "AccessLog.events is too small for a batch");
+static_assert(transporter_AccessLog_size <= MQTT_MAX_PAYLOAD_LENGTH, "an AccessLog batch must fit a queued message");
+static_assert(JOURNAL_CAPACITY <= UINT8_MAX, "slots are indexed with a uint8_t");
+
+/**
+ * @brief Loads the journal and builds the upload topic.
+ */
+void AccessJournal::init(StorageManager *storage, MQTTManager *mqtt, const SystemClock *clock, const String &device_uid)
+{
+    this->storage = storage;
+    this->mqtt = mqtt;
+    this->clock = clock;
+    topic = "arduino/" + device_uid + "/access";
+    load();
+}
+
+/**
+ * @brief XOR of the other bytes, offset so an all-zero entry is invalid.
+ */
+uint8_t AccessJournal::checksum(const journal_entry &entry)
+{
+    const uint8_t *bytes = (const uint8_t *)&entry;
+    uint8_t check = 0xA5;
+    for (size_t i = 0; i < offsetof(journal_entry, check); i++)
+        check ^= bytes[i];
+    return check;
+}
+
+/**
+ * @brief Scans every slot for the valid entry with the newest sequence number. A torn cursor
+ *        falls back to the oldest stored event, so events are resent rather than skipped.
+ */
+void AccessJournal::load()
+{
+    journal_header header;
+    storage->get(Partition::ACCESS_LOG, 0, header);
+    if (header.magic != JOURNAL_MAGIC)
+    {
+        format();
+        return;
+    }
+
+    stored = 0;
+    for (uint8_t slot = 0; slot < JOURNAL_CAPACITY; slot++)
+    {
+        journal_entry entry;
+        storage->get(Partition::ACCESS_LOG, slot_offset(slot), entry);
+        if (entry.check != checksum(entry))
+            continue;
+
+        if (stored == 0 || (int16_t)(entry.seq - newest_seq) > 0)
+        {
+            newest_seq = entry.seq;
+            newest_slot = slot;
+        }
+        stored++;
+    }
+
+    if (stored == 0)
+        newest_slot = JOURNAL_CAPACITY - 1;
+
+    if (header.sent_check == (uint16_t)~header.sent_seq)
+        sent_seq = header.sent_seq;
+    else
+        sent_seq = newest_seq - stored;
+    if (stored == 0)
+        newest_seq = sent_seq;
+}
+
+/**
+ * @brief Clears the entries first and writes the magic last, so an interrupted format is redone.
+ */
+void AccessJournal::format()
+{
+    const journal_entry empty = {0};
+    for (uint8_t slot = 0; slot < JOURNAL_CAPACITY; slot++)
+        storage->put(Partition::ACCESS_LOG, slot_offset(slot), empty);
+
+    newest_seq = 0;
+    newest_slot = JOURNAL_CAPACITY - 1;
+    stored = 0;
+    put_cursor(0);
+    storage->put(Partition::ACCESS_LOG, 0, (uint32_t)JOURNAL_MAGIC);
+}
+
+void AccessJournal::put_cursor(uint16_t seq)
+{
+    const uint16_t cursor[2] = {seq, (uint16_t)~seq};
+    storage->put(Partition::ACCESS_LOG, offsetof(journal_header, sent_seq), cursor);
+    sent_seq = seq;
+}
+
+/**
+ * @brief Returns the events after the cursor that are still stored.
+ */
+uint8_t AccessJournal::pending() const
+{
+    uint16_t unsent = newest_seq - sent_seq;
+    if (stored == 0 || unsent > 0x7FFF)
+        return 0;
+    return min(unsent, (uint16_t)stored);
+}
+
+/**
+ * @brief Writes the entry into the slot after the newest one; no other byte is touched.
+ */
+void AccessJournal::append(uint32_t uid_digest, bool granted, AccessReason reason)
+{
+    if (!storage)
+        return;
+
+    if (stored == JOURNAL_CAPACITY && pending() == JOURNAL_CAPACITY)
+        stats.overwritten++;
+
+    journal_entry entry;
+    entry.uid_digest = uid_digest;
+    entry.timestamp = clock && clock->is_synced() ? clock->now() : 0;
+    entry.seq = newest_seq + 1;
+    entry.code = (granted ? 0x80 : 0) | (uint8_t)reason;
+    entry.check = checksum(entry);
+
+    uint8_t slot = (newest_slot + 1) % JOURNAL_CAPACITY;
+    storage->put(Partition::ACCESS_LOG, slot_offset(slot), entry);
+
+    newest_seq = entry.seq;
+    newest_slot = slot;
+    if (stored < JOURNAL_CAPACITY)
+        stored++;
+    stats.appended++;
+
+    upload();
+}
+
+/**
+ * @brief Encodes up to JOURNAL_BATCH pending events, oldest first, and moves the cursor past them
+ *        once the message is queued.
+ */
+bool AccessJournal::upload()
+{
+    uint8_t count = pending();
+    if (!mqtt || count == 0 || !mqtt->is_connected())
+        return false;
+
+    transporter_AccessLog log = transporter_AccessLog_init_zero;
+    uint16_t seq = newest_seq - count;
+    while (log.events_count < JOURNAL_BATCH && log.events_count < count)
+    {
+        seq++;
+        uint8_t slot = (newest_slot + JOURNAL_CAPACITY - (uint16_t)(newest_seq - seq)) % JOURNAL_CAPACITY;
+
+        journal_entry entry;
+        storage->get(Partition::ACCESS_LOG, slot_offset(slot), entry);
+
+        transporter_AccessEvent &event = log.events[log.events_count++];
+        event.seq = entry.seq;
+        event.uid_digest = entry.uid_digest;
+        event.granted = entry.code & 0x80;
+        event.reason = (transporter_AccessReason)(entry.code & 0x7F);
+        event.timestamp = entry.timestamp;
+    }
+    log.lost = stats.overwritten;
+
+    uint8_t buffer[transporter_AccessLog_size];
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+    if (!pb_encode(&stream, transporter_AccessLog_fields, &log))
+    {
+        Serial.print("AccessJournal: Failed to encode AccessLog: ");
+        Serial.println(PB_GET_ERROR(&stream));
+        return false;
+    }
+
+    if (!mqtt->publish(topic.c_str(), buffer, stream.bytes_written, PublishPriority::URGENT))
+        return false;
+
+    put_cursor(seq);
+    stats.uploaded += log.events_count;
+    return true;
+}
+
+/**
+ * @brief Registers the upload retry; it only reaches the broker while events are pending.
+ */
+void AccessJournal::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("journal", JOURNAL_UPLOAD_INTERVAL, TASK_LOW, [this]()
+                           { upload(); });
+}
@@ -1,5 +1,123 @@
 #include <services/config_engine.h>
 
+// Layouts written by earlier firmware, frozen with the array sizes they were built with. A change to
+// config_data bumps CONFIG_VERSION and adds a layout and a migration below instead of editing these.
+
+struct climate_v1
+{
+    uint8_t id;
+    uint8_t dht22_port;
+    uint8_t aqi_port;
+    bool has_buzzer;
+    uint8_t buzzer_port;
+};
+
+struct ldr_v1
+{
+    uint8_t id;
+    uint8_t port;
+};
+
+struct motion_v1
+{
+    uint8_t id;
+    uint8_t port;
+    uint8_t relay_port;
+    uint8_t relay_type;
+};
+
+struct config_v1
+{
+    uint8_t version;
+    uint8_t size;
+    uint8_t climate_size;
+    uint8_t ldr_size;
+    uint8_t motion_size;
+    uint8_t relay_size;
+    climate_v1 climates[2];
+    ldr_v1 ldrs[2];
+    motion_v1 motions[4];
+};
+
+static_assert(sizeof(config_v1) == 36, "frozen config layouts must not change");
+
+/**
+ * @brief Clamps a stored record count to the frozen array and to the board profile's capacity.
+ */
+static uint8_t fitting(uint8_t count, size_t from_count, size_t to_count)
+{
+    if (count > from_count)
+        count = from_count;
+    if (count > to_count)
+        count = to_count;
+    return count;
+}
+
+// The size field widens to 16 bits and the arrays take the board profile's capacities, dropping the
+// records past a smaller one. New fields are zero: climates and LDRs publish every reading as before,
+// motions publish every sample without local automation, and no rules are configured.
+static void migrate_v1(uint8_t *image)
+{
+    config_v1 from;
+    memcpy(&from, image, sizeof(from));
+
+    config_data to = default_config;
+    to.relay_size = from.relay_size;
+
+    to.climate_size = fitting(from.climate_size, 2, MAX_CLIMATE);
+    for (uint8_t i = 0; i < to.climate_size; i++)
+    {
+        to.climates[i].id = from.climates[i].id;
+        to.climates[i].dht22_port = from.climates[i].dht22_port;
+        to.climates[i].aqi_port = from.climates[i].aqi_port;
+        to.climates[i].has_buzzer = from.climates[i].has_buzzer;
+        to.climates[i].buzzer_port = from.climates[i].buzzer_port;
+    }
+
+    to.ldr_size = fitting(from.ldr_size, 2, MAX_LDR);
+    for (uint8_t i = 0; i < to.ldr_size; i++)
+    {
+        to.ldrs[i].id = from.ldrs[i].id;
+        to.ldrs[i].port = from.ldrs[i].port;
+    }
+
+    to.motion_size = fitting(from.motion_size, 4, MAX_MOTION);
+    for (uint8_t i = 0; i < to.motion_size; i++)
+    {
+        to.motions[i].id = from.motions[i].id;
+        to.motions[i].port = from.motions[i].port;
+        to.motions[i].relay_port = from.motions[i].relay_port;
+        to.motions[i].relay_type = from.motions[i].relay_type;
+    }
+
+    memcpy(image, &to, sizeof(to));
+}
+
+/**
+ * @brief Size of each schema version and the migration to the next one, indexed by version.
+ */
+struct config_schema
+{
+    uint16_t size;
+    void (*migrate)(uint8_t *image);
+};
+
+static const config_schema CONFIG_SCHEMAS[] = {
+    {0, nullptr}, // version 0 was never written
+    {sizeof(config_v1), migrate_v1},
+    {sizeof(config_data), nullptr},
+};
+
+static_assert(sizeof(CONFIG_SCHEMAS) / sizeof(CONFIG_SCHEMAS[0]) == CONFIG_VERSION + 1,
+              "every schema version needs an entry and a migration to the next");
+
+// Migrations run in place in a buffer that holds the largest frozen layout and the current one, so
+// a board profile smaller than the old fixed capacities still upgrades
+constexpr uint16_t CONFIG_IMAGE_SIZE = sizeof(config_data) > sizeof(config_v1) ? sizeof(config_data) : sizeof(config_v1);
+
+// Firmware before the storage partitions wrote config_data raw at the start of the modules slot
+#define CONFIG_RAW_VERSION_MAX 1
+
 /**
  * @brief Constructor for ConfigEngine.
  *        Allocates memory for the internal configuration data.
@@ -20,54 +138,136 @@ ConfigEngine::~ConfigEngine()
 
 /**
  * @brief Initializes the configuration engine.
- *        Begins EEPROM and loads configuration from EEPROM.
+ *        Loads configuration from the modules partition.
  *
+ * @param storage Storage manager holding the modules partition.
  * @return true if configuration loaded or initialized successfully, false otherwise.
  */
-bool ConfigEngine::init()
+bool ConfigEngine::init(StorageManager *storage)
 {
-    EEPROM.begin();
+    this->storage = storage;
     return load_config();
 }
 
 /**
- * @brief Loads configuration from EEPROM.
- *        If the version or size mismatch is detected, reinitializes default config.
+ * @brief Loads configuration from the modules partition.
+ *        A copy of an older schema, or a raw copy from before the storage partitions, is upgraded
+ *        through the migration chain and written back. If no copy is valid, or a version or size
+ *        mismatch is detected (such as a copy written for another board profile), reinitializes
+ *        default config.
  *
  * @return true if loaded successfully or reset correctly, false otherwise.
  */
 bool ConfigEngine::load_config()
 {
-    EEPROM.get(EEPROM_ADDRESS, *_config);
+    unsigned long start = micros();
+    alignas(config_data) uint8_t image[CONFIG_IMAGE_SIZE];
+    uint8_t version = 0;
+    uint16_t length = sizeof(image);
+
+    bool valid = storage->stored_version(Partition::MODULES, version) &&
+                 version > 0 && version <= CONFIG_VERSION &&
+                 storage->read(Partition::MODULES, version, image, length);
+    if (!valid)
+    {
+        version = storage->read_byte(Partition::MODULES, 0);
+        length = version > 0 && version <= CONFIG_RAW_VERSION_MAX ? CONFIG_SCHEMAS[version].size : 0;
+        valid = length > 0 && storage->read_byte(Partition::MODULES, 1) == length;
+        for (uint16_t i = 0; valid && i < length; i++)
+            image[i] = storage->read_byte(Partition::MODULES, i);
+    }
 
     // Validate config version and size
-    if (_config->version != 1 || _config->size != sizeof(config_data))
+    valid = valid && length == CONFIG_SCHEMAS[version].size && image[0] == version;
+    if (valid && version < CONFIG_VERSION)
+    {
+        stats.migrated_from = version;
+        while (version < CONFIG_VERSION)
+            CONFIG_SCHEMAS[version++].migrate(image);
+    }
+    if (valid)
+        memcpy(_config, image, sizeof(config_data));
+
+    if (!valid || _config->version != CONFIG_VERSION || _config->size != sizeof(config_data))
     {
         // Reinitialize default config structure
-        _config->version = 1;
+        stats.migrated_from = 0;
+        _config->version = CONFIG_VERSION;
+        _config->reserved = 0;
         _config->size = sizeof(config_data);
         _config->climate_size = 0;
         _config->ldr_size = 0;
         _config->motion_size = 0;
         _config->relay_size = 0;
+        _config->rule_size = 0;
 
         return save_config(); // Save initialized defaults
     }
 
-    return true;
+    if (stats.migrated_from == 0)
+        return true;
+
+    // Keep the upgraded copy; the old one stays in the other slot until the next commit
+    mark(0, 0, CONFIG_RECORD_COUNT);
+    bool saved = save_config();
+    stats.migrate_us = micros() - start;
+    return saved;
 }
 
 /**
- * @brief Saves the current configuration to EEPROM.
+ * @brief Saves the current configuration to the modules partition.
  *
  * @return true on successful write.
  */
 bool ConfigEngine::save_config()
 {
-    EEPROM.put(EEPROM_ADDRESS, *_config);
+    if (!storage->write(Partition::MODULES, CONFIG_VERSION, _config, sizeof(config_data)))
+        return false;
+
+    stats.commits++;
+    for (uint32_t records = dirty; records; records &= records - 1)
+        stats.records++;
+    dirty = 0;
     return true;
 }
 
+/**
+ * @brief Marks a range of records and restarts the quiet window.
+ */
+void ConfigEngine::mark(uint8_t first, uint8_t from, uint8_t to)
+{
+    unsigned long now = millis();
+    if (dirty == 0)
+        first_change = now;
+    last_change = now;
+
+    for (uint8_t i = from; i < to; ++i)
+        dirty |= 1UL << (first + i);
+}
+
+/**
+ * @brief Commits once no change arrived for CONFIG_COMMIT_DELAY, or the oldest change waited
+ *        CONFIG_COMMIT_MAX_DELAY.
+ */
+void ConfigEngine::update()
+{
+    if (dirty == 0)
+        return;
+
+    unsigned long now = millis();
+    if (now - last_change >= CONFIG_COMMIT_DELAY || now - first_change >= CONFIG_COMMIT_MAX_DELAY)
+        save_config();
+}
+
+/**
+ * @brief Registers the periodic commit check.
+ */
+void ConfigEngine::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("config", CONFIG_COMMIT_POLL, TASK_LOW, [this]()
+                           { update(); });
+}
+
 /**
  * @brief Sets the default configuration.
  *
@@ -76,10 +276,10 @@ bool ConfigEngine::save_config()
 bool ConfigEngine::set_default_config()
 {
     // Set default values for all configurations
+    stats.updates++;
     *_config = default_config;
-
-    // Save the default configuration to EEPROM
-    return save_config();
+    mark(0, 0, CONFIG_RECORD_COUNT);
+    return true;
 }
 
 /**
@@ -94,56 +294,124 @@ bool ConfigEngine::set_full_config(config_data config)
     if (config.size != sizeof(config_data))
         return false;
 
-    // Copy the new config data
+    // Copy the new config data; records that did not change stay clean
+    stats.updates++;
+    if (memcmp(_config, &config, sizeof(config_data)) == 0)
+    {
+        stats.unchanged++;
+        return true;
+    }
     *_config = config;
-
-    // Save the new configuration to EEPROM
-    return save_config();
+    mark(0, 0, CONFIG_RECORD_COUNT);
+    return true;
 }
 
 /**
- * @brief Adds a new climate configuration.
+ * @brief Adds a new climate configuration, or replaces the one with the same ID.
  *
- * @param c Climate configuration to add.
- * @return true if added and saved successfully, false if storage is full.
+ * @param c Climate configuration to add or update.
+ * @return true if saved successfully, false if storage is full.
  */
 bool ConfigEngine::set_climate_config(climate c)
 {
+    stats.updates++;
+    for (int i = 0; i < _config->climate_size; ++i)
+    {
+        if (_config->climates[i].id == c.id)
+        {
+            store(_config->climates[i], c, CONFIG_RECORD_CLIMATES + i);
+            return true;
+        }
+    }
+
     if (_config->climate_size >= MAX_CLIMATE)
         return false;
 
+    mark(CONFIG_RECORD_HEADER, 0, 1);
+    mark(CONFIG_RECORD_CLIMATES, _config->climate_size, _config->climate_size + 1);
     _config->climates[_config->climate_size++] = c;
-    return save_config();
+    return true;
 }
 
 /**
- * @brief Adds a new LDR configuration.
+ * @brief Adds a new LDR configuration, or replaces the one with the same ID.
  *
- * @param l LDR configuration to add.
- * @return true if added and saved successfully, false if storage is full.
+ * @param l LDR configuration to add or update.
+ * @return true if saved successfully, false if storage is full.
  */
 bool ConfigEngine::set_ldr_config(ldr l)
 {
+    stats.updates++;
+    for (int i = 0; i < _config->ldr_size; ++i)
+    {
+        if (_config->ldrs[i].id == l.id)
+        {
+            store(_config->ldrs[i], l, CONFIG_RECORD_LDRS + i);
+            return true;
+        }
+    }
+
     if (_config->ldr_size >= MAX_LDR)
         return false;
 
+    mark(CONFIG_RECORD_HEADER, 0, 1);
+    mark(CONFIG_RECORD_LDRS, _config->ldr_size, _config->ldr_size + 1);
     _config->ldrs[_config->ldr_size++] = l;
-    return save_config();
+    return true;
 }
 
 /**
- * @brief Adds a new motion configuration.
+ * @brief Adds a new motion configuration, or replaces the one with the same ID.
  *
- * @param m Motion configuration to add.
- * @return true if added and saved successfully, false if storage is full.
+ * @param m Motion configuration to add or update.
+ * @return true if saved successfully, false if storage is full.
  */
 bool ConfigEngine::set_motion_config(motion m)
 {
+    stats.updates++;
+    for (int i = 0; i < _config->motion_size; ++i)
+    {
+        if (_config->motions[i].id == m.id)
+        {
+            store(_config->motions[i], m, CONFIG_RECORD_MOTIONS + i);
+            return true;
+        }
+    }
+
     if (_config->motion_size >= MAX_MOTION)
         return false;
 
+    mark(CONFIG_RECORD_HEADER, 0, 1);
+    mark(CONFIG_RECORD_MOTIONS, _config->motion_size, _config->motion_size + 1);
     _config->motions[_config->motion_size++] = m;
-    return save_config();
+    return true;
+}
+
+/**
+ * @brief Adds a new rule, or replaces the one with the same ID.
+ *
+ * @param r Rule to add or update.
+ * @return true if saved successfully, false if storage is full.
+ */
+bool ConfigEngine::set_rule_config(rule r)
+{
+    stats.updates++;
+    for (int i = 0; i < _config->rule_size; ++i)
+    {
+        if (_config->rules[i].id == r.id)
+        {
+            store(_config->rules[i], r, CONFIG_RECORD_RULES + i);
+            return true;
+        }
+    }
+
+    if (_config->rule_size >= MAX_RULES)
+        return false;
+
+    mark(CONFIG_RECORD_HEADER, 0, 1);
+    mark(CONFIG_RECORD_RULES, _config->rule_size, _config->rule_size + 1);
+    _config->rules[_config->rule_size++] = r;
+    return true;
 }
 
 /**
@@ -194,6 +462,22 @@ motion ConfigEngine::get_motion_config(uint8_t id)
     return {0};
 }
 
+/**
+ * @brief Retrieves a specific rule by ID.
+ *
+ * @param id ID of the rule.
+ * @return The matched rule or default-initialized if not found.
+ */
+rule ConfigEngine::get_rule_config(uint8_t id)
+{
+    for (int i = 0; i < _config->rule_size; ++i)
+    {
+        if (_config->rules[i].id == id)
+            return _config->rules[i];
+    }
+    return {0};
+}
+
 /**
  * @brief Deletes a climate configuration by ID.
  *
@@ -201,21 +485,24 @@ motion ConfigEngine::get_motion_config(uint8_t id)
  */
 void ConfigEngine::delete_climate_config(uint8_t id)
 {
+    stats.updates++;
     for (int i = 0; i < _config->climate_size; ++i)
     {
         if (_config->climates[i].id == id)
         {
-            // Shift remaining elements to the left
+            // Shift remaining elements to the left; only the shifted slots and the count change
             for (int j = i; j < _config->climate_size - 1; ++j)
             {
                 _config->climates[j] = _config->climates[j + 1];
             }
+            mark(CONFIG_RECORD_HEADER, 0, 1);
+            mark(CONFIG_RECORD_CLIMATES, i, _config->climate_size - 1);
             _config->climate_size--;
-            break;
+            return;
         }
     }
 
-    save_config();
+    stats.unchanged++;
 }
 
 /**
@@ -225,21 +512,24 @@ void ConfigEngine::delete_climate_config(uint8_t id)
  */
 void ConfigEngine::delete_ldr_config(uint8_t id)
 {
+    stats.updates++;
     for (int i = 0; i < _config->ldr_size; ++i)
     {
         if (_config->ldrs[i].id == id)
         {
-            // Shift remaining elements to the left
+            // Shift remaining elements to the left; only the shifted slots and the count change
             for (int j = i; j < _config->ldr_size - 1; ++j)
             {
                 _config->ldrs[j] = _config->ldrs[j + 1];
             }
+            mark(CONFIG_RECORD_HEADER, 0, 1);
+            mark(CONFIG_RECORD_LDRS, i, _config->ldr_size - 1);
             _config->ldr_size--;
-            break;
+            return;
         }
     }
 
-    save_config();
+    stats.unchanged++;
 }
 
 /**
@@ -249,21 +539,51 @@ void ConfigEngine::delete_ldr_config(uint8_t id)
  */
 void ConfigEngine::delete_motion_config(uint8_t id)
 {
+    stats.updates++;
     for (int i = 0; i < _config->motion_size; ++i)
     {
         if (_config->motions[i].id == id)
         {
-            // Shift remaining elements to the left
+            // Shift remaining elements to the left; only the shifted slots and the count change
             for (int j = i; j < _config->motion_size - 1; ++j)
             {
                 _config->motions[j] = _config->motions[j + 1];
             }
+            mark(CONFIG_RECORD_HEADER, 0, 1);
+            mark(CONFIG_RECORD_MOTIONS, i, _config->motion_size - 1);
             _config->motion_size--;
-            break;
+            return;
+        }
+    }
+
+    stats.unchanged++;
+}
+
+/**
+ * @brief Deletes a rule by ID.
+ *
+ * @param id ID of the rule to delete.
+ */
+void ConfigEngine::delete_rule_config(uint8_t id)
+{
+    stats.updates++;
+    for (int i = 0; i < _config->rule_size; ++i)
+    {
+        if (_config->rules[i].id == id)
+        {
+            // Shift remaining elements to the left; only the shifted slots and the count change
+            for (int j = i; j < _config->rule_size - 1; ++j)
+            {
+                _config->rules[j] = _config->rules[j + 1];
+            }
+            mark(CONFIG_RECORD_HEADER, 0, 1);
+            mark(CONFIG_RECORD_RULES, i, _config->rule_size - 1);
+            _config->rule_size--;
+            return;
         }
     }
 
-    save_config();
+    stats.unchanged++;
 }
 
 /**
@@ -0,0 +1,191 @@
+#include <services/rule_engine.h>
+
+#include <pb_encode.h>
+
+RuleEngine::RuleEngine()
+{
+    eventTopic[0] = '\0';
+}
+
+/**
+ * @brief Sets the devices driven by rule actions and builds the event topic.
+ */
+void RuleEngine::init(Mux *mux, RelayControl *relayControl, MQTTManager *mqtt, const String &deviceId)
+{
+    this->mux = mux;
+    this->relayControl = relayControl;
+    this->mqtt = mqtt;
+
+    snprintf(eventTopic, sizeof(eventTopic), "arduino/%s/rule", deviceId.c_str());
+}
+
+/**
+ * @brief Rebuilds the rule table. Without configured rules, the default climate alarms are used.
+ */
+void RuleEngine::compile(const config_data *config)
+{
+    for (int i = 0; i < output_count; i++)
+    {
+        if (outputs[i].active_count > 0)
+            drive(outputs[i], false);
+    }
+
+    rule_count = 0;
+    output_count = 0;
+
+    if (!config)
+        return;
+
+    for (int i = 0; i < config->rule_size; i++)
+    {
+        add(config->rules[i]);
+    }
+
+    if (config->rule_size == 0)
+    {
+        for (int i = 0; i < config->climate_size; i++)
+        {
+            const climate &c = config->climates[i];
+            if (!c.has_buzzer)
+                continue;
+
+            rule alarm = {RULE_DEFAULT_ID, 0, c.id, transporter_RuleComparator_ABOVE, transporter_RuleAction_BUZZER, c.buzzer_port, 0, 0, 0};
+
+            alarm.sensor = transporter_RuleSensor_TEMPERATURE;
+            alarm.threshold = 35.0f;
+            add(alarm);
+
+            alarm.sensor = transporter_RuleSensor_HUMIDITY;
+            alarm.threshold = 80.0f;
+            add(alarm);
+
+            alarm.sensor = transporter_RuleSensor_AQI;
+            alarm.threshold = 300.0f;
+            add(alarm);
+        }
+    }
+
+    // Start buzzers silent; relays keep whatever state they were given elsewhere
+    for (int i = 0; i < output_count; i++)
+    {
+        if (outputs[i].action == transporter_RuleAction_BUZZER)
+            drive(outputs[i], false);
+    }
+}
+
+bool RuleEngine::add(const rule &r)
+{
+    if (rule_count >= RULE_MAX_COMPILED)
+        return false;
+
+    CompiledRule &compiled = rules[rule_count++];
+    compiled.id = r.id;
+    compiled.sensor = r.sensor;
+    compiled.sensor_id = r.sensor_id;
+    compiled.action = r.action;
+    compiled.above = r.comparator == transporter_RuleComparator_ABOVE;
+    compiled.active = false;
+    compiled.on_threshold = r.threshold;
+    compiled.off_threshold = compiled.above ? r.threshold - r.hysteresis : r.threshold + r.hysteresis;
+    compiled.output = r.action == transporter_RuleAction_PUBLISH
+                          ? RULE_NO_OUTPUT
+                          : find_output(r.action, r.port, r.relay_type);
+
+    return true;
+}
+
+uint8_t RuleEngine::find_output(uint8_t action, uint8_t port, uint8_t relay_type)
+{
+    for (int i = 0; i < output_count; i++)
+    {
+        if (outputs[i].action == action && outputs[i].port == port && outputs[i].relay_type == relay_type)
+            return i;
+    }
+
+    outputs[output_count] = {action, port, relay_type, 0};
+    return output_count++;
+}
+
+/**
+ * @brief Applies hysteresis to each matching rule; outputs switch when their first rule
+ *        activates or their last rule clears.
+ */
+void RuleEngine::evaluate(uint8_t sensor, uint8_t sensor_id, float value)
+{
+    for (int i = 0; i < rule_count; i++)
+    {
+        CompiledRule &r = rules[i];
+        if (r.sensor != sensor || r.sensor_id != sensor_id)
+            continue;
+
+        stats.evaluations++;
+
+        bool active;
+        if (r.active)
+            active = r.above ? value > r.off_threshold : value < r.off_threshold;
+        else
+            active = r.above ? value > r.on_threshold : value < r.on_threshold;
+
+        if (active == r.active)
+            continue;
+
+        r.active = active;
+        stats.transitions++;
+
+        if (r.output == RULE_NO_OUTPUT)
+        {
+            publish_event(r, value);
+            continue;
+        }
+
+        Output &output = outputs[r.output];
+        if (active && output.active_count++ == 0)
+            drive(output, true);
+        else if (!active && --output.active_count == 0)
+            drive(output, false);
+    }
+}
+
+void RuleEngine::drive(const Output &output, bool on)
+{
+    stats.actions++;
+
+    if (output.action == transporter_RuleAction_BUZZER)
+    {
+        if (!mux)
+            return;
+
+        mux->m_mode(DIGITAL);
+        mux->s_mode(MUX_OUTPUT);
+        mux->channel(output.port);
+        mux->write(on ? HIGH : LOW);
+    }
+    else if (output.action == transporter_RuleAction_RELAY && relayControl)
+    {
+        relayControl->toggleRelay(output.relay_type, output.port, on ? HIGH : LOW);
+    }
+}
+
+void RuleEngine::publish_event(const CompiledRule &r, float value)
+{
+    if (!mqtt)
+        return;
+
+    stats.actions++;
+
+    transporter_RuleEvent event = transporter_RuleEvent_init_zero;
+    event.rule_id = r.id;
+    event.active = r.active;
+    event.value = value;
+
+    uint8_t buffer[transporter_RuleEvent_size];
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+    if (!pb_encode(&stream, transporter_RuleEvent_fields, &event))
+    {
+        Serial.print("RuleEngine: Failed to encode rule event: ");
+        Serial.println(PB_GET_ERROR(&stream));
+        return;
+    }
+
+    mqtt->publish(eventTopic, buffer, stream.bytes_written, PublishPriority::URGENT);
+}
@@ -0,0 +1,198 @@
+#include <services/scheduler.h>
+
+#include <utils/heap_probe.h>
+
+/**
+ * @brief Registers a periodic task. The first run is due immediately.
+ */
+int Scheduler::add_periodic(const char *name, unsigned long period_ms, task_priority priority, std::function<void()> callback)
+{
+    if (task_count >= SCHEDULER_MAX_TASKS || period_ms == 0)
+        return -1;
+
+    Task &task = tasks[task_count];
+    task.name = name;
+    task.callback = callback;
+    task.period_ms = period_ms;
+    task.due_ms = millis();
+    task.priority = priority;
+    task.pending = false;
+    task.stats = {0};
+
+    return task_count++;
+}
+
+/**
+ * @brief Registers an event task that stays idle until notified.
+ */
+int Scheduler::add_event(const char *name, task_priority priority, std::function<void()> callback)
+{
+    if (task_count >= SCHEDULER_MAX_TASKS)
+        return -1;
+
+    Task &task = tasks[task_count];
+    task.name = name;
+    task.callback = callback;
+    task.period_ms = 0;
+    task.due_ms = 0;
+    task.priority = priority;
+    task.pending = false;
+    task.stats = {0};
+
+    return task_count++;
+}
+
+/**
+ * @brief Marks a task as ready. The notification time is kept to measure jitter.
+ */
+void Scheduler::notify(int id)
+{
+    if (id < 0 || id >= task_count || tasks[id].pending)
+        return;
+
+    tasks[id].pending = true;
+    if (tasks[id].period_ms == 0)
+        tasks[id].due_ms = millis();
+}
+
+bool Scheduler::is_due(const Task &task, unsigned long now) const
+{
+    if (task.pending)
+        return true;
+
+    return task.period_ms > 0 && (long)(now - task.due_ms) >= 0;
+}
+
+void Scheduler::execute(Task &task, unsigned long now)
+{
+    unsigned long jitter = now - task.due_ms;
+
+    if (task.period_ms > 0)
+    {
+        // Keep the original cadence unless we fell more than a full period behind
+        task.due_ms += task.period_ms;
+        if ((long)(now - task.due_ms) >= 0)
+            task.due_ms = now + task.period_ms;
+    }
+    task.pending = false;
+
+    uint32_t allocations = heap_allocations();
+    unsigned long start = micros();
+    task.callback();
+    unsigned long elapsed = micros() - start;
+    task.stats.allocations += heap_allocations() - allocations;
+
+    task.stats.runs++;
+    task.stats.last_run_us = elapsed;
+    task.stats.total_run_us += elapsed;
+    if (elapsed > task.stats.max_run_us)
+        task.stats.max_run_us = elapsed;
+
+    task.stats.last_jitter_ms = jitter;
+    if (jitter > task.stats.max_jitter_ms)
+        task.stats.max_jitter_ms = jitter;
+}
+
+/**
+ * @brief Runs each due task once, highest priority first, then computes the idle time.
+ */
+unsigned long Scheduler::run()
+{
+    uint32_t executed = 0; // Bitmask of tasks already run in this pass
+
+    while (true)
+    {
+        unsigned long now = millis();
+        int selected = -1;
+
+        for (int i = 0; i < task_count; i++)
+        {
+            if ((executed & (1UL << i)) || !is_due(tasks[i], now))
+                continue;
+
+            if (selected < 0 || tasks[i].priority < tasks[selected].priority)
+                selected = i;
+        }
+
+        if (selected < 0)
+            break;
+
+        executed |= 1UL << selected;
+        execute(tasks[selected], now);
+    }
+
+    unsigned long now = millis();
+    unsigned long idle = SCHEDULER_MAX_IDLE_MS;
+
+    for (int i = 0; i < task_count; i++)
+    {
+        if (tasks[i].pending)
+            return 0;
+
+        if (tasks[i].period_ms == 0)
+            continue;
+
+        long remaining = (long)(tasks[i].due_ms - now);
+        if (remaining <= 0)
+            return 0;
+
+        if ((unsigned long)remaining < idle)
+            idle = remaining;
+    }
+
+    return idle;
+}
+
+/**
+ * @brief Returns the name of a task, or nullptr for an invalid id.
+ */
+const char *Scheduler::get_name(int id) const
+{
+    if (id < 0 || id >= task_count)
+        return nullptr;
+
+    return tasks[id].name;
+}
+
+/**
+ * @brief Returns the statistics of a task, or nullptr for an invalid id.
+ */
+const TaskStats *Scheduler::get_stats(int id) const
+{
+    if (id < 0 || id >= task_count)
+        return nullptr;
+
+    return &tasks[id].stats;
+}
+
+/**
+ * @brief Clears the statistics of every task.
+ */
+void Scheduler::reset_stats()
+{
+    for (int i = 0; i < task_count; i++)
+    {
+        tasks[i].stats = {0};
+    }
+}
+
+/**
+ * @brief Prints the per-task statistics as a table.
+ */
+void Scheduler::report(Print &out, unsigned long window_ms) const
+{
+    out.println("task        runs   avg_us   max_us  max_jit_ms  cpu_permille  allocs");
+
+    for (int i = 0; i < task_count; i++)
+    {
+        const TaskStats &stats = tasks[i].stats;
+        unsigned long avg = stats.runs ? stats.total_run_us / stats.runs : 0;
+        unsigned long permille = window_ms ? stats.total_run_us / window_ms : 0;
+
+        char line[80];
+        snprintf(line, sizeof(line), "%-10s %6lu %8lu %8lu %11lu %13lu %7lu",
+                 tasks[i].name, (unsigned long)stats.runs, avg, stats.max_run_us,
+                 stats.max_jitter_ms, permille, (unsigned long)stats.allocations);
+        out.println(line);
+    }
+}
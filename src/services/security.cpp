@@ -1,6 +1,17 @@
 #include <services/security.h>
 #include <Arduino.h>
 
+#include <pb_encode.h>
+#include <transporter.pb.h>
+
+static_assert((uint8_t)AuthStage::COUNT == _transporter_AuthStage_ARRAYSIZE, "AuthStage must match transporter_AuthStage");
+static_assert(transporter_AuthMetrics_size <= MQTT_MAX_PAYLOAD_LENGTH, "an AuthMetrics part must fit a queued message");
+
+static_assert(LATENCY_BUCKETS <= sizeof(transporter_LatencyHistogram::buckets) / sizeof(uint32_t),
+              "LatencyHistogram.buckets is too small");
+
+static constexpr uint8_t METRICS_STAGES_PER_PART = sizeof(transporter_AuthMetrics::stages) / sizeof(transporter_LatencyHistogram);
+
 Security::Security(WhiteListManager *whitelist)
     : whitelist(whitelist), uid(nullptr)
 {
@@ -12,9 +23,12 @@ Security::~Security()
     delete lock;
 }
 
-bool Security::init(WhiteListManager *whitelist)
+bool Security::init(WhiteListManager *whitelist, MQTTManager *mqtt, const String &device_uid)
 {
     this->whitelist = whitelist;
+    this->mqtt = mqtt;
+    metrics_topic = "arduino/" + device_uid + "/metrics";
+    metrics_window_start = millis();
 
     rfid = new RFID();
     lock = new Lock();
@@ -80,10 +94,17 @@ void Security::handle()
 
     if (!_awaiting_auth_response && !_awaiting_register_response && rfid->read_card())
     {
+        const card_timing &card = rfid->get_timing();
+        record(AuthStage::CARD_DETECT, card.detect_us);
+        record(AuthStage::CARD_READ, card.read_us);
+
+        unsigned long start = micros();
         uint8_t *uid = rfid->get_uid();
         size_t len = rfid->get_uid_length();
 
-        whitelist->set_uid(uid, len);
+        bool allowed = whitelist->set_uid(uid, len);
+        unsigned long decided = micros();
+        record(AuthStage::WHITELIST_LOOKUP, decided - start);
 
         if (whitelist->get_mode() == WhiteListMode::REGISTRATION)
         {
@@ -92,18 +113,113 @@ void Security::handle()
         }
         else
         {
-            if (whitelist->is_whitelisted(uid, len))
+            if (allowed)
             {
                 if (lock->unlock())
                 {
                     _awaiting_auth_response = true;
                     _operation_start_time = millis();
                 }
+                stats.granted++;
             }
             else
             {
                 lock->lock();
             }
+
+            unsigned long commanded = micros();
+            record(AuthStage::LOCK_COMMAND, commanded - decided);
+            record(AuthStage::CARD_TO_UNLOCK, commanded - card.start_us);
+
+            stats.decisions++;
+            stats.last_decision_us = commanded - start;
+            if (stats.last_decision_us > stats.max_decision_us)
+                stats.max_decision_us = stats.last_decision_us;
+        }
+    }
+}
+
+void Security::record(AuthStage stage, unsigned long us)
+{
+    LatencyHistogram &histogram = stats.latency[(uint8_t)stage];
+
+    uint8_t bucket = 0;
+    for (unsigned long bound = 128; us >= bound && bucket < LATENCY_BUCKETS - 1; bound <<= 1)
+        bucket++;
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.total_us += us;
+    if (us > histogram.max_us)
+        histogram.max_us = us;
+}
+
+// A report is split into parts of METRICS_STAGES_PER_PART stages so each fits a queued message. Every
+// part carries the window counters. A stage is only cleared once its part was queued; the rest of the
+// window is kept and reported again next time
+void Security::publish_metrics()
+{
+    unsigned long now = millis();
+
+    // Nothing to report if no card was read in this window, and no part is left from the last one
+    bool pending = false;
+    for (uint8_t i = 0; i < (uint8_t)AuthStage::COUNT; i++)
+        pending |= stats.latency[i].count > 0;
+
+    if (!mqtt || !pending)
+    {
+        metrics_window_start = now;
+        return;
+    }
+
+    for (uint8_t first = 0; first < (uint8_t)AuthStage::COUNT; first += METRICS_STAGES_PER_PART)
+    {
+        transporter_AuthMetrics metrics = transporter_AuthMetrics_init_zero;
+        metrics.window_ms = now - metrics_window_start;
+        metrics.decisions = stats.decisions;
+        metrics.granted = stats.granted;
+
+        for (uint8_t i = first; i < (uint8_t)AuthStage::COUNT && i < first + METRICS_STAGES_PER_PART; i++)
+        {
+            const LatencyHistogram &histogram = stats.latency[i];
+            transporter_LatencyHistogram &out = metrics.stages[metrics.stages_count++];
+            out.stage = (transporter_AuthStage)i;
+            out.count = histogram.count;
+            out.total_us = histogram.total_us;
+            out.max_us = histogram.max_us;
+
+            // Trailing empty buckets are left out
+            out.buckets_count = LATENCY_BUCKETS;
+            while (out.buckets_count > 0 && histogram.buckets[out.buckets_count - 1] == 0)
+                out.buckets_count--;
+            memcpy(out.buckets, histogram.buckets, out.buckets_count * sizeof(out.buckets[0]));
         }
+
+        uint8_t buffer[transporter_AuthMetrics_size];
+        pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+        if (!pb_encode(&stream, transporter_AuthMetrics_fields, &metrics))
+        {
+            Serial.print("Security: Failed to encode AuthMetrics: ");
+            Serial.println(PB_GET_ERROR(&stream));
+            return;
+        }
+
+        if (!mqtt->publish(metrics_topic.c_str(), buffer, stream.bytes_written, PublishPriority::TELEMETRY))
+        {
+            Serial.println("Security: AuthMetrics not queued, keeping the window");
+            return;
+        }
+
+        memset(&stats.latency[first], 0, metrics.stages_count * sizeof(stats.latency[0]));
     }
+
+    metrics_window_start = now;
+}
+
+void Security::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("security", POLL_INTERVAL, TASK_CRITICAL, [this]()
+                           { handle(); });
+    scheduler.add_periodic("auth_stats", AUTH_METRICS_INTERVAL, TASK_LOW, [this]()
+                           { publish_metrics(); });
 }
@@ -1,52 +1,59 @@
 #include <services/sensor_manager.h>
 
+static_assert(transporter_TelemetryBatch_size <= MQTT_MAX_PAYLOAD_LENGTH,
+              "TelemetryBatch does not fit a publish queue slot");
+
+/**
+ * @brief Returns true if a value moved beyond a deadband around the last published value; a
+ *        deadband of 0 lets any change through
+ * @param deadband Tenths of the unit, or tenths of a percent of the reference when relative
+ */
+static bool outside_deadband(float value, float reference, uint16_t deadband, bool relative)
+{
+    float limit = deadband / 10.0f;
+    if (relative)
+        limit = fabsf(reference) * limit / 100.0f;
+
+    float delta = fabsf(value - reference);
+    return delta > 0 && delta >= limit;
+}
+
+/**
+ * @brief Returns true if a sensor has been silent for longer than its maximum silent interval
+ */
+static bool silence_expired(unsigned long last, uint16_t max_silent_s, unsigned long now)
+{
+    return max_silent_s > 0 && now - last >= max_silent_s * 1000UL;
+}
+
 /**
  * @brief Constructor
  */
-SensorManager::SensorManager() : configEngine(nullptr), mqtt(nullptr), mux(nullptr)
+SensorManager::SensorManager() : configEngine(nullptr), mqtt(nullptr), relayControl(nullptr), mux(nullptr)
 {
+    telemetryTopic[0] = '\0';
+    climateTopic[0] = '\0';
+    ldrTopic[0] = '\0';
+    relayTopic[0] = '\0';
 }
 
 /**
- * @brief Destructor - clean up created sensor modules
+ * @brief Destructor - return the sensor modules to their pools
  */
 SensorManager::~SensorManager()
 {
-    // Clean up any climate modules
     for (int i = 0; i < MAX_CLIMATE; i++)
-    {
-        if (climateModules[i])
-        {
-            delete climateModules[i];
-            climateModules[i] = nullptr;
-        }
-    }
-
-    // Clean up any LDR modules
+        climatePool.destroy(climateModules[i]);
     for (int i = 0; i < MAX_LDR; i++)
-    {
-        if (ldrModules[i])
-        {
-            delete ldrModules[i];
-            ldrModules[i] = nullptr;
-        }
-    }
-
-    // Clean up any PIR modules
+        ldrPool.destroy(ldrModules[i]);
     for (int i = 0; i < MAX_MOTION; i++)
-    {
-        if (pirModules[i])
-        {
-            delete pirModules[i];
-            pirModules[i] = nullptr;
-        }
-    }
+        pirPool.destroy(pirModules[i]);
 }
 
 /**
  * @brief Initialize the sensor manager
  */
-bool SensorManager::init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux, const String &deviceId)
+bool SensorManager::init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux, RelayControl *relayControl, const String &deviceId)
 {
     if (!configEngine || !mqtt || !mux)
     {
@@ -56,9 +63,15 @@ bool SensorManager::init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux
 
     this->configEngine = configEngine;
     this->mqtt = mqtt;
+    this->relayControl = relayControl;
     this->deviceId = deviceId;
     this->mux = mux;
 
+    snprintf(telemetryTopic, sizeof(telemetryTopic), "arduino/%s/telemetry", deviceId.c_str());
+    snprintf(climateTopic, sizeof(climateTopic), "arduino/%s/climate", deviceId.c_str());
+    snprintf(ldrTopic, sizeof(ldrTopic), "arduino/%s/ldr", deviceId.c_str());
+    snprintf(relayTopic, sizeof(relayTopic), "arduino/%s/relay", deviceId.c_str());
+
     // Get the configuration data
     config_data *config = configEngine->get_configs();
     if (!config)
@@ -67,22 +80,90 @@ bool SensorManager::init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux
         return false;
     }
 
-    // Initialize Climate modules
+    ruleEngine.init(mux, relayControl, mqtt, deviceId);
+    reconcile();
+    set_telemetry_mode(TELEMETRY_BATCHED ? TelemetryMode::BATCHED : TelemetryMode::PER_READING);
+
+    Serial.println("SensorManager: Initialization complete");
+    return true;
+}
+
+/**
+ * @brief Register the climate, LDR and motion sampling tasks
+ */
+void SensorManager::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("motion", SENSOR_READ_INTERVAL_MOTION, TASK_HIGH, [this]()
+                           { processMotionSensors(); });
+    scheduler.add_periodic("climate", SENSOR_READ_INTERVAL, TASK_NORMAL, [this]()
+                           { processClimateSensors(); });
+    scheduler.add_periodic("ldr", SENSOR_READ_INTERVAL, TASK_LOW, [this]()
+                           { processLdrSensors(); });
+    scheduler.add_periodic("telemetry", SENSOR_READ_INTERVAL, TASK_LOW, [this]()
+                           { flushTelemetryBatch(); });
+}
+
+/**
+ * @brief Match the module arrays to the configuration by ID, keeping the modules and report state of
+ *        sensors that are still configured
+ */
+void SensorManager::reconcile()
+{
+    if (!configEngine || !mux)
+        return;
+
+    config_data *config = configEngine->get_configs();
+
+    // Each type is matched in three passes: keep the modules whose id is still configured, return the
+    // rest to the pool, then create the new ones, so a full pool never blocks a replacement
+    Climate *climates[MAX_CLIMATE] = {nullptr};
+    ClimateReport climateKept[MAX_CLIMATE] = {};
     for (int i = 0; i < config->climate_size; i++)
     {
         climate c = config->climates[i];
+        int j = 0;
+        while (j < MAX_CLIMATE && !(climateModules[j] && climateModules[j]->get_id() == c.id))
+            j++;
+        if (j == MAX_CLIMATE)
+            continue;
+
+        climates[i] = climateModules[j];
+        climateModules[j] = nullptr;
+        climateKept[i] = climateReports[j];
+        if (climates[i]->get_d_port() != c.dht22_port || climates[i]->get_a_port() != c.aqi_port)
+        {
+            climates[i]->set_d_port(c.dht22_port);
+            climates[i]->set_a_port(c.aqi_port);
+            climateKept[i].valid = false;
+            reconcileStats.moved++;
+        }
+    }
+    for (int j = 0; j < MAX_CLIMATE; j++)
+    {
+        if (climateModules[j])
+        {
+            climatePool.destroy(climateModules[j]);
+            reconcileStats.removed++;
+        }
+    }
+    for (int i = 0; i < config->climate_size; i++)
+    {
+        if (climates[i])
+            continue;
 
-        climateModules[i] = new Climate();
+        climate c = config->climates[i];
+        climates[i] = climatePool.create();
 
         // Initialize with signal pin from mux and the mux instance
-        if (!climateModules[i]->init(c.id, c.dht22_port, c.aqi_port, mux->getSignalPin(), mux))
+        if (!climates[i] || !climates[i]->init(c.id, c.dht22_port, c.aqi_port, mux->getSignalPin(), mux))
         {
             Serial.print("SensorManager: Failed to initialize Climate module ID ");
             Serial.println(c.id);
-            delete climateModules[i];
-            climateModules[i] = nullptr;
+            climatePool.destroy(climates[i]);
+            climates[i] = nullptr;
             continue;
         }
+        reconcileStats.added++;
 
         Serial.print("SensorManager: Initialized Climate module ID ");
         Serial.print(c.id);
@@ -91,87 +172,127 @@ bool SensorManager::init(ConfigEngine *configEngine, MQTTManager *mqtt, Mux *mux
         Serial.print(" and AQI port ");
         Serial.println(c.aqi_port);
     }
+    memcpy(climateModules, climates, sizeof(climateModules));
+    memcpy(climateReports, climateKept, sizeof(climateReports));
 
-    // Initialize LDR modules
+    LDR *ldrs[MAX_LDR] = {nullptr};
+    LdrReport ldrKept[MAX_LDR] = {};
+    for (int i = 0; i < config->ldr_size; i++)
+    {
+        ldr l = config->ldrs[i];
+        int j = 0;
+        while (j < MAX_LDR && !(ldrModules[j] && ldrModules[j]->get_id() == l.id))
+            j++;
+        if (j == MAX_LDR)
+            continue;
+
+        ldrs[i] = ldrModules[j];
+        ldrModules[j] = nullptr;
+        ldrKept[i] = ldrReports[j];
+        if (ldrs[i]->get_port() != l.port)
+        {
+            ldrs[i]->init(l.id, l.port);
+            ldrKept[i].valid = false;
+            reconcileStats.moved++;
+        }
+    }
+    for (int j = 0; j < MAX_LDR; j++)
+    {
+        if (ldrModules[j])
+        {
+            ldrPool.destroy(ldrModules[j]);
+            reconcileStats.removed++;
+        }
+    }
     for (int i = 0; i < config->ldr_size; i++)
     {
+        if (ldrs[i])
+            continue;
+
         ldr l = config->ldrs[i];
+        ldrs[i] = ldrPool.create();
+        if (!ldrs[i])
+            continue;
 
-        // Create LDR module instance with mux
-        ldrModules[i] = new LDR();
-        ldrModules[i]->init(l.id, l.port);
+        ldrs[i]->init(l.id, l.port);
+        reconcileStats.added++;
 
         Serial.print("SensorManager: Initialized LDR module ID ");
         Serial.print(l.id);
         Serial.print(" on mux port ");
         Serial.println(l.port);
     }
+    memcpy(ldrModules, ldrs, sizeof(ldrModules));
+    memcpy(ldrReports, ldrKept, sizeof(ldrReports));
 
-    // Initialize motion sensor PIR modules
+    PIR *pirs[MAX_MOTION] = {nullptr};
+    unsigned long motionKept[MAX_MOTION] = {0};
     for (int i = 0; i < config->motion_size; i++)
     {
         motion m = config->motions[i];
+        int j = 0;
+        while (j < MAX_MOTION && !(pirModules[j] && pirModules[j]->get_id() == m.id))
+            j++;
+        if (j == MAX_MOTION)
+            continue;
 
-        // Create PIR module instance with mux
-        pirModules[i] = new PIR();
-        pirModules[i]->init(m.id, mux);
-        pirModules[i]->set_port(m.port);
-
-        Serial.print("SensorManager: Initialized PIR motion sensor ID ");
-        Serial.print(m.id);
-        Serial.print(" on mux port ");
-        Serial.println(m.port);
+        pirs[i] = pirModules[j];
+        pirModules[j] = nullptr;
+        motionKept[i] = lastMotionReport[j];
+        if (pirs[i]->get_port() != m.port)
+        {
+            pirs[i]->set_port(m.port);
+            reconcileStats.moved++;
+        }
     }
+    for (int j = 0; j < MAX_MOTION; j++)
+    {
+        if (pirModules[j])
+        {
+            pirPool.destroy(pirModules[j]);
+            reconcileStats.removed++;
+        }
+    }
+    for (int i = 0; i < config->motion_size; i++)
+    {
+        motion m = config->motions[i];
+        if (!pirs[i])
+        {
+            pirs[i] = pirPool.create();
+            if (!pirs[i])
+                continue;
+
+            pirs[i]->init(m.id, mux);
+            pirs[i]->set_port(m.port);
+            reconcileStats.added++;
+
+            Serial.print("SensorManager: Initialized PIR motion sensor ID ");
+            Serial.print(m.id);
+            Serial.print(" on mux port ");
+            Serial.println(m.port);
+        }
+        pirs[i]->configure(m.debounce_ms, m.hold_s * 1000UL);
+    }
+    memcpy(pirModules, pirs, sizeof(pirModules));
+    memcpy(lastMotionReport, motionKept, sizeof(lastMotionReport));
 
-    Serial.println("SensorManager: Initialization complete");
-    return true;
+    ruleEngine.compile(config);
 }
 
 /**
- * @brief Set buzzer state through mux
+ * @brief Select per-reading or batched publishing
  */
-void SensorManager::setBuzzerState(uint8_t port, uint8_t state)
+void SensorManager::set_telemetry_mode(TelemetryMode mode)
 {
-    if (!mux)
+    if (mode == telemetryMode)
         return;
 
-    // Select the buzzer channel on the mux
-    mux->m_mode(DIGITAL);
-    mux->s_mode(MUX_OUTPUT);
-    mux->channel(port);
-    mux->write(state);
-}
-
-/**
- * @brief Update method to be called in the main loop
- */
-void SensorManager::update()
-{
-    unsigned long currentTime = millis();
-
-    // Process climate sensors at regular intervals
-    if (currentTime - lastClimateReadTime >= SENSOR_READ_INTERVAL)
-    {
-        processClimateSensors();
-        lastClimateReadTime = currentTime;
-    }
-
-    // Process LDR sensors at regular intervals
-    if (currentTime - lastLdrReadTime >= SENSOR_READ_INTERVAL)
-    {
-        processLdrSensors();
-        lastLdrReadTime = currentTime;
-    }
-
-    if (currentTime - lastMotionReadTime >= SENSOR_READ_INTERVAL_MOTION)
-    {
-        processMotionSensors();
-        lastMotionReadTime = currentTime;
-    }
+    flushTelemetryBatch();
+    telemetryMode = mode;
 }
 
 /**
- * @brief Read climate sensors and publish data
+ * @brief Read climate sensors and publish readings that left their deadband
  */
 void SensorManager::processClimateSensors()
 {
@@ -196,20 +317,39 @@ void SensorManager::processClimateSensors()
         float humidity = climateModules[i]->get_humidity();
         uint32_t aqi = climateModules[i]->get_air_quality_index();
 
-        // Publish climate data
-        publishClimateData(c.id, temperature, humidity, aqi);
+        // Publish only when a value left its deadband or the sensor was silent too long
+        unsigned long now = millis();
+        ClimateReport &last = climateReports[i];
+        bool noDeadband = c.temperature_deadband == 0 && c.humidity_deadband == 0 && c.aqi_deadband == 0;
+        bool report = !last.valid || noDeadband ||
+                      outside_deadband(temperature, last.temperature, c.temperature_deadband, c.relative_deadband) ||
+                      outside_deadband(humidity, last.humidity, c.humidity_deadband, c.relative_deadband) ||
+                      outside_deadband(aqi, last.aqi, c.aqi_deadband, c.relative_deadband) ||
+                      silence_expired(last.time, c.max_silent_s, now);
+
+        if (report)
+        {
+            if (telemetryMode == TelemetryMode::BATCHED)
+                addClimateSample(c.id, temperature, humidity, aqi);
+            else
+                publishClimateData(c.id, temperature, humidity, aqi);
 
-        // Check for high temperature/humidity and trigger buzzer if configured
-        if (c.has_buzzer)
+            last = {temperature, humidity, aqi, now, true};
+        }
+        else
         {
-            bool alarmCondition = (temperature > 35.0f) || (humidity > 80.0f) || (aqi > 300);
-            setBuzzerState(c.buzzer_port, alarmCondition ? HIGH : LOW);
+            suppressedReadings++;
         }
+
+        // Rules see every reading, published or not
+        ruleEngine.evaluate(transporter_RuleSensor_TEMPERATURE, c.id, temperature);
+        ruleEngine.evaluate(transporter_RuleSensor_HUMIDITY, c.id, humidity);
+        ruleEngine.evaluate(transporter_RuleSensor_AQI, c.id, aqi);
     }
 }
 
 /**
- * @brief Read LDR sensors and publish data
+ * @brief Read LDR sensors and publish readings that left their deadband
  */
 void SensorManager::processLdrSensors()
 {
@@ -228,14 +368,33 @@ void SensorManager::processLdrSensors()
 
         // Read LDR value
         uint32_t ldrValue = ldrModules[i]->read();
+        ruleEngine.evaluate(transporter_RuleSensor_LIGHT, l.id, ldrValue);
+
+        // Publish only when the value left its deadband or the sensor was silent too long
+        unsigned long now = millis();
+        LdrReport &last = ldrReports[i];
+        bool report = !last.valid || l.deadband == 0 ||
+                      outside_deadband(ldrValue, last.value, l.deadband, l.relative_deadband) ||
+                      silence_expired(last.time, l.max_silent_s, now);
+
+        if (report)
+        {
+            if (telemetryMode == TelemetryMode::BATCHED)
+                addLdrSample(l.id, ldrValue);
+            else
+                publishLdrData(l.id, ldrValue);
 
-        // Publish LDR data
-        publishLdrData(l.id, ldrValue);
+            last = {ldrValue, now, true};
+        }
+        else
+        {
+            suppressedReadings++;
+        }
     }
 }
 
 /**
- * @brief Check motion sensors and publish relay state if motion detected
+ * @brief Poll motion sensors and publish only on occupancy changes or heartbeats
  */
 void SensorManager::processMotionSensors()
 {
@@ -246,27 +405,69 @@ void SensorManager::processMotionSensors()
     if (!config)
         return;
 
+    unsigned long now = millis();
+
     for (int i = 0; i < config->motion_size; i++)
     {
         motion m = config->motions[i];
         if (!pirModules[i])
             continue;
 
-        // Check for motion detection
-        bool motionDetected = pirModules[i]->get_movement();
-        if (motionDetected)
+        if (pirModules[i]->poll(now))
         {
-            // Publish relay state
-            publishRelayState(m.relay_type, m.relay_port, HIGH);
+            if (m.local_automation)
+                actuateRelay(i, pirModules[i]->is_occupied());
+
+            reportMotion(i, pirModules[i]->is_occupied());
+            lastMotionReport[i] = now;
         }
-        else
+        else if (m.heartbeat_s > 0 && now - lastMotionReport[i] >= m.heartbeat_s * 1000UL)
         {
-            // Publish relay state
-            publishRelayState(m.relay_type, m.relay_port, LOW);
+            reportMotion(i, pirModules[i]->is_occupied());
+            lastMotionReport[i] = now;
         }
     }
 }
 
+/**
+ * @brief Publish the occupancy state of a motion sensor
+ */
+void SensorManager::reportMotion(int index, bool occupied)
+{
+    motion m = configEngine->get_configs()->motions[index];
+
+    if (telemetryMode == TelemetryMode::BATCHED)
+        addMotionSample(m.id, occupied);
+    else
+        publishRelayState(m.relay_type, m.relay_port, occupied ? HIGH : LOW);
+}
+
+/**
+ * @brief Drive the relay directly; the relay turns off once the hold time clears occupancy
+ */
+void SensorManager::actuateRelay(int index, bool occupied)
+{
+    if (!relayControl)
+        return;
+
+    motion m = configEngine->get_configs()->motions[index];
+
+    if (!relayControl->toggleRelay(m.relay_type, m.relay_port, occupied ? HIGH : LOW))
+    {
+        automationStats.failures++;
+        return;
+    }
+
+    automationStats.actuations++;
+    if (!occupied)
+        return; // Turning off follows the hold time, not an edge
+
+    unsigned long latency = micros() - pirModules[index]->get_edge_us();
+    automationStats.last_latency_us = latency;
+    if (latency > automationStats.max_latency_us)
+        automationStats.max_latency_us = latency;
+}
+
 /**
  * @brief Publish climate data to MQTT topic
  */
@@ -294,11 +495,7 @@ void SensorManager::publishClimateData(uint8_t id, float temperature, float humi
         return;
     }
 
-    // Construct the MQTT topic
-    String topic = "arduino/" + deviceId + "/climate";
-
-    // Publish the message
-    mqtt->publish(topic.c_str(), buffer, stream.bytes_written);
+    mqtt->publish(climateTopic, buffer, stream.bytes_written);
 }
 
 /**
@@ -326,11 +523,7 @@ void SensorManager::publishLdrData(uint8_t id, uint32_t value)
         return;
     }
 
-    // Construct the MQTT topic
-    String topic = "arduino/" + deviceId + "/ldr";
-
-    // Publish the message
-    mqtt->publish(topic.c_str(), buffer, stream.bytes_written);
+    mqtt->publish(ldrTopic, buffer, stream.bytes_written);
 }
 
 /**
@@ -359,9 +552,89 @@ void SensorManager::publishRelayState(uint8_t type, uint8_t port, uint8_t state)
         return;
     }
 
-    // Construct the MQTT topic
-    String topic = "arduino/" + deviceId + "/relay";
+    mqtt->publish(relayTopic, buffer, stream.bytes_written);
+}
+
+/**
+ * @brief Returns the offset of a new sample, opening a window if the batch is empty
+ */
+uint32_t SensorManager::batchOffset()
+{
+    unsigned long now = millis();
+
+    if (batch.climates_count == 0 && batch.ldrs_count == 0 && batch.motions_count == 0)
+        batch.window_start_ms = now;
+
+    return now - batch.window_start_ms;
+}
+
+/**
+ * @brief Append a climate reading to the current batch
+ */
+void SensorManager::addClimateSample(uint8_t id, float temperature, float humidity, uint32_t aqi)
+{
+    if (batch.climates_count >= sizeof(batch.climates) / sizeof(batch.climates[0]))
+        flushTelemetryBatch();
+
+    transporter_ClimateSample &sample = batch.climates[batch.climates_count];
+    sample.offset_ms = batchOffset();
+    sample.id = id;
+    sample.temperature = temperature;
+    sample.humidity = humidity;
+    sample.aqi = aqi;
+    batch.climates_count++;
+}
+
+/**
+ * @brief Append an LDR reading to the current batch
+ */
+void SensorManager::addLdrSample(uint8_t id, uint32_t value)
+{
+    if (batch.ldrs_count >= sizeof(batch.ldrs) / sizeof(batch.ldrs[0]))
+        flushTelemetryBatch();
+
+    transporter_LDRSample &sample = batch.ldrs[batch.ldrs_count];
+    sample.offset_ms = batchOffset();
+    sample.id = id;
+    sample.value = value;
+    batch.ldrs_count++;
+}
+
+/**
+ * @brief Append a motion state change to the current batch. A full batch is sent early so no edge is lost.
+ */
+void SensorManager::addMotionSample(uint8_t id, bool detected)
+{
+    if (batch.motions_count >= sizeof(batch.motions) / sizeof(batch.motions[0]))
+        flushTelemetryBatch();
+
+    transporter_MotionSample &sample = batch.motions[batch.motions_count];
+    sample.offset_ms = batchOffset();
+    sample.id = id;
+    sample.detected = detected;
+    batch.motions_count++;
+}
+
+/**
+ * @brief Encode and publish the current batch, then start a new window
+ */
+void SensorManager::flushTelemetryBatch()
+{
+    if (!mqtt || (batch.climates_count == 0 && batch.ldrs_count == 0 && batch.motions_count == 0))
+        return;
+
+    uint8_t buffer[transporter_TelemetryBatch_size];
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+
+    bool status = pb_encode(&stream, transporter_TelemetryBatch_fields, &batch);
+    batch = transporter_TelemetryBatch_init_zero;
 
-    // Publish the message
-    mqtt->publish(topic.c_str(), buffer, stream.bytes_written);
-}
\ No newline at end of file
+    if (!status)
+    {
+        Serial.print("SensorManager: Failed to encode telemetry batch: ");
+        Serial.println(PB_GET_ERROR(&stream));
+        return;
+    }
+
+    mqtt->publish(telemetryTopic, buffer, stream.bytes_written);
+}
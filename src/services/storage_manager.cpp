@@ -0,0 +1,212 @@
+#include <services/storage_manager.h>
+
+// CRC32 table indexed by nibble; 64 bytes of flash instead of the usual 1 KB byte table
+static const uint32_t crc32_nibbles[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL};
+
+StorageManager::StorageManager()
+{
+    memset(current, -2, sizeof(current));
+    memset(sequence, 0, sizeof(sequence));
+}
+
+/**
+ * @brief Starts the EEPROM driver.
+ */
+void StorageManager::begin()
+{
+    EEPROM.begin();
+}
+
+/**
+ * @brief Computes a CRC32 over a buffer, continuing from a previous value.
+ */
+uint32_t StorageManager::crc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = crc32_nibbles[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = crc32_nibbles[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Checks the header of a slot, then streams its payload through the CRC.
+ */
+bool StorageManager::check_slot(Partition partition, uint8_t slot, partition_header &header)
+{
+    uint16_t base = slot_address(partition, slot);
+    EEPROM.get(base, header);
+
+    if (header.magic != STORAGE_MAGIC)
+        return false;
+
+    bool valid = header.id == (uint8_t)partition && header.length <= partition_capacity(partition);
+    if (valid)
+    {
+        uint32_t crc = crc32(0, (const uint8_t *)&header, offsetof(partition_header, crc));
+        uint8_t chunk[32];
+        for (uint16_t done = 0; done < header.length; done += sizeof(chunk))
+        {
+            uint16_t n = min((uint16_t)sizeof(chunk), (uint16_t)(header.length - done));
+            for (uint16_t i = 0; i < n; i++)
+                chunk[i] = EEPROM.read(base + sizeof(partition_header) + done + i);
+            crc = crc32(crc, chunk, n);
+        }
+        valid = crc == header.crc;
+    }
+
+    if (!valid)
+        stats.corrupt++;
+    return valid;
+}
+
+/**
+ * @brief Picks the valid slot with the newer sequence number.
+ */
+void StorageManager::locate(Partition partition)
+{
+    partition_header a, b;
+    bool a_valid = check_slot(partition, 0, a);
+    bool b_valid = check_slot(partition, 1, b);
+
+    uint8_t id = (uint8_t)partition;
+    if (a_valid && b_valid)
+        current[id] = (int16_t)(b.sequence - a.sequence) > 0 ? 1 : 0;
+    else if (a_valid || b_valid)
+        current[id] = a_valid ? 0 : 1;
+    else
+        current[id] = -1;
+
+    if (current[id] >= 0)
+        sequence[id] = current[id] == 0 ? a.sequence : b.sequence;
+}
+
+/**
+ * @brief Copies the payload of the newest valid slot.
+ */
+bool StorageManager::read(Partition partition, uint8_t version, void *data, uint16_t &length)
+{
+    if (STORAGE_LAYOUT[(uint8_t)partition].kind != PartitionKind::BLOB)
+        return false;
+
+    unsigned long start = micros();
+    stats.reads++;
+
+    locate(partition);
+    int8_t slot = current[(uint8_t)partition];
+
+    bool valid = false;
+    if (slot >= 0)
+    {
+        uint16_t base = slot_address(partition, slot);
+        partition_header header;
+        EEPROM.get(base, header);
+
+        valid = header.version == version && header.length <= length;
+        if (valid)
+        {
+            uint8_t *bytes = (uint8_t *)data;
+            for (uint16_t i = 0; i < header.length; i++)
+                bytes[i] = EEPROM.read(base + sizeof(partition_header) + i);
+            length = header.length;
+        }
+    }
+
+    stats.last_read_us = micros() - start;
+    return valid;
+}
+
+/**
+ * @brief Reads the version from the header of the newest valid slot.
+ */
+bool StorageManager::stored_version(Partition partition, uint8_t &version)
+{
+    if (STORAGE_LAYOUT[(uint8_t)partition].kind != PartitionKind::BLOB)
+        return false;
+
+    locate(partition);
+    int8_t slot = current[(uint8_t)partition];
+    if (slot < 0)
+        return false;
+
+    partition_header header;
+    EEPROM.get(slot_address(partition, slot), header);
+    version = header.version;
+    return true;
+}
+
+void StorageManager::program(uint16_t address, const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (EEPROM.read(address + i) == data[i])
+        {
+            stats.bytes_skipped++;
+            continue;
+        }
+        EEPROM.write(address + i, data[i]);
+        stats.bytes_written++;
+    }
+}
+
+/**
+ * @brief Writes the payload into the slot not holding the newest copy, then the header that makes it valid.
+ */
+bool StorageManager::write(Partition partition, uint8_t version, const void *data, uint16_t length)
+{
+    if (STORAGE_LAYOUT[(uint8_t)partition].kind != PartitionKind::BLOB || length > partition_capacity(partition))
+        return false;
+
+    uint8_t id = (uint8_t)partition;
+    if (current[id] == -2)
+        locate(partition);
+
+    // The first write goes to B, so a pre-partition record at the start of A survives until it is committed
+    uint8_t slot = current[id] == 1 ? 0 : 1;
+    uint16_t base = slot_address(partition, slot);
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    partition_header header = {STORAGE_MAGIC, id, version, length, (uint16_t)(sequence[id] + 1), 0, 0};
+    header.crc = crc32(crc32(0, (const uint8_t *)&header, offsetof(partition_header, crc)), bytes, length);
+
+    program(base + sizeof(partition_header), bytes, length);
+    program(base, (const uint8_t *)&header, sizeof(header));
+
+    current[id] = slot;
+    sequence[id] = header.sequence;
+    stats.writes++;
+    return true;
+}
+
+/**
+ * @brief Clears the header span of each slot; the payload bytes are left for the next write to reuse.
+ */
+void StorageManager::invalidate(Partition partition)
+{
+    const uint8_t cleared[sizeof(uint32_t)] = {0};
+    const partition_layout &layout = STORAGE_LAYOUT[(uint8_t)partition];
+
+    for (uint16_t i = 0; i < layout.clear_size; i += sizeof(cleared))
+    {
+        program(layout.offset + i, cleared, sizeof(cleared));
+        if (layout.slot_size)
+            program(layout.slot_offset + i, cleared, sizeof(cleared));
+    }
+
+    current[(uint8_t)partition] = layout.kind == PartitionKind::BLOB ? -1 : -2;
+}
+
+/**
+ * @brief Invalidates every partition.
+ */
+void StorageManager::format()
+{
+    for (uint8_t i = 0; i < (uint8_t)Partition::COUNT; i++)
+        invalidate((Partition)i);
+}
@@ -0,0 +1,66 @@
+#include <services/system_clock.h>
+
+#include <WiFi.h>
+
+/**
+ * @brief Fetches the network time. WiFi.getTime() returns 0 until the module has reached an NTP server.
+ */
+bool SystemClock::sync()
+{
+    unsigned long seconds = WiFi.getTime();
+    if (seconds == 0)
+    {
+        failures++;
+        return false;
+    }
+
+    set(seconds);
+    return true;
+}
+
+/**
+ * @brief Syncs if the clock was never synced or the last sync is older than CLOCK_SYNC_INTERVAL.
+ */
+void SystemClock::update()
+{
+    if (!synced || millis() - synced_ms >= CLOCK_SYNC_INTERVAL)
+        sync();
+}
+
+/**
+ * @brief Sets the clock from an external source.
+ */
+void SystemClock::set(uint32_t seconds)
+{
+    epoch = seconds;
+    synced_ms = millis();
+    synced = true;
+}
+
+/**
+ * @brief Returns true if the clock was synced within CLOCK_MAX_AGE_MS.
+ */
+bool SystemClock::is_synced() const
+{
+    return synced && millis() - synced_ms < CLOCK_MAX_AGE_MS;
+}
+
+/**
+ * @brief Extrapolates the time of the last sync with millis(). Syncs are far more frequent than the millis() wrap.
+ */
+uint32_t SystemClock::now() const
+{
+    if (!synced)
+        return 0;
+
+    return epoch + (millis() - synced_ms) / 1000;
+}
+
+/**
+ * @brief Registers the periodic time refresh.
+ */
+void SystemClock::register_tasks(Scheduler &scheduler)
+{
+    scheduler.add_periodic("clock", CLOCK_POLL_INTERVAL, TASK_LOW, [this]()
+                           { update(); });
+}
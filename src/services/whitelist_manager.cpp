@@ -5,52 +5,496 @@
 #include <pb_encode.h>
 #include <transporter.pb.h>
 
-void WhiteListManager::init(MQTTManager *mqtt_manager, const String &device_uid)
+// FNV-1a; also the first Bloom hash and the per-UID term of the set hash
+static uint32_t uid_hash(const uint8_t *uid, size_t length)
 {
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= uid[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+void WhiteListManager::init(StorageManager *storage, MQTTManager *mqtt_manager, const String &device_uid)
+{
+    this->storage = storage;
     this->device_uid = device_uid;
     mqtt = mqtt_manager;
+    load_from_eeprom();
 }
 
-void WhiteListManager::set_mode_registration()
+// Loads the newer valid header copy; false if neither copy is valid
+bool WhiteListManager::read_header()
 {
-    mode = WhiteListMode::REGISTRATION;
+    whitelist_log_header copies[2];
+    bool valid[2];
+
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        storage->get(Partition::WHITELIST, i * sizeof(whitelist_log_header), copies[i]);
+        valid[i] = copies[i].magic == W_STORE_MAGIC &&
+                   copies[i].crc == StorageManager::crc32(0, (const uint8_t *)&copies[i], offsetof(whitelist_log_header, crc)) &&
+                   copies[i].log_end <= W_LOG_SIZE && copies[i].gap_end <= W_LOG_SIZE &&
+                   copies[i].gap_start <= copies[i].gap_end;
+    }
+
+    if (!valid[0] && !valid[1])
+        return false;
+
+    if (valid[0] && valid[1])
+        header_copy = (int16_t)(copies[1].sequence - copies[0].sequence) > 0 ? 1 : 0;
+    else
+        header_copy = valid[1] ? 1 : 0;
+    header = copies[header_copy];
+    return true;
 }
 
-void WhiteListManager::set_uid(uint8_t *uid, size_t length)
+// Writes the header over the older copy; a torn write fails its CRC and the other copy stays in force
+void WhiteListManager::commit_header()
 {
-    if (length > MAX_UID_LENGTH)
+    header.sequence++;
+    header.crc = StorageManager::crc32(0, (const uint8_t *)&header, offsetof(whitelist_log_header, crc));
+    header_copy ^= 1;
+    storage->put(Partition::WHITELIST, header_copy * sizeof(whitelist_log_header), header);
+}
+
+// Replays the log into the RAM index; on first boot the log is formatted and the legacy list imported
+void WhiteListManager::load_from_eeprom()
+{
+    record_count = 0;
+    dead_bytes = 0;
+    compacting = false;
+    version = 0;
+    version_offset = W_NO_RECORD;
+    set_hash = 0;
+    window_count = 0;
+    memset(bloom, 0, sizeof(bloom));
+
+    if (!read_header())
+    {
+        header = {W_STORE_MAGIC, 0, 0, 0, 0, 0};
+        commit_header();
+        import_legacy();
         return;
-    memcpy(uid_buffer, uid, length);
-    uid_length = length;
-    new_uid_received = true;
+    }
+
+    // Power was lost between the last step of a compaction pass and its finish
+    if (header.gap_start < header.gap_end && header.gap_end >= header.log_end)
+        finish_compaction();
+
+    replay(0, header.gap_start);
+    replay(header.gap_end, header.log_end);
+    load_windows();
+    stats.storage_probes = 0;
+
+    // Resume an interrupted pass; the tombstones it has not reached yet are all kept
+    if (header.gap_end > 0)
+    {
+        compacting = true;
+        pass_end = header.gap_end;
+    }
 }
 
-void WhiteListManager::delete_uid(uint8_t *uid, size_t length)
+// Applies the records in [from, to): later records override earlier ones for the same UID. Window
+// records are skipped here and read by load_windows() once the final set is known.
+void WhiteListManager::replay(uint16_t from, uint16_t to)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+
+    for (uint16_t offset = from; offset + W_RECORD_SIZE <= to; offset += W_RECORD_SIZE)
+    {
+        uint8_t type = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset);
+        uint8_t len = read_record(offset, uid);
+        if (type == W_RECORD_WINDOW && len == sizeof(access_window))
+            continue;
+        if (type == W_RECORD_VERSION && len == sizeof(version))
+        {
+            if (version_offset != W_NO_RECORD)
+                dead_bytes += W_RECORD_SIZE;
+            memcpy(&version, uid, sizeof(version));
+            version_offset = offset;
+            continue;
+        }
+        if ((type != W_RECORD_LIVE && type != W_RECORD_SCHEDULED && type != W_RECORD_TOMBSTONE) ||
+            len == 0 || len > MAX_UID_LENGTH)
+        {
+            dead_bytes += W_RECORD_SIZE;
+            continue;
+        }
+
+        bool found;
+        int pos = search(uid, len, found);
+        if (found)
+        {
+            bool scheduled = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + sorted[pos]) == W_RECORD_SCHEDULED;
+            dead_bytes += scheduled ? 2 * W_RECORD_SIZE : W_RECORD_SIZE;
+        }
+
+        if (type == W_RECORD_TOMBSTONE)
+        {
+            dead_bytes += W_RECORD_SIZE;
+            if (found)
+            {
+                memmove(&sorted[pos], &sorted[pos + 1], (record_count - pos - 1) * sizeof(sorted[0]));
+                record_count--;
+                set_hash -= uid_hash(uid, len);
+            }
+        }
+        else if (found)
+        {
+            sorted[pos] = offset;
+        }
+        else if (record_count < MAX_WHITELIST_SIZE)
+        {
+            memmove(&sorted[pos + 1], &sorted[pos], (record_count - pos) * sizeof(sorted[0]));
+            sorted[pos] = offset;
+            record_count++;
+            bloom_add(uid, len);
+            set_hash += uid_hash(uid, len);
+        }
+    }
+}
+
+// Loads the window of every scheduled entry from the record before it. An interrupted compaction pass
+// may have copied the window but not the UID record after it, leaving the window at the end of the first range.
+// Compaction drops superseded records, so windows are only counted against the final set.
+void WhiteListManager::load_windows()
 {
-    int index = W_EEPROM_ADDR;
+    window_count = 0;
 
-    for (int i = 0; i < MAX_WHITELIST_SIZE; ++i)
+    for (int i = record_count - 1; i >= 0; --i)
     {
-        uint8_t len = EEPROM.read(index);
-        if (len == 0xFF || len == 0)
+        uint16_t offset = sorted[i];
+        if (storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset) != W_RECORD_SCHEDULED)
+            continue;
+
+        uint16_t previous = offset == header.gap_end ? header.gap_start : offset;
+
+        access_window window = {0xFFFF, 0, 0, {0, 0, 0}}; // a scheduled card without its window never gets in
+        if (previous >= W_RECORD_SIZE &&
+            storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + previous - W_RECORD_SIZE) == W_RECORD_WINDOW &&
+            storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + previous - W_RECORD_SIZE + 1) == sizeof(access_window))
+        {
+            storage->get(Partition::WHITELIST, W_LOG_ADDR + previous - W_RECORD_SIZE + 2, window);
+        }
+
+        if (!update_window(W_NO_RECORD, offset, &window))
+        {
+            // More windows than the table holds: refuse the card rather than drop its schedule
+            uint8_t uid[MAX_UID_LENGTH];
+            uint8_t len = read_record(offset, uid);
+            memmove(&sorted[i], &sorted[i + 1], (record_count - i - 1) * sizeof(sorted[0]));
+            record_count--;
+            set_hash -= uid_hash(uid, len);
+        }
+    }
+}
+
+void WhiteListManager::import_legacy()
+{
+    int index = 0;
+    uint8_t uid[MAX_UID_LENGTH];
+
+    for (int i = 0; i < W_LEGACY_SIZE; ++i)
+    {
+        uint8_t len = storage->read_byte(Partition::LEGACY_WHITELIST, index);
+        if (len == 0xFF || len == 0 || len > MAX_UID_LENGTH)
             break;
 
         for (size_t j = 0; j < len; ++j)
+            uid[j] = storage->read_byte(Partition::LEGACY_WHITELIST, index + 1 + j);
+        save_to_eeprom(uid, len);
+
+        index += 1 + len;
+    }
+}
+
+// Padding after the payload is left as is, so a record costs 2 + length byte writes
+void WhiteListManager::write_record(uint16_t offset, uint8_t type, const uint8_t *data, size_t length)
+{
+    storage->write_byte(Partition::WHITELIST, W_LOG_ADDR + offset, type);
+    storage->write_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 1, length);
+    for (size_t j = 0; j < length; ++j)
+        storage->write_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 2 + j, data[j]);
+}
+
+// Writes a record at log_end, after its window record if it has one, and commits both by advancing
+// log_end once; a torn write is never replayed
+bool WhiteListManager::append_record(uint8_t type, const uint8_t *data, size_t length, const access_window *window)
+{
+    uint16_t size = window ? 2 * W_RECORD_SIZE : W_RECORD_SIZE;
+    if (header.log_end + size > W_LOG_SIZE)
+        compact_all();
+    if (header.log_end + size > W_LOG_SIZE)
+        return false;
+
+    if (window)
+        write_record(header.log_end, W_RECORD_WINDOW, (const uint8_t *)window, sizeof(*window));
+    write_record(header.log_end + size - W_RECORD_SIZE, type, data, length);
+
+    header.log_end += size;
+    commit_header();
+    return true;
+}
+
+void WhiteListManager::start_compaction()
+{
+    compacting = true;
+    pass_end = header.log_end;
+}
+
+// Moves up to `records` live records from gap_end down to gap_start. Both cursors are committed
+// together after the copy, so a power loss leaves the record either moved or still in place. Until the first dead record is found
+// the gap is empty and the cursors only advance in RAM. Tombstones appended after the pass started
+// may cancel a record already moved, so they are moved too and dropped by the next pass.
+// Returns true once the pass is complete.
+bool WhiteListManager::compact_step(uint8_t records)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+
+    for (uint8_t n = 0; n < records && header.gap_end < header.log_end; ++n)
+    {
+        uint8_t type = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + header.gap_end);
+        uint8_t len = read_record(header.gap_end, uid);
+        bool valid = len > 0 && len <= MAX_UID_LENGTH;
+        bool empty_gap = header.gap_start == header.gap_end;
+
+        bool keep = false;
+        int pos = -1;
+        if ((type == W_RECORD_LIVE || type == W_RECORD_SCHEDULED) && valid)
         {
-            uint8_t read_byte = EEPROM.read(index + 1 + j);
-            // Check if the UID matches and if matches delete it
-            if (j < length && read_byte == uid[j])
+            pos = search(uid, len, keep);
+            keep = keep && sorted[pos] == header.gap_end;
+        }
+        else if (type == W_RECORD_WINDOW && len == sizeof(access_window))
+        {
+            // Kept while the UID record after it is current; the two are moved in order
+            uint16_t next = header.gap_end + W_RECORD_SIZE;
+            uint8_t next_uid[MAX_UID_LENGTH];
+            if (next < header.log_end && storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + next) == W_RECORD_SCHEDULED)
             {
-                EEPROM.write(index, 0);
-                for (size_t k = 0; k < len; ++k)
-                    EEPROM.write(index + 1 + k, 0);
-                return;
+                uint8_t next_len = read_record(next, next_uid);
+                int next_pos = search(next_uid, next_len, keep);
+                keep = keep && sorted[next_pos] == next;
             }
         }
+        else if (type == W_RECORD_TOMBSTONE && valid)
+        {
+            keep = header.gap_end >= pass_end;
+        }
+        else if (type == W_RECORD_VERSION && len == sizeof(version))
+        {
+            keep = header.gap_end == version_offset;
+        }
 
-        index += 1 + len;
+        if (keep && empty_gap)
+        {
+            header.gap_start += W_RECORD_SIZE;
+            header.gap_end += W_RECORD_SIZE;
+            continue;
+        }
+
+        if (keep)
+        {
+            // The gap is a whole number of records, so the copy never overlaps its source
+            write_record(header.gap_start, type, uid, len);
+
+            if (type == W_RECORD_LIVE || type == W_RECORD_SCHEDULED)
+            {
+                int slot = type == W_RECORD_SCHEDULED ? find_window(header.gap_end) : -1;
+                if (slot >= 0)
+                    windows[slot].offset = header.gap_start;
+                sorted[pos] = header.gap_start;
+                if (syncing)
+                {
+                    set_mark(header.gap_start, get_mark(header.gap_end));
+                    set_mark(header.gap_end, false);
+                }
+            }
+            else if (type == W_RECORD_VERSION)
+            {
+                version_offset = header.gap_start;
+            }
+            header.gap_start += W_RECORD_SIZE;
+        }
+        else if (dead_bytes >= W_RECORD_SIZE)
+        {
+            dead_bytes -= W_RECORD_SIZE;
+        }
+
+        header.gap_end += W_RECORD_SIZE;
+        commit_header();
     }
+
+    if (header.gap_end < header.log_end)
+        return false;
+
+    finish_compaction();
+    return true;
+}
+
+// Truncates the log to the compacted prefix and closes the gap in one commit
+void WhiteListManager::finish_compaction()
+{
+    if (header.gap_start != header.gap_end)
+        header.log_end = header.gap_start;
+    else
+        dead_bytes = 0; // nothing was reclaimable, so stop the estimate from retriggering passes
+
+    header.gap_start = 0;
+    header.gap_end = 0;
+    commit_header();
+
+    compacting = false;
+    stats.compactions++;
 }
+
+void WhiteListManager::compact_all()
+{
+    if (!compacting)
+        start_compaction();
+    while (!compact_step(W_COMPACT_RECORDS))
+        ;
+}
+
+// Double hashing: bit i = h1 + i * h2, with FNV-1a as h1 and a rotated copy as h2
+static void bloom_hashes(const uint8_t *uid, size_t length, uint32_t &h1, uint32_t &h2)
+{
+    h1 = uid_hash(uid, length);
+    h2 = ((h1 >> 16) | (h1 << 16)) | 1;
+}
+
+void WhiteListManager::bloom_add(const uint8_t *uid, size_t length)
+{
+    uint32_t h1, h2;
+    bloom_hashes(uid, length, h1, h2);
+
+    for (int i = 0; i < W_BLOOM_HASHES; ++i)
+    {
+        uint32_t bit = (h1 + i * h2) % W_BLOOM_BITS;
+        bloom[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+bool WhiteListManager::bloom_test(const uint8_t *uid, size_t length) const
+{
+    uint32_t h1, h2;
+    bloom_hashes(uid, length, h1, h2);
+
+    for (int i = 0; i < W_BLOOM_HASHES; ++i)
+    {
+        uint32_t bit = (h1 + i * h2) % W_BLOOM_BITS;
+        if (!(bloom[bit / 8] & (1 << (bit % 8))))
+            return false;
+    }
+    return true;
+}
+
+// Reads the UID of a record and returns its length
+uint8_t WhiteListManager::read_record(uint16_t offset, uint8_t *uid) const
+{
+    uint8_t len = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 1);
+    for (size_t j = 0; j < len && j < MAX_UID_LENGTH; ++j)
+        uid[j] = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 2 + j);
+    return len;
+}
+
+// Orders records by length, then bytes; returns the sign of stored - key
+int WhiteListManager::compare_record(uint16_t offset, const uint8_t *uid, size_t length) const
+{
+    uint8_t len = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 1);
+    if (len != length)
+        return len < length ? -1 : 1;
+
+    for (size_t j = 0; j < length; ++j)
+    {
+        uint8_t b = storage->read_byte(Partition::WHITELIST, W_LOG_ADDR + offset + 2 + j);
+        if (b != uid[j])
+            return b < uid[j] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Binary search over the sorted records; returns the match or the insertion position
+int WhiteListManager::search(const uint8_t *uid, size_t length, bool &found)
+{
+    int low = 0, high = record_count;
+    found = false;
+
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        int cmp = compare_record(sorted[mid], uid, length);
+        stats.storage_probes++;
+
+        if (cmp == 0)
+        {
+            found = true;
+            return mid;
+        }
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+void WhiteListManager::set_mode_registration()
+{
+    mode = WhiteListMode::REGISTRATION;
+}
+
+// Stores the card for update() and returns the access decision, looked up once per card
+bool WhiteListManager::set_uid(uint8_t *uid, size_t length)
+{
+    if (length > MAX_UID_LENGTH)
+        return false;
+    memcpy(uid_buffer, uid, length);
+    uid_length = length;
+    uid_whitelisted = is_whitelisted(uid_buffer, uid_length);
+    new_uid_received = true;
+
+    if (scheduler)
+        scheduler->notify(task_id);
+
+    return uid_whitelisted;
+}
+
+void WhiteListManager::register_tasks(Scheduler &scheduler)
+{
+    this->scheduler = &scheduler;
+    task_id = scheduler.add_event("whitelist", TASK_HIGH, [this]()
+                                  { update(); });
+    scheduler.add_periodic("compaction", W_COMPACT_INTERVAL, TASK_LOW, [this]()
+                           {
+                               if (!compacting && dead_bytes > 0 && header.log_end >= W_COMPACT_THRESHOLD)
+                                   start_compaction();
+                               if (compacting)
+                                   compact_step(W_COMPACT_RECORDS);
+                           });
+}
+
+void WhiteListManager::delete_uid(uint8_t *uid, size_t length)
+{
+    bool found;
+    int pos = search(uid, length, found);
+    if (!found)
+        return;
+
+    // The tombstone is appended first; the Bloom bits stay and only cost a probe
+    if (!append_record(W_RECORD_TOMBSTONE, uid, length))
+        return;
+    dead_bytes += 2 * W_RECORD_SIZE;
+    update_window(sorted[pos], W_NO_RECORD, nullptr);
+
+    memmove(&sorted[pos], &sorted[pos + 1], (record_count - pos - 1) * sizeof(sorted[0]));
+    record_count--;
+    set_hash -= uid_hash(uid, length);
+}
+
 void WhiteListManager::update()
 {
     if (!new_uid_received)
@@ -59,19 +503,15 @@ void WhiteListManager::update()
     switch (mode)
     {
     case WhiteListMode::AUTHENTICATION:
-        if (is_whitelisted(uid_buffer, uid_length))
-        {
-            mqtt->publish("device/uid/authenticated", "true");
-        }
-        else
-        {
-            mqtt->publish("device/uid/authenticated", "false");
-        }
-
+        if (journal)
+            journal->append(uid_hash(uid_buffer, uid_length), uid_whitelisted, last_reason);
         break;
     case WhiteListMode::REGISTRATION:
         awating_response = true;
-        if (is_whitelisted(uid_buffer, uid_length))
+        // A scheduled card outside its window is still listed and keeps its window
+        bool listed;
+        search(uid_buffer, uid_length, listed);
+        if (listed)
         {
             mode = WhiteListMode::AUTHENTICATION;
             awating_response = false;
@@ -80,6 +520,8 @@ void WhiteListManager::update()
         {
             save_to_eeprom(uid_buffer, uid_length);
             publish_uid_for_registration();
+            if (journal)
+                journal->append(uid_hash(uid_buffer, uid_length), false, AccessReason::REGISTRATION);
             mode = WhiteListMode::AUTHENTICATION;
             awating_response = false;
         }
@@ -89,57 +531,352 @@ void WhiteListManager::update()
     new_uid_received = false;
 }
 
-void WhiteListManager::save_to_eeprom(uint8_t *uid, size_t length)
+// Adds a UID, or rewrites a listed one whose window changed. Returns false if the entry could not be
+// stored as requested.
+bool WhiteListManager::save_to_eeprom(const uint8_t *uid, size_t length, const access_window *window)
 {
-    int index = W_EEPROM_ADDR;
-    for (int i = 0; i < MAX_WHITELIST_SIZE; ++i)
+    if (length == 0 || length > MAX_UID_LENGTH)
+        return false;
+
+    bool found;
+    int pos = search(uid, length, found);
+    if (!found && record_count >= MAX_WHITELIST_SIZE)
+        return false;
+
+    int slot = found ? find_window(sorted[pos]) : -1;
+    if (found && (slot >= 0) == (window != nullptr) &&
+        (!window || memcmp(&windows[slot].window, window, sizeof(*window)) == 0))
+        return true;
+    if (window && slot < 0 && window_count >= W_MAX_WINDOWS)
+        return false;
+
+    // Compaction only rewrites offsets, so pos stays valid if it has to run to make room
+    if (!append_record(window ? W_RECORD_SCHEDULED : W_RECORD_LIVE, uid, length, window))
+        return false;
+    uint16_t offset = header.log_end - W_RECORD_SIZE;
+    update_window(found ? sorted[pos] : W_NO_RECORD, offset, window);
+
+    if (found)
     {
-        uint8_t len = EEPROM.read(index);
-        if (len == 0xFF || len == 0)
-        {
-            EEPROM.write(index, length);
-            for (size_t j = 0; j < length; j++)
-                EEPROM.write(index + 1 + j, uid[j]);
-            return;
-        }
-        index += 1 + len;
+        dead_bytes += W_RECORD_SIZE;
+        sorted[pos] = offset;
+        return true;
     }
+
+    bloom_add(uid, length);
+    set_hash += uid_hash(uid, length);
+
+    memmove(&sorted[pos + 1], &sorted[pos], (record_count - pos) * sizeof(sorted[0]));
+    sorted[pos] = offset;
+    record_count++;
+    return true;
 }
 
-bool WhiteListManager::is_whitelisted(uint8_t *uid, size_t length)
+int WhiteListManager::find_window(uint16_t offset) const
 {
-    Serial.print("Checking whitelist for UID: ");
-    for (size_t i = 0; i < length; ++i)
+    for (uint8_t i = 0; i < window_count; ++i)
+    {
+        if (windows[i].offset == offset)
+            return i;
+    }
+    return -1;
+}
+
+// Moves the window of an entry from its old record to its new one, adding or dropping it as needed.
+// Returns false if a window has to be added and the table is full.
+bool WhiteListManager::update_window(uint16_t old_offset, uint16_t offset, const access_window *window)
+{
+    int slot = old_offset == W_NO_RECORD ? -1 : find_window(old_offset);
+    if (slot >= 0)
+        dead_bytes += W_RECORD_SIZE; // the superseded window record
+
+    if (!window)
     {
-        Serial.print(uid[i], HEX);
-        Serial.print(" ");
+        if (slot >= 0)
+            windows[slot] = windows[--window_count];
+        return true;
     }
-    Serial.println();
-    int index = W_EEPROM_ADDR;
 
-    for (int i = 0; i < MAX_WHITELIST_SIZE; ++i)
+    if (slot < 0)
     {
-        uint8_t len = EEPROM.read(index);
-        if (len == 0xFF || len == 0)
-            break;
+        if (window_count >= W_MAX_WINDOWS)
+            return false;
+        slot = window_count++;
+    }
+    windows[slot].offset = offset;
+    windows[slot].window = *window;
+    return true;
+}
 
-        bool match = (len == length);
-        for (size_t j = 0; j < len; ++j)
+// Fails closed: without a synced clock a scheduled card is refused
+bool WhiteListManager::window_allows(const access_window &window) const
+{
+    if (!clock || !clock->is_synced())
+        return false;
+
+    uint32_t now = clock->now();
+    uint32_t day = now / W_SECONDS_PER_DAY;
+    if (day < window.start_day || day > window.end_day)
+        return false;
+
+    uint8_t weekday = (day + 4) % 7; // 1970-01-01 was a Thursday
+    uint8_t hour = (now / 3600) % 24;
+    return (window.weekdays & (1 << weekday)) && (window.hours[hour / 8] & (1 << (hour % 8)));
+}
+
+// Appends a version record; the previous one becomes garbage for the next compaction
+void WhiteListManager::set_version(uint32_t value)
+{
+    if (!append_record(W_RECORD_VERSION, (const uint8_t *)&value, sizeof(value)))
+        return;
+
+    if (version_offset != W_NO_RECORD)
+        dead_bytes += W_RECORD_SIZE;
+    version = value;
+    version_offset = header.log_end - W_RECORD_SIZE;
+}
+
+void WhiteListManager::set_mark(uint16_t offset, bool value)
+{
+    uint16_t record = offset / W_RECORD_SIZE;
+    if (value)
+        sync_marks[record / 8] |= 1 << (record % 8);
+    else
+        sync_marks[record / 8] &= ~(1 << (record % 8));
+}
+
+bool WhiteListManager::get_mark(uint16_t offset) const
+{
+    uint16_t record = offset / W_RECORD_SIZE;
+    return sync_marks[record / 8] & (1 << (record % 8));
+}
+
+// Revokes entries without a sync mark until at most `limit` remain. Walks down so removals never
+// shift the entries still to be checked.
+void WhiteListManager::drop_unconfirmed(uint16_t limit)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+
+    for (int i = record_count - 1; i >= 0 && record_count > limit; --i)
+    {
+        if (get_mark(sorted[i]))
+            continue;
+        uint8_t len = read_record(sorted[i], uid);
+        delete_uid(uid, len);
+    }
+}
+
+// State shared by the entry callbacks of one snapshot or delta
+struct whitelist_sync
+{
+    WhiteListManager *manager;
+    const transporter_WhitelistDelta *delta; // nullptr for a snapshot
+};
+
+struct sync_uid
+{
+    uint8_t value[MAX_UID_LENGTH];
+    size_t length;
+};
+
+// Converts epoch bounds to whole days, rounding inwards so a partial day is never granted.
+// Zero bounds and empty bitmaps mean no restriction.
+static void to_access_window(const transporter_AccessWindow &in, access_window &out)
+{
+    uint32_t first = in.start / W_SECONDS_PER_DAY + (in.start % W_SECONDS_PER_DAY != 0);
+    uint32_t end = in.end ? in.end / W_SECONDS_PER_DAY : 0x10000; // first day no longer valid
+    uint32_t hours = in.hours ? in.hours : 0xFFFFFF;
+
+    if (first >= end)
+    {
+        out.start_day = 0xFFFF; // empty window
+        out.end_day = 0;
+    }
+    else
+    {
+        out.start_day = first;
+        out.end_day = end - 1;
+    }
+    out.weekdays = in.weekdays ? in.weekdays & 0x7F : 0x7F;
+    out.hours[0] = hours;
+    out.hours[1] = hours >> 8;
+    out.hours[2] = hours >> 16;
+}
+
+static bool decode_uid_value(pb_istream_t *stream, const pb_field_t *field, void **arg)
+{
+    sync_uid *uid = (sync_uid *)*arg;
+
+    // Oversized UIDs are skipped; a zero length tells the caller to ignore the entry
+    if (stream->bytes_left > MAX_UID_LENGTH)
+        return pb_read(stream, NULL, stream->bytes_left);
+
+    uid->length = stream->bytes_left;
+    return pb_read(stream, uid->value, uid->length);
+}
+
+// Applies one UID of a snapshot or delta as it is decoded, so the message never has to fit in RAM.
+// Delta entries are only applied if base_version, encoded before them, matches the stored version.
+bool WhiteListManager::decode_sync_entry(pb_istream_t *stream, const pb_field_t *field, void **arg)
+{
+    whitelist_sync *sync = (whitelist_sync *)*arg;
+    WhiteListManager *self = sync->manager;
+
+    sync_uid uid = {{0}, 0};
+    bool removal = sync->delta && field->tag == transporter_WhitelistDelta_removed_tag;
+    access_window window;
+    const access_window *window_arg = nullptr;
+
+    if (removal)
+    {
+        transporter_UID message = transporter_UID_init_zero;
+        message.value.funcs.decode = decode_uid_value;
+        message.value.arg = &uid;
+        if (!pb_decode(stream, transporter_UID_fields, &message))
+            return false;
+    }
+    else
+    {
+        transporter_WhitelistEntry entry = transporter_WhitelistEntry_init_zero;
+        entry.uid.funcs.decode = decode_uid_value;
+        entry.uid.arg = &uid;
+        if (!pb_decode(stream, transporter_WhitelistEntry_fields, &entry))
+            return false;
+        if (entry.has_window)
         {
-            uint8_t read_byte = EEPROM.read(index + 1 + j);
-            if (j < length && read_byte != uid[j])
-                match = false;
+            to_access_window(entry.window, window);
+            window_arg = &window;
         }
+    }
+    if (uid.length == 0)
+        return true;
 
-        if (match)
+    if (!sync->delta)
+    {
+        // Snapshot: store or update the entry and mark its record as confirmed. A full list makes room
+        // by revoking an entry the snapshot has not confirmed yet; if it is listed later it comes back.
+        bool found;
+        self->search(uid.value, uid.length, found);
+        if (!found)
+            self->drop_unconfirmed(MAX_WHITELIST_SIZE - 1);
+        if (self->save_to_eeprom(uid.value, uid.length, window_arg))
         {
-            return true;
+            int pos = self->search(uid.value, uid.length, found);
+            self->set_mark(self->sorted[pos], true);
         }
+    }
+    else if (sync->delta->base_version == self->version)
+    {
+        // An entry whose window cannot be stored is revoked rather than left with the wrong access
+        if (removal || !self->save_to_eeprom(uid.value, uid.length, window_arg))
+            self->delete_uid(uid.value, uid.length);
+    }
 
-        index += 1 + len;
+    return true;
+}
+
+// Replaces the whitelist with the UIDs of a snapshot: listed UIDs are added or kept, the rest revoked.
+// Unchanged entries cost no writes.
+bool WhiteListManager::apply_snapshot(pb_istream_t *stream)
+{
+    transporter_WhitelistSnapshot snapshot = transporter_WhitelistSnapshot_init_zero;
+    whitelist_sync sync = {this, nullptr};
+    snapshot.entries.funcs.decode = decode_sync_entry;
+    snapshot.entries.arg = &sync;
+
+    memset(sync_marks, 0, sizeof(sync_marks));
+    syncing = true;
+
+    bool decoded = pb_decode(stream, transporter_WhitelistSnapshot_fields, &snapshot);
+    if (decoded)
+    {
+        drop_unconfirmed(0);
+        set_version(snapshot.version);
+    }
+
+    // An incomplete snapshot keeps the old version, so the backend retries
+    syncing = false;
+    publish_status();
+    return decoded;
+}
+
+// Applies the changes between base_version and version. A delta for another base is ignored and
+// the status published again, which tells the backend what to send instead.
+bool WhiteListManager::apply_delta(pb_istream_t *stream)
+{
+    transporter_WhitelistDelta delta = transporter_WhitelistDelta_init_zero;
+    whitelist_sync sync = {this, &delta};
+    delta.added.funcs.decode = decode_sync_entry;
+    delta.added.arg = &sync;
+    delta.removed.funcs.decode = decode_sync_entry;
+    delta.removed.arg = &sync;
+
+    bool decoded = pb_decode(stream, transporter_WhitelistDelta_fields, &delta);
+    if (decoded && delta.base_version == version && delta.version != version)
+        set_version(delta.version);
+
+    publish_status();
+    return decoded;
+}
+
+bool WhiteListManager::is_whitelisted(uint8_t *uid, size_t length)
+{
+    unsigned long start = micros();
+    bool found = false;
+
+    if (bloom_test(uid, length))
+    {
+        int pos = search(uid, length, found);
+        int slot = found ? find_window(sorted[pos]) : -1;
+        if (slot >= 0 && !window_allows(windows[slot].window))
+        {
+            found = false;
+            stats.window_rejects++;
+            last_reason = clock && clock->is_synced() ? AccessReason::OUTSIDE_WINDOW : AccessReason::CLOCK_UNSYNCED;
+        }
+        else
+        {
+            last_reason = found ? AccessReason::LISTED : AccessReason::NOT_LISTED;
+        }
+    }
+    else
+    {
+        stats.bloom_rejects++;
+        last_reason = AccessReason::NOT_LISTED;
+    }
+
+    stats.lookups++;
+    if (found)
+        stats.hits++;
+    stats.last_lookup_us = micros() - start;
+    if (stats.last_lookup_us > stats.max_lookup_us)
+        stats.max_lookup_us = stats.last_lookup_us;
+
+    return found;
+}
+
+// Reports the version, set hash and size; sent on connect and after every sync so the backend can
+// answer with the missing delta, or a snapshot if the hash shows the device diverged
+void WhiteListManager::publish_status()
+{
+    String topic = "arduino/" + device_uid + "/rfid";
+    uint8_t buffer[transporter_WhitelistStatus_size + 2];
+
+    transporter_RfidEnvelope rfidEnvelope = transporter_RfidEnvelope_init_zero;
+    rfidEnvelope.which_payload = transporter_RfidEnvelope_whitelist_status_tag;
+    rfidEnvelope.payload.whitelist_status.version = version;
+    rfidEnvelope.payload.whitelist_status.hash = set_hash;
+    rfidEnvelope.payload.whitelist_status.count = record_count;
+
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+    if (!pb_encode(&stream, transporter_RfidEnvelope_fields, &rfidEnvelope))
+    {
+        Serial.print("Failed to encode whitelist status: ");
+        Serial.println(PB_GET_ERROR(&stream));
+        return;
     }
 
-    return false;
+    mqtt->publish(topic.c_str(), buffer, stream.bytes_written, PublishPriority::URGENT);
 }
 
 void WhiteListManager::publish_uid_for_registration()
@@ -176,5 +913,5 @@ void WhiteListManager::publish_uid_for_registration()
     Serial.print(stream.bytes_written);
     Serial.println(" bytes)");
 
-    mqtt->publish(topic.c_str(), buffer, stream.bytes_written);
+    mqtt->publish(topic.c_str(), buffer, stream.bytes_written, PublishPriority::URGENT);
 }
\ No newline at end of file
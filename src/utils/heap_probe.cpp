@@ -0,0 +1,82 @@
+#include <utils/heap_probe.h>
+
+#if defined(SHAAS_PROFILE) || defined(SHAAS_NATIVE)
+
+static uint32_t allocations = 0;
+
+// Linked in place of the C library allocators by -Wl,--wrap; each forwards to the real one
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *pointer, size_t size);
+
+    void *__wrap_malloc(size_t size)
+    {
+        allocations++;
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        allocations++;
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *pointer, size_t size)
+    {
+        allocations++;
+        return __real_realloc(pointer, size);
+    }
+}
+
+#ifdef SHAAS_NATIVE
+// The host's operator new lives in the shared C++ runtime, out of reach of --wrap; route it through
+// the wrapped malloc as the board's runtime does
+void *operator new(size_t size)
+{
+    void *pointer = malloc(size ? size : 1);
+    if (!pointer)
+        abort();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+#endif
+
+uint32_t heap_allocations()
+{
+    return allocations;
+}
+
+#else
+
+uint32_t heap_allocations()
+{
+    return 0;
+}
+
+#endif
@@ -3,6 +3,30 @@
 #include <pb_decode.h> // Include the header defining pb_istream_t
 #include <transporter.pb.h>
 
+static bool client_read_callback(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+    Client *client = (Client *)stream->state;
+
+    // A read past the end of the packet can never complete; bytes still in flight are waited for by
+    // the client's own timed read
+    if ((size_t)client->available() < count)
+        return false;
+
+    return client->read(buf, count) == (int)count;
+}
+
+pb_istream_t pb_istream_from_client(Client &client, size_t length)
+{
+    pb_istream_t stream;
+    stream.callback = &client_read_callback;
+    stream.state = &client;
+    stream.bytes_left = length;
+#ifndef PB_NO_ERRMSG
+    stream.errmsg = NULL;
+#endif
+    return stream;
+}
+
 bool encode_string(pb_ostream_t *stream, const pb_field_t *field, void *const *arg)
 {
     const char *str = (const char *)(*arg);
@@ -45,8 +69,6 @@ bool decode_uid_bytes(pb_istream_t *stream, const pb_field_t *field, void **arg)
     // Get the shared data structure
     CallbackSharedData *shared_data = (CallbackSharedData *)*arg;
 
-    uint32_t uid[MAX_UID_LENGTH];
-
     // Calculate maximum buffer size
     size_t len = stream->bytes_left;
     if (len > MAX_UID_LENGTH)
@@ -54,27 +76,16 @@ bool decode_uid_bytes(pb_istream_t *stream, const pb_field_t *field, void **arg)
         len = MAX_UID_LENGTH;
     }
 
-    // Read directly into our buffer
-    if (!pb_read(stream, (pb_byte_t *)uid, len))
+    // Read directly into the caller's buffer
+    if (!pb_read(stream, shared_data->uid_buffer, len))
     {
         Serial.println("Failed to read UID bytes");
         return false;
     }
 
-    // Update the length
     shared_data->uid_length = len;
     shared_data->has_uid = (len > 0);
 
-    // Debug output
-    shared_data->uid_buffer = (uint8_t *)malloc(len);
-    if (shared_data->uid_buffer == nullptr)
-    {
-        Serial.println("Failed to allocate memory for UID buffer");
-        return false;
-    }
-    memcpy(shared_data->uid_buffer, uid, len);
-    shared_data->uid_length = len;
-
     return true;
 }
 
@@ -101,8 +112,15 @@ bool msg_callback(pb_istream_t *stream, const pb_field_t *field, void **arg)
         return true;
 
     case transporter_RfidEnvelope_register_response_tag:
+    case transporter_RfidEnvelope_whitelist_status_tag:
         return true;
 
+    case transporter_RfidEnvelope_whitelist_snapshot_tag:
+        return shared_data->whitelist && shared_data->whitelist->apply_snapshot(stream);
+
+    case transporter_RfidEnvelope_whitelist_delta_tag:
+        return shared_data->whitelist && shared_data->whitelist->apply_delta(stream);
+
     case transporter_RfidEnvelope_revoke_request_tag:
         revoke_req.uid.value.funcs.decode = decode_uid_bytes;
         revoke_req.uid.value.arg = shared_data;
@@ -0,0 +1,162 @@
+/**
+ * @file bench_board.h
+ * @brief The board the native suites boot the firmware on: its wiring, its stored configuration and
+ *        a helper that brings SystemMonitor up to READY.
+ */
+
+#ifndef BENCH_BOARD_H
+#define BENCH_BOARD_H
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <services/system_monitor.h>
+
+#define BENCH_START_EPOCH 1760054400UL // 2025-10-10 00:00:00 UTC
+
+#define MUX_SIGNAL_PIN 3
+#define PIR_CHANNEL 1
+#define LDR_PIN A1
+
+static const uint8_t MUX_SELECT[] = {10, 5, 8, 9}; // S0..S3, as wired by SystemMonitor
+
+static const uint8_t RESIDENT_UID[] = {0xDE, 0xAD, 0xBE, 0xEF};
+static const uint8_t VISITOR_UID[] = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+
+static bool occupied = false; ///< Level of the PIR behind the multiplexer
+
+/**
+ * @brief digitalRead() of the bench: the PIR sits behind the multiplexer, every other pin reads its
+ *        own level.
+ */
+static int read_pin(uint8_t pin)
+{
+    if (pin != MUX_SIGNAL_PIN)
+        return sim::get_digital(pin);
+
+    uint8_t channel = 0;
+    for (uint8_t i = 0; i < sizeof(MUX_SELECT); i++)
+    {
+        if (sim::get_digital(MUX_SELECT[i]) == HIGH)
+            channel |= 1 << i;
+    }
+    return channel == PIR_CHANNEL && occupied ? HIGH : LOW;
+}
+
+/**
+ * @brief Erases the EEPROM and provisions the bench device: network config, one climate module, one
+ *        LDR, one PIR driving a relay, a temperature rule and the resident card.
+ */
+static void provision_board()
+{
+    sim::eeprom_erase();
+
+    StorageManager storage;
+    storage.begin();
+
+    ConfigManager network;
+    network.begin(&storage);
+    network.save("{\"device_uid\":\"bench\",\"wifi\":{\"ssid\":\"home\",\"password\":\"secret\"},"
+                 "\"mqtt\":{\"broker\":\"10.0.0.2\",\"port\":1883,\"topic\":\"arduino\","
+                 "\"username\":\"bench\",\"password\":\"secret\"}}");
+
+    // Whitelist as left by the firmware before the log; imported on the first boot
+    storage.write_byte(Partition::LEGACY_WHITELIST, 0, sizeof(RESIDENT_UID));
+    for (uint8_t i = 0; i < sizeof(RESIDENT_UID); i++)
+        storage.write_byte(Partition::LEGACY_WHITELIST, 1 + i, RESIDENT_UID[i]);
+    storage.write_byte(Partition::LEGACY_WHITELIST, 1 + sizeof(RESIDENT_UID), 0);
+
+    ConfigEngine modules;
+    modules.init(&storage);
+
+    climate c = {0};
+    c.id = 1;
+    c.dht22_port = 0;
+    c.aqi_port = 0;
+    c.temperature_deadband = 5; // 0.5 °C
+    c.humidity_deadband = 20;   // 2 %
+    c.aqi_deadband = 10;
+    c.max_silent_s = 900;
+    modules.set_climate_config(c);
+
+    ldr l = {0};
+    l.id = 1;
+    l.port = LDR_PIN;
+    l.deadband = 20;
+    l.max_silent_s = 900;
+    modules.set_ldr_config(l);
+
+    motion m = {0};
+    m.id = 1;
+    m.port = PIR_CHANNEL;
+    m.relay_port = 1;
+    m.relay_type = LOW_DUTY;
+    m.local_automation = true;
+    m.debounce_ms = 200;
+    m.hold_s = 120;
+    m.heartbeat_s = 600;
+    modules.set_motion_config(m);
+
+    rule r = {0};
+    r.id = 1;
+    r.sensor = transporter_RuleSensor_TEMPERATURE;
+    r.sensor_id = 1;
+    r.comparator = transporter_RuleComparator_ABOVE;
+    r.action = transporter_RuleAction_PUBLISH;
+    r.threshold = 26.0f;
+    r.hysteresis = 1.0f;
+    modules.set_rule_config(r);
+
+    modules.save_config();
+}
+
+/**
+ * @brief Encodes a message and queues it on the broker for the device.
+ */
+template <typename T>
+static void inject(const char *topic, const pb_msgdesc_t *fields, const T &message)
+{
+    uint8_t buffer[256];
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(pb_encode(&stream, fields, &message));
+    TEST_ASSERT_TRUE(sim::inject_message(topic, buffer, stream.bytes_written));
+}
+
+/**
+ * @brief Powers the board up on the stored configuration with WiFi in range and initializes the
+ *        monitor. The broker can be left unreachable.
+ */
+static void power_on(SystemMonitor &monitor, bool broker_online = true)
+{
+    sim::broker_reset();
+    sim::set_wifi(true);
+    sim::set_broker(broker_online);
+    sim::set_network_time(BENCH_START_EPOCH);
+    sim::set_digital_reader(read_pin);
+    monitor.init();
+}
+
+/**
+ * @brief Powers the board up and runs the monitor until it is ready.
+ */
+static void start_board(SystemMonitor &monitor)
+{
+    power_on(monitor);
+    while (monitor.get_state() != SystemState::READY)
+    {
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+/**
+ * @brief Provisions the board and starts the monitor on it.
+ */
+static void boot_board(SystemMonitor &monitor)
+{
+    provision_board();
+    start_board(monitor);
+}
+
+#endif // BENCH_BOARD_H
@@ -0,0 +1,65 @@
+/**
+ * @file test_main.cpp
+ * @brief Checks that an AuthMetrics report is split into parts that fit a queued MQTT message.
+ */
+
+#include "../bench_board.h"
+
+static SystemMonitor monitor;
+
+static void run_for(unsigned long ms)
+{
+    unsigned long start = millis();
+    while (millis() - start < ms)
+    {
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_report_is_split_into_queued_parts()
+{
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+
+    sim::present_card(RESIDENT_UID, sizeof(RESIDENT_UID));
+    run_for(2000);
+    sim::remove_card();
+    run_for(AUTH_METRICS_INTERVAL + 1000);
+    sim::set_serial_echo(true);
+
+    const sim::topic_stats *metrics = sim::find_topic("arduino/bench/metrics");
+    TEST_ASSERT_NOT_NULL(metrics);
+
+    uint8_t per_part = sizeof(transporter_AuthMetrics::stages) / sizeof(transporter_LatencyHistogram);
+    TEST_ASSERT_EQUAL_UINT32(((uint8_t)AuthStage::COUNT + per_part - 1) / per_part, metrics->messages);
+    TEST_ASSERT_LESS_OR_EQUAL(MQTT_MAX_PAYLOAD_LENGTH, metrics->last_length);
+}
+
+void test_empty_window_publishes_nothing()
+{
+    uint32_t sent = sim::find_topic("arduino/bench/metrics")->messages;
+
+    sim::set_serial_echo(false);
+    run_for(AUTH_METRICS_INTERVAL + 1000);
+    sim::set_serial_echo(true);
+
+    TEST_ASSERT_EQUAL_UINT32(sent, sim::find_topic("arduino/bench/metrics")->messages);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_report_is_split_into_queued_parts);
+    RUN_TEST(test_empty_window_publishes_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_main.cpp
+ * @brief What keeps running while the broker is unreachable: access decisions from power-up on,
+ *        whose journal is uploaded once the broker is back, and local motion automation with its
+ *        relay timeout.
+ */
+
+#include "../bench_board.h"
+
+static SystemMonitor monitor;
+
+// Runs the main loop for a stretch of simulated time
+static void run_for(unsigned long ms)
+{
+    unsigned long start = millis();
+    while (millis() - start < ms)
+    {
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+// Closes the session and keeps the broker away until the monitor has noticed
+static void take_broker_down()
+{
+    sim::set_broker(false);
+    sim::drop_sessions();
+    run_for(1000);
+    TEST_ASSERT_TRUE(monitor.get_state() == SystemState::CONNECT_MQTT);
+}
+
+void setUp()
+{
+    sim::set_serial_echo(false);
+}
+
+void tearDown()
+{
+    sim::set_serial_echo(true);
+}
+
+// Presents a card long enough for one read, then waits out the unlock, which holds off further reads
+static void tap(const uint8_t *uid, uint8_t size)
+{
+    sim::present_card(uid, size);
+    run_for(300);
+    sim::remove_card();
+    run_for(4000); // past the 3 s unlock timeout of Security
+}
+
+void test_access_events_are_journaled_and_uploaded_after_reconnect()
+{
+    // The broker has never been reachable since power-up
+    provision_board();
+    power_on(monitor, false);
+    run_for(1000);
+    TEST_ASSERT_NOT_NULL(monitor.get_security());
+
+    const AccessJournal &journal = monitor.get_journal();
+    uint32_t decisions = monitor.get_security()->get_stats().decisions;
+    uint32_t appended = journal.get_stats().appended;
+    uint32_t uploaded = journal.get_stats().uploaded;
+    const sim::topic_stats *access = sim::find_topic("arduino/bench/access");
+    uint32_t batches = access ? access->messages : 0;
+
+    tap(RESIDENT_UID, sizeof(RESIDENT_UID));
+    tap(VISITOR_UID, sizeof(VISITOR_UID));
+
+    TEST_ASSERT_TRUE(monitor.get_state() == SystemState::CONNECT_MQTT);
+    TEST_ASSERT_EQUAL_UINT32(decisions + 2, monitor.get_security()->get_stats().decisions);
+    TEST_ASSERT_EQUAL_UINT32(appended + 2, journal.get_stats().appended);
+    TEST_ASSERT_EQUAL_UINT8(2, journal.pending());
+
+    // The retry task uploads the journal on the next session
+    sim::set_broker(true);
+    run_for(3000);
+    access = sim::find_topic("arduino/bench/access");
+    TEST_ASSERT_TRUE(monitor.get_state() == SystemState::READY);
+    TEST_ASSERT_EQUAL_UINT8(0, journal.pending());
+    TEST_ASSERT_EQUAL_UINT32(uploaded + 2, journal.get_stats().uploaded);
+    TEST_ASSERT_NOT_NULL(access);
+    TEST_ASSERT_GREATER_THAN_UINT32(batches, access->messages);
+}
+
+void test_motion_drives_relay_while_broker_is_down()
+{
+    occupied = false;
+    run_for(5000);
+    take_broker_down();
+
+    uint32_t actuations = monitor.get_sensor_manager().get_automation_stats().actuations;
+    uint32_t packets = sim::serial_packets();
+
+    // The PIR edge switches the relay on
+    occupied = true;
+    run_for(2000);
+    TEST_ASSERT_EQUAL_UINT32(actuations + 1, monitor.get_sensor_manager().get_automation_stats().actuations);
+    TEST_ASSERT_GREATER_THAN_UINT32(packets, sim::serial_packets());
+
+    // and the hold time still switches it off
+    occupied = false;
+    run_for(125000UL);
+    TEST_ASSERT_EQUAL_UINT32(actuations + 2, monitor.get_sensor_manager().get_automation_stats().actuations);
+    TEST_ASSERT_TRUE(monitor.get_state() == SystemState::CONNECT_MQTT);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_access_events_are_journaled_and_uploaded_after_reconnect);
+    RUN_TEST(test_motion_drives_relay_while_broker_is_down);
+    return UNITY_END();
+}
@@ -0,0 +1,236 @@
+/**
+ * @file test_main.cpp
+ * @brief Moving the provisioning JSON of the pre-partition layout into the network partition: a
+ *        document that fits is migrated, even across a power cut, and a longer one stays in place.
+ *        The module configuration of that layout is upgraded to the current schema.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <unity.h>
+
+#include <communication/config_manager.h>
+#include <services/config_engine.h>
+
+// Up to 507 characters fitted the old layout: a magic word and a NUL-terminated string in 512 bytes
+#define LEGACY_MAX_LENGTH (partition_size(Partition::NETWORK) - sizeof(uint32_t) - 1)
+
+static char json[LEGACY_MAX_LENGTH + 1];
+static char mqtt_fields[4][LEGACY_MAX_LENGTH / 4 + 1]; // broker, topic, username, password
+
+// Builds a provisioning document of exactly `length` characters; the MQTT strings pad it out
+static const char *provisioning_json(size_t length)
+{
+    const char *format = "{\"device_uid\":\"bench\",\"wifi\":{\"ssid\":\"bench-net\",\"password\":\"secret\"},"
+                         "\"mqtt\":{\"broker\":\"%s\",\"port\":1883,\"topic\":\"%s\",\"username\":\"%s\",\"password\":\"%s\"}}";
+    size_t padding = length - snprintf(nullptr, 0, format, "", "", "", "");
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        size_t n = padding / 4 + (i < padding % 4 ? 1 : 0);
+        memset(mqtt_fields[i], 'a' + i, n);
+        mqtt_fields[i][n] = '\0';
+    }
+    int written = snprintf(json, sizeof(json), format, mqtt_fields[0], mqtt_fields[1], mqtt_fields[2], mqtt_fields[3]);
+    TEST_ASSERT_TRUE_MESSAGE(written >= 0 && (size_t)written == length, "provisioning document does not fit json");
+    return json;
+}
+
+static void write_legacy(const char *text)
+{
+    sim::eeprom_erase();
+    EEPROM.put(0, (uint32_t)CONFIG_MAGIC);
+    size_t length = strlen(text);
+    for (size_t i = 0; i <= length; i++)
+        EEPROM.write(sizeof(uint32_t) + i, text[i]);
+}
+
+static bool legacy_intact(const char *text)
+{
+    uint32_t magic = 0;
+    EEPROM.get(0, magic);
+    if (magic != CONFIG_MAGIC)
+        return false;
+
+    size_t length = strlen(text);
+    for (size_t i = 0; i <= length; i++)
+    {
+        if (EEPROM.read(sizeof(uint32_t) + i) != (uint8_t)text[i])
+            return false;
+    }
+    return true;
+}
+
+// A boot: fresh managers over whatever reached the flash
+static bool boot_load(Config &config, bool &migrated)
+{
+    StorageManager storage;
+    ConfigManager manager;
+    storage.begin();
+    manager.begin(&storage);
+
+    bool loaded = manager.load(config);
+    uint8_t version;
+    migrated = storage.stored_version(Partition::NETWORK, version);
+    return loaded;
+}
+
+// Checks a loaded config against the document provisioning_json() built last
+static void assert_provisioned(const Config &config)
+{
+    TEST_ASSERT_EQUAL_STRING("bench", config.device_uid.c_str());
+    TEST_ASSERT_EQUAL_STRING("bench-net", config.wifi.ssid.c_str());
+    TEST_ASSERT_EQUAL_STRING(mqtt_fields[0], config.mqtt.broker.c_str());
+    TEST_ASSERT_EQUAL(1883, config.mqtt.port);
+    TEST_ASSERT_EQUAL_STRING(mqtt_fields[1], config.mqtt.topic.c_str());
+    TEST_ASSERT_EQUAL_STRING(mqtt_fields[2], config.mqtt.username.c_str());
+    TEST_ASSERT_EQUAL_STRING(mqtt_fields[3], config.mqtt.password.c_str());
+}
+
+void setUp()
+{
+    sim::set_serial_echo(false);
+}
+
+void tearDown()
+{
+    sim::eeprom_fail_after(-1);
+    sim::set_serial_echo(true);
+}
+
+void test_fitting_legacy_config_is_migrated()
+{
+    const char *text = provisioning_json(partition_capacity(Partition::NETWORK));
+    TEST_ASSERT_EQUAL(partition_capacity(Partition::NETWORK), strlen(text));
+    write_legacy(text);
+
+    Config config;
+    bool migrated;
+    TEST_ASSERT_TRUE(boot_load(config, migrated));
+    TEST_ASSERT_TRUE(migrated);
+    assert_provisioned(config);
+
+    // The next boot reads the partition
+    Config reloaded;
+    TEST_ASSERT_TRUE(boot_load(reloaded, migrated));
+    assert_provisioned(reloaded);
+}
+
+void test_long_legacy_config_stays_in_place()
+{
+    const char *text = provisioning_json(LEGACY_MAX_LENGTH);
+    TEST_ASSERT_EQUAL(LEGACY_MAX_LENGTH, strlen(text));
+    write_legacy(text);
+
+    for (uint8_t boot = 0; boot < 2; boot++)
+    {
+        Config config;
+        bool migrated;
+        TEST_ASSERT_TRUE(boot_load(config, migrated));
+        TEST_ASSERT_FALSE(migrated);
+        assert_provisioned(config);
+        TEST_ASSERT_TRUE(legacy_intact(text));
+    }
+}
+
+void test_power_cut_during_migration_keeps_legacy_config()
+{
+    const char *text = provisioning_json(partition_capacity(Partition::NETWORK));
+
+    for (long cut = 0;; cut++)
+    {
+        write_legacy(text);
+        sim::eeprom_fail_after(cut);
+        Config config;
+        bool migrated;
+        boot_load(config, migrated);
+        bool complete = !sim::eeprom_failed();
+        sim::eeprom_fail_after(-1);
+
+        Config reloaded;
+        TEST_ASSERT_TRUE(boot_load(reloaded, migrated));
+        assert_provisioned(reloaded);
+        if (complete)
+            break;
+    }
+}
+
+void test_oversize_document_is_not_saved()
+{
+    sim::eeprom_erase();
+    StorageManager storage;
+    ConfigManager manager;
+    storage.begin();
+    manager.begin(&storage);
+
+    TEST_ASSERT_TRUE(manager.save(provisioning_json(partition_capacity(Partition::NETWORK))));
+    TEST_ASSERT_FALSE(manager.save(provisioning_json(partition_capacity(Partition::NETWORK) + 1)));
+
+    provisioning_json(partition_capacity(Partition::NETWORK));
+    Config config;
+    TEST_ASSERT_TRUE(manager.load(config));
+    assert_provisioned(config);
+}
+
+// Module configuration as the pre-partition firmware wrote it raw: version 1, one climate module
+// with a buzzer, one LDR and two PIRs, the second driving relay 3
+static const uint8_t MODULES_V1[] = {
+    1, 36, 1, 1, 2, 1,                              // version, size, climate, LDR, motion and relay counts
+    7, 0, 1, true, 2, 0, 0, 0, 0, 0,                // climates: id, DHT22, AQI, buzzer, buzzer port
+    9, 17, 0, 0,                                    // LDRs: id, port
+    4, 3, 0, 0, 5, 4, 3, 1, 0, 0, 0, 0, 0, 0, 0, 0, // motions: id, port, relay port, relay type
+};
+
+void test_baseline_module_config_is_upgraded()
+{
+    sim::eeprom_erase();
+    StorageManager storage;
+    storage.begin();
+    for (uint8_t i = 0; i < sizeof(MODULES_V1); i++)
+        storage.write_byte(Partition::MODULES, i, MODULES_V1[i]);
+
+    ConfigEngine engine;
+    TEST_ASSERT_TRUE(engine.init(&storage));
+    TEST_ASSERT_EQUAL_UINT8(1, engine.get_stats().migrated_from);
+
+    for (uint8_t boot = 0; boot < 2; boot++)
+    {
+        ConfigEngine reloaded;
+        TEST_ASSERT_TRUE(reloaded.init(&storage));
+        TEST_ASSERT_EQUAL_UINT8(0, reloaded.get_stats().migrated_from);
+
+        config_data *config = reloaded.get_configs();
+        TEST_ASSERT_EQUAL_UINT8(CONFIG_VERSION, config->version);
+        TEST_ASSERT_EQUAL_UINT8(1, config->climate_size);
+        TEST_ASSERT_EQUAL_UINT8(1, config->ldr_size);
+        TEST_ASSERT_EQUAL_UINT8(2, config->motion_size);
+        TEST_ASSERT_EQUAL_UINT8(1, config->relay_size);
+        TEST_ASSERT_EQUAL_UINT8(0, config->rule_size);
+
+        climate c = reloaded.get_climate_config(7);
+        TEST_ASSERT_EQUAL_UINT8(1, c.aqi_port);
+        TEST_ASSERT_TRUE(c.has_buzzer);
+        TEST_ASSERT_EQUAL_UINT8(2, c.buzzer_port);
+        TEST_ASSERT_EQUAL_UINT16(0, c.temperature_deadband);
+        TEST_ASSERT_EQUAL_UINT8(17, reloaded.get_ldr_config(9).port);
+
+        motion m = reloaded.get_motion_config(5);
+        TEST_ASSERT_EQUAL_UINT8(4, m.port);
+        TEST_ASSERT_EQUAL_UINT8(3, m.relay_port);
+        TEST_ASSERT_EQUAL_UINT8(1, m.relay_type);
+        TEST_ASSERT_FALSE(m.local_automation);
+        TEST_ASSERT_EQUAL_UINT16(0, m.hold_s);
+        TEST_ASSERT_EQUAL_UINT8(3, reloaded.get_motion_config(4).port);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fitting_legacy_config_is_migrated);
+    RUN_TEST(test_long_legacy_config_stays_in_place);
+    RUN_TEST(test_power_cut_during_migration_keeps_legacy_config);
+    RUN_TEST(test_oversize_document_is_not_saved);
+    RUN_TEST(test_baseline_module_config_is_upgraded);
+    return UNITY_END();
+}
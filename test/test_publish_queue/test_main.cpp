@@ -0,0 +1,144 @@
+/**
+ * @file test_main.cpp
+ * @brief Outbound queue: the overflow policy of each lane, FIFO order across the wrap of a lane's
+ *        buffer, and the RAM the queue takes.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <communication/publish_queue.h>
+
+static PublishQueue queue;
+
+// A payload whose bytes identify message i
+static uint16_t fill(uint16_t i, uint8_t *payload, uint16_t length)
+{
+    for (uint16_t b = 0; b < length; b++)
+        payload[b] = (uint8_t)(i + b);
+    return length;
+}
+
+static bool push(uint16_t i, uint16_t length, PublishPriority priority)
+{
+    uint8_t payload[MQTT_MAX_PAYLOAD_LENGTH + 1];
+    char topic[24];
+    snprintf(topic, sizeof(topic), "arduino/bench/%u", i);
+    return queue.enqueue(topic, payload, fill(i, payload, length), priority);
+}
+
+// Pops the front message and checks that it is message i
+static void expect(uint16_t i, uint16_t length)
+{
+    uint8_t payload[MQTT_MAX_PAYLOAD_LENGTH + 1];
+    char topic[24];
+    snprintf(topic, sizeof(topic), "arduino/bench/%u", i);
+    fill(i, payload, length);
+
+    TEST_ASSERT_FALSE(queue.empty());
+    QueuedMessage message = queue.front();
+    TEST_ASSERT_EQUAL_STRING(topic, message.topic);
+    TEST_ASSERT_EQUAL_UINT16(length, message.length);
+    TEST_ASSERT_EQUAL_MEMORY(payload, message.payload, length);
+    queue.pop();
+}
+
+static void drain()
+{
+    while (!queue.empty())
+        queue.pop();
+}
+
+void setUp()
+{
+    drain();
+    queue.set_policy(PublishPriority::URGENT, OverflowPolicy::REJECT_NEW);
+    queue.set_policy(PublishPriority::TELEMETRY, OverflowPolicy::DROP_OLDEST);
+}
+
+void tearDown() {}
+
+void test_full_urgent_lane_keeps_its_oldest_messages()
+{
+    uint32_t dropped = queue.get_stats().dropped;
+    uint16_t accepted = 0;
+    while (push(accepted, 100, PublishPriority::URGENT))
+        accepted++;
+
+    TEST_ASSERT_GREATER_THAN_UINT16(0, accepted);
+    TEST_ASSERT_EQUAL_UINT32(dropped + 1, queue.get_stats().dropped);
+    for (uint16_t i = 0; i < accepted; i++)
+        expect(i, 100);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_full_telemetry_lane_drops_its_oldest_messages()
+{
+    uint16_t total = 40;
+    for (uint16_t i = 0; i < total; i++)
+        TEST_ASSERT_TRUE(push(i, 100, PublishPriority::TELEMETRY));
+
+    // The newest messages survive, in order
+    uint16_t kept = queue.size();
+    TEST_ASSERT_LESS_THAN_UINT16(total, kept);
+    for (uint16_t i = total - kept; i < total; i++)
+        expect(i, 100);
+
+    // and the urgent lane can be switched to the same policy
+    queue.set_policy(PublishPriority::URGENT, OverflowPolicy::DROP_OLDEST);
+    for (uint16_t i = 0; i < total; i++)
+        TEST_ASSERT_TRUE(push(i, 100, PublishPriority::URGENT));
+    kept = queue.size();
+    for (uint16_t i = total - kept; i < total; i++)
+        expect(i, 100);
+}
+
+void test_messages_stay_in_order_across_the_wrap()
+{
+    // Uneven sizes make records end at every offset of the buffer, and the queue never drains fully
+    uint16_t next = 0, expected = 0;
+    for (uint16_t round = 0; round < 2000; round++)
+    {
+        uint16_t length = (next * 37) % (MQTT_MAX_PAYLOAD_LENGTH + 1);
+        if (push(next, length, PublishPriority::URGENT))
+            next++;
+        if (queue.size() > 2 || round % 3 == 0)
+        {
+            if (!queue.empty())
+            {
+                expect(expected, (expected * 37) % (MQTT_MAX_PAYLOAD_LENGTH + 1));
+                expected++;
+            }
+        }
+    }
+    while (expected < next)
+    {
+        expect(expected, (expected * 37) % (MQTT_MAX_PAYLOAD_LENGTH + 1));
+        expected++;
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_GREATER_THAN_UINT16(1000, next);
+}
+
+void test_urgent_lane_is_sent_first_and_oversize_is_refused()
+{
+    TEST_ASSERT_TRUE(push(1, 10, PublishPriority::TELEMETRY));
+    TEST_ASSERT_TRUE(push(2, 10, PublishPriority::URGENT));
+    TEST_ASSERT_FALSE(push(3, MQTT_MAX_PAYLOAD_LENGTH + 1, PublishPriority::URGENT));
+    expect(2, 10);
+    expect(1, 10);
+
+    Serial.print("publish queue: ");
+    Serial.print(sizeof(PublishQueue));
+    Serial.println(" bytes of RAM");
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_full_urgent_lane_keeps_its_oldest_messages);
+    RUN_TEST(test_full_telemetry_lane_drops_its_oldest_messages);
+    RUN_TEST(test_messages_stay_in_order_across_the_wrap);
+    RUN_TEST(test_urgent_lane_is_sent_first_and_oversize_is_refused);
+    return UNITY_END();
+}
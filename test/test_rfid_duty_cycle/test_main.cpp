@@ -0,0 +1,127 @@
+/**
+ * @file test_main.cpp
+ * @brief Duty cycle of the card reader on the simulated SPI transport: polled against IRQ detection.
+ *
+ * The MFRC522 model charges every register access and every card answer in simulated time, and a
+ * handshake that nobody answers waits for the reader's timeout, as on the board. read_card() is
+ * called at Security's poll interval; busy_us over the elapsed time is the reader's share of the loop.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <modules/rfid.h>
+
+#define IRQ_PIN 6
+#define POLL_MS 20
+#define IDLE_MS 60000UL
+
+static const uint8_t CARD_UID[] = {0xDE, 0xAD, 0xBE, 0xEF};
+
+struct duty
+{
+    uint32_t spi_transfers;
+    unsigned long busy_us;
+    unsigned long elapsed_ms;
+};
+
+static duty polled = {0};
+static duty irq = {0};
+
+static duty run_idle(RFID &reader, unsigned long ms)
+{
+    uint32_t transfers = sim::spi_transfers();
+    unsigned long busy = reader.get_stats().busy_us;
+    unsigned long start = millis();
+
+    while (millis() - start < ms)
+    {
+        reader.read_card();
+        delay(POLL_MS);
+    }
+
+    return {sim::spi_transfers() - transfers, reader.get_stats().busy_us - busy, millis() - start};
+}
+
+static void print_duty(const char *name, const duty &d)
+{
+    Serial.print(name);
+    Serial.print(": spi_per_s=");
+    Serial.print(d.spi_transfers * 1000.0 / d.elapsed_ms);
+    Serial.print(" busy_permille=");
+    Serial.println(d.busy_us / d.elapsed_ms);
+}
+
+void setUp()
+{
+    sim::remove_card();
+}
+
+void tearDown()
+{
+}
+
+void test_polling_backs_off_when_idle()
+{
+    sim::set_rfid_irq_pin(-1);
+    RFID reader;
+    TEST_ASSERT_TRUE(reader.init(-1));
+    TEST_ASSERT_EQUAL(RfidDetection::POLLING, reader.get_detection());
+
+    polled = run_idle(reader, IDLE_MS);
+    print_duty("polling", polled);
+
+    TEST_ASSERT_EQUAL_UINT32(RFID_POLL_MAX_MS, reader.get_poll_interval());
+    TEST_ASSERT_GREATER_THAN_UINT32(0, reader.get_stats().skipped);
+}
+
+void test_irq_detection_costs_less_than_polling()
+{
+    sim::set_rfid_irq_pin(IRQ_PIN);
+    RFID reader;
+    TEST_ASSERT_TRUE(reader.init(IRQ_PIN));
+    TEST_ASSERT_EQUAL(RfidDetection::IRQ, reader.get_detection());
+
+    irq = run_idle(reader, IDLE_MS);
+    print_duty("irq", irq);
+
+    TEST_ASSERT_EQUAL_UINT32(0, reader.get_stats().interrupts);
+    TEST_ASSERT_LESS_THAN_UINT32(polled.spi_transfers, irq.spi_transfers);
+    TEST_ASSERT_LESS_THAN(polled.busy_us, irq.busy_us);
+}
+
+void test_irq_detection_reads_a_card_once()
+{
+    sim::set_rfid_irq_pin(IRQ_PIN);
+    RFID reader;
+    reader.init(IRQ_PIN);
+    run_idle(reader, 1000);
+
+    sim::present_card(CARD_UID, sizeof(CARD_UID));
+
+    bool read = false;
+    unsigned long start = millis();
+    while (!read && millis() - start < 1000)
+    {
+        read = reader.read_card();
+        if (!read)
+            delay(POLL_MS);
+    }
+
+    TEST_ASSERT_TRUE(read);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(CARD_UID), reader.get_uid_length());
+    TEST_ASSERT_EQUAL_MEMORY(CARD_UID, reader.get_uid(), sizeof(CARD_UID));
+
+    // The halted card stays in the field; the frames of the read must not count as another answer
+    run_idle(reader, 1000);
+    TEST_ASSERT_EQUAL_UINT32(1, reader.get_stats().interrupts);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_polling_backs_off_when_idle);
+    RUN_TEST(test_irq_detection_costs_less_than_polling);
+    RUN_TEST(test_irq_detection_reads_a_card_once);
+    return UNITY_END();
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_main.cpp
+ * @brief Loop-latency benchmark: runs the firmware through a scripted day on the native shim.
+ *
+ * The EEPROM is provisioned with a network config, one climate module, one LDR, one PIR driving a
+ * relay, a temperature rule and a resident card. The script then follows a day of temperature and
+ * light, occupancy in the morning and evening, three card presentations and a few MQTT commands,
+ * while the main loop idles through delay() exactly as on the board. The scheduler report printed at
+ * the end gives the run time, jitter and CPU share of every task over the day.
+ */
+
+#include "../bench_board.h"
+
+#define DAY_MS 86400000UL
+
+static SystemMonitor monitor;
+static unsigned long day_start = 0;
+static unsigned long loop_iterations = 0;
+static unsigned long longest_update_us = 0;
+
+// --- Day script ---
+
+static bool between(unsigned long t, unsigned long from_min, unsigned long to_min)
+{
+    return t >= from_min * 60000UL && t < to_min * 60000UL;
+}
+
+// Applies the inputs for the time of day; each event fires on the first loop past its minute
+static void script(unsigned long t)
+{
+    static unsigned long last_minute = (unsigned long)-1;
+    unsigned long minute = t / 60000UL;
+
+    occupied = between(t, 6 * 60 + 30, 8 * 60) || between(t, 17 * 60 + 45, 23 * 60);
+
+    if (minute == last_minute)
+        return;
+    last_minute = minute;
+
+    // Temperature peaks mid-afternoon, light follows the sun with the lights on in the evening
+    float hour = minute / 60.0f;
+    float temperature = 21.0f + 6.0f * sinf((hour - 9.0f) * (float)M_PI / 12.0f);
+    sim::set_climate(temperature, 45.0f - (temperature - 21.0f));
+
+    int light = hour > 6.0f && hour < 19.0f ? (int)(900 * sinf((hour - 6.0f) * (float)M_PI / 13.0f)) : 0;
+    if (occupied && light < 300)
+        light = 300;
+    sim::set_analog(LDR_PIN, light);
+    sim::set_analog(A0, 120 + (int)(hour * 3));
+
+    switch (minute)
+    {
+    case 7 * 60 + 30:
+    case 18 * 60:
+        sim::present_card(RESIDENT_UID, sizeof(RESIDENT_UID));
+        break;
+    case 12 * 60:
+        sim::present_card(VISITOR_UID, sizeof(VISITOR_UID));
+        break;
+    case 7 * 60 + 31:
+    case 12 * 60 + 1:
+    case 18 * 60 + 1:
+        sim::remove_card();
+        break;
+    case 9 * 60:
+    case 21 * 60:
+    {
+        transporter_RelayState relay = transporter_RelayState_init_zero;
+        relay.type = transporter_RelayType_LOW_DUTY;
+        relay.port = 2;
+        relay.state = minute == 9 * 60 ? transporter_RelayStateType_ON : transporter_RelayStateType_OFF;
+        inject("arduino/bench/relay", transporter_RelayState_fields, relay);
+        break;
+    }
+    case 14 * 60:
+    {
+        transporter_ConfigTopic config = transporter_ConfigTopic_init_zero;
+        config.which_payload = transporter_ConfigTopic_ldr_tag;
+        config.payload.ldr.id = 1;
+        config.payload.ldr.port = LDR_PIN;
+        config.payload.ldr.deadband = 50;
+        config.payload.ldr.max_silent_s = 1800;
+        inject("arduino/bench/config", transporter_ConfigTopic_fields, config);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// --- Tests ---
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_day_runs_every_task()
+{
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+    day_start = millis();
+
+    for (unsigned long t = 0; t < DAY_MS; t = millis() - day_start)
+    {
+        script(t);
+
+        unsigned long start = micros();
+        unsigned long idle = monitor.update();
+        unsigned long spent = micros() - start;
+        if (spent > longest_update_us)
+            longest_update_us = spent;
+        loop_iterations++;
+
+        if (idle > 0)
+            delay(idle);
+    }
+
+    sim::set_serial_echo(true);
+
+    Scheduler &scheduler = monitor.get_scheduler();
+    Serial.println();
+    scheduler.report(Serial, DAY_MS);
+    Serial.print("loop: iterations=");
+    Serial.print(loop_iterations);
+    Serial.print(" longest_update_us=");
+    Serial.println(longest_update_us);
+    Serial.print("io: publishes=");
+    Serial.print(sim::published_messages());
+    Serial.print(" bytes=");
+    Serial.print(sim::published_bytes());
+    Serial.print(" spi_transfers=");
+    Serial.print(sim::spi_transfers());
+    Serial.print(" serial_packets=");
+    Serial.print(sim::serial_packets());
+    Serial.print(" eeprom_writes=");
+    Serial.println(sim::eeprom_writes());
+
+    TEST_ASSERT_GREATER_THAN(0, scheduler.size());
+    for (uint8_t i = 0; i < scheduler.size(); i++)
+    {
+        TEST_ASSERT_GREATER_THAN_UINT32(0, scheduler.get_stats(i)->runs);
+    }
+}
+
+void test_day_decides_every_card()
+{
+    const Security *security = monitor.get_security();
+    TEST_ASSERT_NOT_NULL(security);
+    TEST_ASSERT_EQUAL_UINT32(3, security->get_stats().decisions);
+    TEST_ASSERT_EQUAL_UINT32(2, security->get_stats().granted);
+    TEST_ASSERT_NOT_NULL(sim::find_topic("arduino/bench/access"));
+}
+
+void test_day_publishes_readings()
+{
+    TEST_ASSERT_NOT_NULL(sim::find_topic("arduino/bench/climate"));
+    TEST_ASSERT_NOT_NULL(sim::find_topic("arduino/bench/ldr"));
+    TEST_ASSERT_NOT_NULL(sim::find_topic("arduino/bench/rule"));
+    TEST_ASSERT_EQUAL_UINT32(3, monitor.get_rx_stats().messages);
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.get_rx_stats().unrouted);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_day_runs_every_task);
+    RUN_TEST(test_day_decides_every_card);
+    RUN_TEST(test_day_publishes_readings);
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_main.cpp
+ * @brief Checks that the firmware does not touch the heap once its tasks run.
+ *
+ * The native build wraps malloc, calloc and realloc like the profile build, and routes operator new
+ * through them, so heap_allocations() counts every allocation. After boot the scheduler runs for a
+ * while with cards, motion and changing readings, and the count must not move. The only exception
+ * is a received MQTT message: ArduinoMqttClient hands out its topic as a String.
+ */
+
+#include "../bench_board.h"
+
+#define TICKS 60000 // a little over one AuthMetrics period, so every periodic task comes due
+
+static SystemMonitor monitor;
+
+// Runs the main loop for a number of scheduler ticks, varying the inputs as it goes
+static void run_ticks(unsigned long ticks)
+{
+    for (unsigned long i = 0; i < ticks; i++)
+    {
+        unsigned long phase = i % 5000;
+        occupied = phase < 1500;
+        sim::set_climate(20.0f + (i % 7), 40.0f + (i % 11));
+        sim::set_analog(LDR_PIN, (int)(i % 1000));
+
+        bool resident = (i / 5000) % 2 == 0;
+        if (phase == 1000)
+            sim::present_card(resident ? RESIDENT_UID : VISITOR_UID, resident ? sizeof(RESIDENT_UID) : sizeof(VISITOR_UID));
+        else if (phase == 1200)
+            sim::remove_card();
+
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_heap_probe_counts_on_native()
+{
+    uint32_t before = heap_allocations();
+    String grown("heap");
+    grown += " probe";
+    TEST_ASSERT_GREATER_THAN_UINT32(before, heap_allocations());
+}
+
+void test_ticks_do_not_allocate()
+{
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+
+    Scheduler &scheduler = monitor.get_scheduler();
+    scheduler.reset_stats();
+    uint32_t before = heap_allocations();
+    unsigned long start = millis();
+
+    run_ticks(TICKS);
+
+    sim::set_serial_echo(true);
+    scheduler.report(Serial, millis() - start);
+
+    TEST_ASSERT_EQUAL_UINT32(before, heap_allocations());
+    for (uint8_t i = 0; i < scheduler.size(); i++)
+    {
+        TEST_ASSERT_GREATER_THAN_UINT32(0, scheduler.get_stats(i)->runs);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, scheduler.get_stats(i)->allocations, scheduler.get_name(i));
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, monitor.get_security()->get_stats().decisions);
+}
+
+void test_received_message_allocates_only_its_topic()
+{
+    transporter_RelayState relay = transporter_RelayState_init_zero;
+    relay.type = transporter_RelayType_LOW_DUTY;
+    relay.port = 2;
+    relay.state = transporter_RelayStateType_ON;
+    inject("arduino/bench/relay", transporter_RelayState_fields, relay);
+
+    uint32_t before = heap_allocations();
+    uint32_t received = monitor.get_rx_stats().messages;
+    sim::set_serial_echo(false);
+    run_ticks(100);
+    sim::set_serial_echo(true);
+
+    TEST_ASSERT_EQUAL_UINT32(received + 1, monitor.get_rx_stats().messages);
+    TEST_ASSERT_EQUAL_UINT32(before + 1, heap_allocations());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_heap_probe_counts_on_native);
+    RUN_TEST(test_ticks_do_not_allocate);
+    RUN_TEST(test_received_message_allocates_only_its_topic);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+/**
+ * @file test_main.cpp
+ * @brief Heap and time per inbound MQTT message: the payload is decoded from the client while it
+ *        arrives, against the old approach of collecting it into a String first.
+ */
+
+#include "../bench_board.h"
+
+#define ARRIVAL_BYTES_PER_MS 8
+
+static SystemMonitor monitor;
+
+/**
+ * @brief Client serving a fixed payload that arrives at a given rate, like an MqttClient on a slow
+ *        TCP connection: available() counts the bytes left in the message and read() waits for
+ *        those in flight.
+ */
+class TrickleClient : public Client
+{
+    const uint8_t *data;
+    size_t length;
+    size_t position = 0;
+    unsigned long start;
+    uint32_t bytes_per_ms;
+
+    size_t arrived() const
+    {
+        size_t n = (millis() - start + 1) * bytes_per_ms;
+        return n < length ? n : length;
+    }
+
+public:
+    TrickleClient(const uint8_t *data, size_t length, uint32_t bytes_per_ms)
+        : data(data), length(length), start(millis()), bytes_per_ms(bytes_per_ms)
+    {
+    }
+
+    int available() override { return length - position; }
+    int read() override
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int peek() override { return arrived() > position ? data[position] : -1; }
+    int read(uint8_t *buffer, size_t size) override
+    {
+        size = min((size_t)available(), size);
+        while (arrived() < position + size)
+            delay(1);
+        memcpy(buffer, data + position, size);
+        position += size;
+        return size;
+    }
+    size_t write(uint8_t) override { return 0; }
+    int connect(const char *, uint16_t) override { return 1; }
+    uint8_t connected() override { return 1; }
+};
+
+// Encodes every module the board profile holds, the largest config message the device accepts
+static bool encode_climates(pb_ostream_t *stream, const pb_field_t *field, void *const *arg)
+{
+    for (uint8_t i = 0; i < MAX_CLIMATE; i++)
+    {
+        transporter_Climate c = transporter_Climate_init_zero;
+        c.id = i + 1;
+        c.dht22_port = i;
+        c.temperature_deadband = 5;
+        c.humidity_deadband = 20;
+        c.max_silent_s = 900;
+        if (!pb_encode_tag_for_field(stream, field) || !pb_encode_submessage(stream, transporter_Climate_fields, &c))
+            return false;
+    }
+    return true;
+}
+
+static bool encode_ldrs(pb_ostream_t *stream, const pb_field_t *field, void *const *arg)
+{
+    for (uint8_t i = 0; i < MAX_LDR; i++)
+    {
+        transporter_LDR l = transporter_LDR_init_zero;
+        l.id = i + 1;
+        l.port = A1 + i;
+        l.deadband = 20;
+        if (!pb_encode_tag_for_field(stream, field) || !pb_encode_submessage(stream, transporter_LDR_fields, &l))
+            return false;
+    }
+    return true;
+}
+
+static bool encode_motions(pb_ostream_t *stream, const pb_field_t *field, void *const *arg)
+{
+    for (uint8_t i = 0; i < MAX_MOTION; i++)
+    {
+        transporter_Motion m = transporter_Motion_init_zero;
+        m.id = i + 1;
+        m.port = PIR_CHANNEL + i;
+        m.relay_port = i;
+        m.relay_type = transporter_RelayType_LOW_DUTY;
+        m.hold_s = 120;
+        if (!pb_encode_tag_for_field(stream, field) || !pb_encode_submessage(stream, transporter_Motion_fields, &m))
+            return false;
+    }
+    return true;
+}
+
+static size_t encode_full_config(uint8_t *buffer, size_t size)
+{
+    transporter_ConfigTopic config = transporter_ConfigTopic_init_zero;
+    config.which_payload = transporter_ConfigTopic_full_config_tag;
+    config.payload.full_config.climates.funcs.encode = encode_climates;
+    config.payload.full_config.ldrs.funcs.encode = encode_ldrs;
+    config.payload.full_config.motions.funcs.encode = encode_motions;
+
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer, size);
+    TEST_ASSERT_TRUE(pb_encode(&stream, transporter_ConfigTopic_fields, &config));
+    return stream.bytes_written;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_stream_waits_for_late_bytes()
+{
+    uint8_t payload[200];
+    for (size_t i = 0; i < sizeof(payload); i++)
+        payload[i] = i;
+
+    TrickleClient client(payload, sizeof(payload), 1);
+    pb_istream_t stream = pb_istream_from_client(client, sizeof(payload));
+
+    uint8_t out[sizeof(payload)];
+    TEST_ASSERT_TRUE(pb_read(&stream, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(payload, out, sizeof(payload));
+}
+
+void test_stream_fails_at_once_past_the_message()
+{
+    uint8_t payload[16] = {0};
+    TrickleClient client(payload, sizeof(payload), 1);
+    pb_istream_t stream = pb_istream_from_client(client, sizeof(payload) + 1);
+
+    uint8_t out[sizeof(payload) + 1];
+    unsigned long start = millis();
+    TEST_ASSERT_FALSE(pb_read(&stream, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT32(0, millis() - start);
+}
+
+void test_streamed_config_heap_and_time()
+{
+    uint8_t payload[512];
+    size_t length = encode_full_config(payload, sizeof(payload));
+
+    // Before: the payload collected one char at a time into a String, then decoded from it
+    TrickleClient client(payload, length, ARRIVAL_BYTES_PER_MS);
+    uint32_t allocations = heap_allocations();
+    unsigned long start = micros();
+    String collected;
+    while (collected.length() < length)
+    {
+        int c = client.read();
+        if (c < 0)
+            delay(1);
+        else
+            collected += (char)c;
+    }
+    unsigned long concat_us = micros() - start;
+    uint32_t concat_allocations = heap_allocations() - allocations;
+
+    // After: the device decodes while the bytes arrive
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+    TEST_ASSERT_TRUE(sim::inject_message("arduino/bench/config", payload, length, ARRIVAL_BYTES_PER_MS));
+
+    allocations = heap_allocations();
+    uint32_t received = monitor.get_rx_stats().messages;
+    while (monitor.get_rx_stats().messages == received)
+    {
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+    uint32_t streamed_allocations = heap_allocations() - allocations;
+    sim::set_serial_echo(true);
+
+    Serial.print("payload_bytes=");
+    Serial.println((unsigned long)length);
+    Serial.print("string_concat: allocations=");
+    Serial.print(concat_allocations);
+    Serial.print(" peak_heap_bytes>=");
+    Serial.print((unsigned long)length);
+    Serial.print(" us=");
+    Serial.println(concat_us);
+    Serial.print("streamed: allocations=");
+    Serial.print(streamed_allocations);
+    Serial.print(" us=");
+    Serial.println(monitor.get_rx_stats().last_us);
+
+    // Only the topic String; the payload never reaches the heap
+    TEST_ASSERT_EQUAL_UINT32(1, streamed_allocations);
+    TEST_ASSERT_EQUAL_UINT32(length, monitor.get_rx_stats().bytes);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_waits_for_late_bytes);
+    RUN_TEST(test_stream_fails_at_once_past_the_message);
+    RUN_TEST(test_streamed_config_heap_and_time);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_main.cpp
+ * @brief Benchmark of the telemetry modes: bytes on the wire and publishes per minute when every
+ *        reading leaves its deadband, per reading against one TelemetryBatch per sampling window.
+ *
+ * Wire bytes count the payload, the topic with its length prefix and the MQTT fixed header. A last
+ * check covers a climate module with a single zero deadband.
+ */
+
+#include "../bench_board.h"
+
+#define BENCH_MINUTES 30
+
+static SystemMonitor monitor;
+
+static const char *const SENSOR_TOPICS[] = {
+    "arduino/bench/climate",
+    "arduino/bench/ldr",
+    "arduino/bench/relay",
+    "arduino/bench/telemetry",
+};
+
+struct traffic
+{
+    uint32_t publishes;
+    uint32_t wire_bytes;
+};
+
+static traffic sensor_traffic()
+{
+    traffic total = {0, 0};
+    for (const char *topic : SENSOR_TOPICS)
+    {
+        const sim::topic_stats *stats = sim::find_topic(topic);
+        if (!stats)
+            continue;
+
+        uint32_t header = 2 + 2 + strlen(topic); // fixed header, topic length, topic
+        total.publishes += stats->messages;
+        total.wire_bytes += stats->bytes + stats->messages * header;
+    }
+    return total;
+}
+
+// Every sampling window moves the readings past their deadbands; occupancy changes every minute
+static traffic run_minutes(TelemetryMode mode, unsigned long minutes)
+{
+    monitor.get_sensor_manager().set_telemetry_mode(mode);
+    traffic before = sensor_traffic();
+
+    sim::set_serial_echo(false);
+    unsigned long start = millis();
+    while (millis() - start < minutes * 60000UL)
+    {
+        unsigned long window = (millis() - start) / 5000;
+        occupied = (window / 12) % 2 == 0;
+        sim::set_climate(window % 2 ? 22.0f : 20.0f, window % 2 ? 50.0f : 40.0f);
+        sim::set_analog(LDR_PIN, window % 2 ? 700 : 300);
+
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+    sim::set_serial_echo(true);
+
+    traffic after = sensor_traffic();
+    return {after.publishes - before.publishes, after.wire_bytes - before.wire_bytes};
+}
+
+// Runs a monitor's main loop with the readings held where they are
+static void run_steady(SystemMonitor &board, unsigned long ms)
+{
+    unsigned long start = millis();
+    while (millis() - start < ms)
+    {
+        unsigned long idle = board.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+static void print_rate(const char *name, const traffic &t, unsigned long minutes)
+{
+    Serial.print(name);
+    Serial.print(": publishes_per_min=");
+    Serial.print((double)t.publishes / minutes);
+    Serial.print(" bytes_per_min=");
+    Serial.println((double)t.wire_bytes / minutes);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_batched_mode_publishes_less()
+{
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+
+    traffic per_reading = run_minutes(TelemetryMode::PER_READING, BENCH_MINUTES);
+    traffic batched = run_minutes(TelemetryMode::BATCHED, BENCH_MINUTES);
+
+    print_rate("per_reading", per_reading, BENCH_MINUTES);
+    print_rate("batched", batched, BENCH_MINUTES);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, batched.publishes);
+    TEST_ASSERT_LESS_THAN_UINT32(per_reading.publishes, batched.publishes);
+    TEST_ASSERT_NOT_NULL(sim::find_topic("arduino/bench/telemetry"));
+}
+
+void test_zero_deadband_publishes_any_change()
+{
+    sim::set_serial_echo(false);
+    provision_board();
+
+    // Only the temperature deadband is 0; humidity and AQI keep theirs
+    StorageManager storage;
+    storage.begin();
+    ConfigEngine modules;
+    modules.init(&storage);
+    climate c = modules.get_configs()->climates[0];
+    c.temperature_deadband = 0;
+    modules.set_climate_config(c);
+    modules.save_config();
+
+    static SystemMonitor zero_deadband;
+    start_board(zero_deadband);
+    zero_deadband.get_sensor_manager().set_telemetry_mode(TelemetryMode::PER_READING);
+
+    sim::set_climate(20.0f, 40.0f);
+    run_steady(zero_deadband, 15000);
+    uint32_t published = sim::find_topic("arduino/bench/climate")->messages;
+
+    // Unchanged readings stay quiet, while the smallest temperature step is published
+    run_steady(zero_deadband, 15000);
+    uint32_t quiet = sim::find_topic("arduino/bench/climate")->messages;
+    sim::set_climate(20.1f, 40.0f);
+    run_steady(zero_deadband, 10000);
+    sim::set_serial_echo(true);
+
+    TEST_ASSERT_EQUAL_UINT32(published, quiet);
+    TEST_ASSERT_EQUAL_UINT32(published + 1, sim::find_topic("arduino/bench/climate")->messages);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_batched_mode_publishes_less);
+    RUN_TEST(test_zero_deadband_publishes_any_change);
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_main.cpp
+ * @brief Per-message dispatch cost of the topic router against the six String topics it replaced,
+ *        and what SystemMonitor redoes after an MQTT reconnect.
+ */
+
+#include "../bench_board.h"
+
+#define DISPATCH_ROUNDS 100000UL
+
+static SystemMonitor monitor;
+
+static const char *const SUFFIXES[] = {"wifi", "rfid", "config", "config/remove", "relay", "factory_reset"};
+#define SUFFIX_COUNT (sizeof(SUFFIXES) / sizeof(SUFFIXES[0]))
+
+/**
+ * @brief Owner of the benchmark routes; every handler counts its calls.
+ */
+struct Dispatcher
+{
+    uint32_t calls[SUFFIX_COUNT] = {0};
+
+    void on_wifi(pb_istream_t *stream) { calls[0]++; }
+    void on_rfid(pb_istream_t *stream) { calls[1]++; }
+    void on_config(pb_istream_t *stream) { calls[2]++; }
+    void on_config_removal(pb_istream_t *stream) { calls[3]++; }
+    void on_relay(pb_istream_t *stream) { calls[4]++; }
+    void on_factory_reset(pb_istream_t *stream) { calls[5]++; }
+
+    // Dispatch as mqtt_callback_manager did before the router: every topic rebuilt per message and
+    // compared against all six, even after a match
+    void legacy(const String &device_uid, const char *topic, pb_istream_t *stream)
+    {
+        String wifi_config = "arduino/" + device_uid + "/wifi";
+        String rfid_topic = "arduino/" + device_uid + "/rfid";
+        String config_module = "arduino/" + device_uid + "/config";
+        String config_removal = "arduino/" + device_uid + "/config/remove";
+        String relay_state = "arduino/" + device_uid + "/relay";
+        String factory_reset = "arduino/" + device_uid + "/factory_reset";
+        if (strcmp(topic, wifi_config.c_str()) == 0)
+            on_wifi(stream);
+        if (strcmp(topic, rfid_topic.c_str()) == 0)
+            on_rfid(stream);
+        if (strcmp(topic, config_module.c_str()) == 0)
+            on_config(stream);
+        if (strcmp(topic, config_removal.c_str()) == 0)
+            on_config_removal(stream);
+        if (strcmp(topic, relay_state.c_str()) == 0)
+            on_relay(stream);
+        if (strcmp(topic, factory_reset.c_str()) == 0)
+            on_factory_reset(stream);
+    }
+};
+
+// Runs the main loop until a condition holds, for at most a few iterations
+template <typename Condition>
+static void update_until(Condition done)
+{
+    for (uint8_t i = 0; i < 10 && !done(); i++)
+    {
+        unsigned long idle = monitor.update();
+        if (idle > 0)
+            delay(idle);
+    }
+}
+
+static void add_routes(TopicRouter<Dispatcher> &router, Dispatcher &owner, const String &device_uid)
+{
+    router.begin(&owner, device_uid);
+    router.add("wifi", &Dispatcher::on_wifi);
+    router.add("rfid", &Dispatcher::on_rfid);
+    router.add("config", &Dispatcher::on_config);
+    router.add("config/remove", &Dispatcher::on_config_removal);
+    router.add("relay", &Dispatcher::on_relay);
+    router.add("factory_reset", &Dispatcher::on_factory_reset);
+}
+
+static void print_cost(const char *name, unsigned long us, uint32_t allocations)
+{
+    Serial.print(name);
+    Serial.print(": ns_per_message=");
+    Serial.print(us * 1000UL / DISPATCH_ROUNDS);
+    Serial.print(" allocations_per_message=");
+    Serial.println((double)allocations / DISPATCH_ROUNDS);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_dispatch_cost()
+{
+    const String device_uid = "a1b2c3d4e5f6";
+    char topics[SUFFIX_COUNT][ROUTER_MAX_TOPIC_LENGTH];
+    for (uint8_t i = 0; i < SUFFIX_COUNT; i++)
+        snprintf(topics[i], sizeof(topics[i]), "arduino/%s/%s", device_uid.c_str(), SUFFIXES[i]);
+
+    pb_istream_t stream = pb_istream_from_buffer(nullptr, 0);
+
+    Dispatcher before;
+    uint32_t allocations = heap_allocations();
+    unsigned long start = micros();
+    for (unsigned long n = 0; n < DISPATCH_ROUNDS; n++)
+        before.legacy(device_uid, topics[n % SUFFIX_COUNT], &stream);
+    print_cost("string_topics", micros() - start, heap_allocations() - allocations);
+
+    Dispatcher after;
+    TopicRouter<Dispatcher> router;
+    add_routes(router, after, device_uid);
+    allocations = heap_allocations();
+    start = micros();
+    for (unsigned long n = 0; n < DISPATCH_ROUNDS; n++)
+    {
+        int route = router.match(topics[n % SUFFIX_COUNT]);
+        if (route >= 0)
+            router.invoke(route, &stream);
+    }
+    uint32_t router_allocations = heap_allocations() - allocations;
+    print_cost("topic_router", micros() - start, router_allocations);
+
+    TEST_ASSERT_EQUAL_UINT32(0, router_allocations);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(before.calls, after.calls, SUFFIX_COUNT);
+}
+
+void test_routes_follow_device_uid()
+{
+    Dispatcher owner;
+    TopicRouter<Dispatcher> router;
+
+    add_routes(router, owner, "old");
+    add_routes(router, owner, "new");
+
+    TEST_ASSERT_EQUAL_UINT8(SUFFIX_COUNT, router.size());
+    TEST_ASSERT_EQUAL(-1, router.match("arduino/old/relay"));
+    TEST_ASSERT_GREATER_OR_EQUAL(0, router.match("arduino/new/relay"));
+    TEST_ASSERT_EQUAL_STRING("arduino/new/relay", router.topic(router.match("arduino/new/relay")));
+}
+
+void test_reconnect_subscribes_every_route()
+{
+    sim::set_serial_echo(false);
+    boot_board(monitor);
+    uint8_t subscribed = sim::subscriptions();
+    TEST_ASSERT_EQUAL_UINT8(SUFFIX_COUNT, subscribed);
+
+    sim::drop_sessions();
+    update_until([&]()
+                 { return sim::subscriptions() > subscribed; });
+
+    TEST_ASSERT_EQUAL_UINT8(2 * subscribed, sim::subscriptions());
+    for (uint8_t i = 0; i < subscribed; i++)
+        TEST_ASSERT_EQUAL_STRING(sim::subscription(i), sim::subscription(subscribed + i));
+
+    // Messages are still routed on the new session
+    transporter_RelayState relay = transporter_RelayState_init_zero;
+    relay.type = transporter_RelayType_LOW_DUTY;
+    relay.port = 2;
+    relay.state = transporter_RelayStateType_ON;
+    inject("arduino/bench/relay", transporter_RelayState_fields, relay);
+
+    uint32_t received = monitor.get_rx_stats().messages;
+    update_until([&]()
+                 { return monitor.get_rx_stats().messages > received; });
+    sim::set_serial_echo(true);
+
+    TEST_ASSERT_EQUAL_UINT32(received + 1, monitor.get_rx_stats().messages);
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.get_rx_stats().unrouted);
+}
+
+void test_reconnect_keeps_whitelist_index()
+{
+    sim::set_serial_echo(false);
+    sim::present_card(RESIDENT_UID, sizeof(RESIDENT_UID));
+    update_until([&]()
+                 { return monitor.get_whitelist().get_stats().storage_probes > 0; });
+    sim::remove_card();
+
+    // A reload from storage would rebuild the index and restart its counters
+    WhitelistStats before = monitor.get_whitelist().get_stats();
+    uint32_t statuses = sim::find_topic("arduino/bench/rfid")->messages;
+    uint8_t subscribed = sim::subscriptions();
+
+    sim::drop_sessions();
+    update_until([&]()
+                 { return sim::find_topic("arduino/bench/rfid")->messages > statuses; });
+    sim::set_serial_echo(true);
+
+    TEST_ASSERT_EQUAL_UINT32(statuses + 1, sim::find_topic("arduino/bench/rfid")->messages);
+    TEST_ASSERT_EQUAL_UINT8(subscribed + SUFFIX_COUNT, sim::subscriptions());
+    TEST_ASSERT_EQUAL_UINT32(before.storage_probes, monitor.get_whitelist().get_stats().storage_probes);
+    TEST_ASSERT_EQUAL_UINT16(1, monitor.get_whitelist().size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_dispatch_cost);
+    RUN_TEST(test_routes_follow_device_uid);
+    RUN_TEST(test_reconnect_subscribes_every_route);
+    RUN_TEST(test_reconnect_keeps_whitelist_index);
+    return UNITY_END();
+}
@@ -0,0 +1,365 @@
+/**
+ * @file test_main.cpp
+ * @brief Whitelist store: lookup time by list size, reload from storage, format, compaction, and
+ *        recovery from a power cut at any write of a compaction pass.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <communication/mqtt_manager.h>
+#include <services/scheduler.h>
+#include <services/storage_manager.h>
+#include <services/whitelist_manager.h>
+
+#define LOOKUP_ROUNDS 200
+#define UNKNOWN_FIRST 100000UL // cards never added to any list
+#define UNKNOWN_COUNT 1000
+#define FRAGMENTED_ADDED 400
+#define FRAGMENTED_STRIDE 4 // every fourth card of the fragmented list is revoked
+#define SETTLE_MS 30000UL   // long enough for a compaction pass over a full log
+
+static StorageManager storage;
+static MQTTConfig mqtt_config = {"broker", 1883, "", "", ""};
+static MQTTManager mqtt(mqtt_config);
+
+// Card i: the bytes of i * 2654435761 (a bijection), padded to 7 bytes for odd i
+static uint8_t card(uint32_t i, uint8_t *uid)
+{
+    uint32_t x = i * 2654435761UL;
+    uint8_t length = i % 2 ? 7 : 4;
+    for (uint8_t j = 0; j < length; j++)
+        uid[j] = j < 4 ? (uint8_t)(x >> (8 * j)) : (uint8_t)(0xA0 + j);
+    return length;
+}
+
+// Adds a card the way the device does: a tap in registration mode
+static void add(WhiteListManager &whitelist, uint32_t i)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+    uint8_t length = card(i, uid);
+    whitelist.set_mode_registration();
+    whitelist.set_uid(uid, length);
+    whitelist.update();
+}
+
+static void revoke(WhiteListManager &whitelist, uint32_t i)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+    uint8_t length = card(i, uid);
+    whitelist.delete_uid(uid, length);
+}
+
+static bool listed(WhiteListManager &whitelist, uint32_t i)
+{
+    uint8_t uid[MAX_UID_LENGTH];
+    uint8_t length = card(i, uid);
+    return whitelist.is_whitelisted(uid, length);
+}
+
+// A fresh device on erased flash
+static WhiteListManager *boot()
+{
+    WhiteListManager *whitelist = new WhiteListManager();
+    whitelist->init(&storage, &mqtt, "bench");
+    return whitelist;
+}
+
+// A reboot: a new manager replays whatever reached the flash
+static WhiteListManager *reboot(WhiteListManager *whitelist)
+{
+    delete whitelist;
+    return boot();
+}
+
+// Adds FRAGMENTED_ADDED cards and revokes every FRAGMENTED_STRIDE-th, leaving the log past the
+// compaction threshold
+static WhiteListManager *fragmented()
+{
+    sim::eeprom_erase();
+    WhiteListManager *whitelist = boot();
+    for (uint32_t i = 0; i < FRAGMENTED_ADDED; i++)
+        add(*whitelist, i);
+    for (uint32_t i = 0; i < FRAGMENTED_ADDED; i += FRAGMENTED_STRIDE)
+        revoke(*whitelist, i);
+    return whitelist;
+}
+
+static uint16_t fragmented_size()
+{
+    return FRAGMENTED_ADDED - FRAGMENTED_ADDED / FRAGMENTED_STRIDE;
+}
+
+static void assert_fragmented_set(WhiteListManager &whitelist)
+{
+    TEST_ASSERT_EQUAL_UINT16(fragmented_size(), whitelist.size());
+    for (uint32_t i = 0; i < FRAGMENTED_ADDED; i++)
+    {
+        if (listed(whitelist, i) != (i % FRAGMENTED_STRIDE != 0))
+            TEST_FAIL_MESSAGE("a card changed state");
+    }
+}
+
+// Runs the whitelist tasks on their own scheduler for a span of simulated time
+static void run_tasks(WhiteListManager &whitelist, unsigned long ms)
+{
+    Scheduler scheduler;
+    whitelist.register_tasks(scheduler);
+
+    unsigned long start = millis();
+    while (millis() - start < ms)
+    {
+        unsigned long idle = scheduler.run();
+        delay(idle > 0 ? idle : 1);
+    }
+}
+
+void setUp()
+{
+    sim::set_serial_echo(false);
+}
+
+void tearDown()
+{
+    sim::eeprom_fail_after(-1);
+    sim::set_serial_echo(true);
+}
+
+void test_lookup_time_by_list_size()
+{
+    const uint16_t sizes[] = {5, 50, MAX_WHITELIST_SIZE};
+
+    for (uint16_t size : sizes)
+    {
+        sim::eeprom_erase();
+        WhiteListManager *whitelist = boot();
+        for (uint32_t i = 0; i < size; i++)
+            add(*whitelist, i);
+        TEST_ASSERT_EQUAL_UINT16(size, whitelist->size());
+
+        WhitelistStats before = whitelist->get_stats();
+        unsigned long start = micros();
+        for (uint16_t round = 0; round < LOOKUP_ROUNDS; round++)
+        {
+            if (!listed(*whitelist, round % size))
+                TEST_FAIL_MESSAGE("listed card refused");
+        }
+        unsigned long hit_us = micros() - start;
+        uint32_t hit_probes = whitelist->get_stats().storage_probes - before.storage_probes;
+
+        before = whitelist->get_stats();
+        start = micros();
+        for (uint32_t i = 0; i < UNKNOWN_COUNT; i++)
+        {
+            if (listed(*whitelist, UNKNOWN_FIRST + i))
+                TEST_FAIL_MESSAGE("unknown card accepted");
+        }
+        unsigned long miss_us = micros() - start;
+        uint32_t bloom_rejects = whitelist->get_stats().bloom_rejects - before.bloom_rejects;
+
+        sim::set_serial_echo(true);
+        Serial.print("entries=");
+        Serial.print(size);
+        Serial.print(" hit_ns=");
+        Serial.print(hit_us * 1000UL / LOOKUP_ROUNDS);
+        Serial.print(" probes_per_hit=");
+        Serial.print((double)hit_probes / LOOKUP_ROUNDS);
+        Serial.print(" miss_ns=");
+        Serial.print(miss_us * 1000UL / UNKNOWN_COUNT);
+        Serial.print(" bloom_rejects=");
+        Serial.print(bloom_rejects);
+        Serial.print("/");
+        Serial.println(UNKNOWN_COUNT);
+        sim::set_serial_echo(false);
+
+        // The filter answers most misses alone even when the list is full
+        TEST_ASSERT_GREATER_THAN_UINT32(UNKNOWN_COUNT * 9 / 10, bloom_rejects);
+        delete whitelist;
+    }
+}
+
+void test_reload_restores_the_set()
+{
+    WhiteListManager *whitelist = fragmented();
+    uint32_t hash = whitelist->get_hash();
+    uint16_t log_size = whitelist->log_size();
+
+    whitelist = reboot(whitelist);
+
+    assert_fragmented_set(*whitelist);
+    TEST_ASSERT_EQUAL_UINT32(hash, whitelist->get_hash());
+    TEST_ASSERT_EQUAL_UINT16(log_size, whitelist->log_size());
+    delete whitelist;
+}
+
+void test_legacy_list_is_imported_once()
+{
+    sim::eeprom_erase();
+    const uint8_t legacy[] = {4, 0xDE, 0xAD, 0xBE, 0xEF, 7, 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    for (size_t i = 0; i < sizeof(legacy); i++)
+        storage.write_byte(Partition::LEGACY_WHITELIST, i, legacy[i]);
+
+    WhiteListManager *whitelist = boot();
+    TEST_ASSERT_EQUAL_UINT16(2, whitelist->size());
+    TEST_ASSERT_TRUE(whitelist->is_whitelisted((uint8_t *)legacy + 1, 4));
+    TEST_ASSERT_TRUE(whitelist->is_whitelisted((uint8_t *)legacy + 6, 7));
+
+    // A revoke survives the reboot: the legacy list is not imported again
+    whitelist->delete_uid((uint8_t *)legacy + 1, 4);
+    whitelist = reboot(whitelist);
+    TEST_ASSERT_EQUAL_UINT16(1, whitelist->size());
+    TEST_ASSERT_FALSE(whitelist->is_whitelisted((uint8_t *)legacy + 1, 4));
+    delete whitelist;
+}
+
+void test_format_forgets_every_card()
+{
+    sim::eeprom_erase();
+    WhiteListManager *whitelist = boot();
+    for (uint32_t i = 0; i < 3; i++)
+        add(*whitelist, i);
+    TEST_ASSERT_EQUAL_UINT16(3, whitelist->size());
+
+    // A factory reset formats the storage; neither header copy may bring the log back
+    storage.format();
+    whitelist = reboot(whitelist);
+    TEST_ASSERT_EQUAL_UINT16(0, whitelist->size());
+    TEST_ASSERT_FALSE(listed(*whitelist, 0));
+    delete whitelist;
+}
+
+void test_compaction_reclaims_revoked_records()
+{
+    WhiteListManager *whitelist = fragmented();
+    TEST_ASSERT_GREATER_OR_EQUAL(W_COMPACT_THRESHOLD, whitelist->log_size());
+
+    run_tasks(*whitelist, SETTLE_MS);
+
+    TEST_ASSERT_EQUAL_UINT32(1, whitelist->get_stats().compactions);
+    TEST_ASSERT_EQUAL_UINT16(fragmented_size() * W_RECORD_SIZE, whitelist->log_size());
+    assert_fragmented_set(*whitelist);
+
+    whitelist = reboot(whitelist);
+    assert_fragmented_set(*whitelist);
+    TEST_ASSERT_EQUAL_UINT16(fragmented_size() * W_RECORD_SIZE, whitelist->log_size());
+    delete whitelist;
+}
+
+void test_full_log_compacts_on_append()
+{
+    WhiteListManager *whitelist = fragmented();
+    uint32_t added = FRAGMENTED_ADDED;
+
+    // No compaction task runs, so the append that finds the log full compacts it
+    while (whitelist->get_stats().compactions == 0)
+        add(*whitelist, added++);
+
+    for (uint32_t i = FRAGMENTED_ADDED; i < added; i++)
+        TEST_ASSERT_TRUE(listed(*whitelist, i));
+    TEST_ASSERT_EQUAL_UINT16(fragmented_size() + (added - FRAGMENTED_ADDED), whitelist->size());
+    TEST_ASSERT_EQUAL_UINT16(whitelist->size() * W_RECORD_SIZE, whitelist->log_size());
+    delete whitelist;
+}
+
+void test_power_cut_during_append_keeps_committed_cards()
+{
+    // log_end crosses a 256-byte boundary while the last cards are added
+    const uint32_t committed = 25, appended = 3;
+
+    for (uint32_t cut = 0;; cut++)
+    {
+        sim::eeprom_erase();
+        WhiteListManager *whitelist = boot();
+        for (uint32_t i = 0; i < committed; i++)
+            add(*whitelist, i);
+
+        sim::eeprom_fail_after(cut);
+        for (uint32_t i = committed; i < committed + appended; i++)
+            add(*whitelist, i);
+        bool complete = !sim::eeprom_failed();
+        sim::eeprom_fail_after(-1);
+
+        // Every card committed before the cut survives; the cards after it are added in order or not at all
+        whitelist = reboot(whitelist);
+        uint16_t size = whitelist->size();
+        TEST_ASSERT_GREATER_OR_EQUAL(committed, size);
+        for (uint32_t i = 0; i < committed + appended; i++)
+            TEST_ASSERT_EQUAL(i < size, listed(*whitelist, i));
+        delete whitelist;
+
+        if (complete)
+        {
+            TEST_ASSERT_EQUAL_UINT16(committed + appended, size);
+            break;
+        }
+    }
+}
+
+void test_power_cut_during_compaction_recovers()
+{
+    WhiteListManager *whitelist = fragmented();
+    uint32_t before = sim::eeprom_writes();
+    run_tasks(*whitelist, SETTLE_MS);
+    uint32_t pass_writes = sim::eeprom_writes() - before;
+    delete whitelist;
+    TEST_ASSERT_GREATER_THAN_UINT32(0, pass_writes);
+
+    // Cuts at the first writes, where the gap opens, then across the pass and at its last writes
+    uint32_t cuts = 0;
+    for (uint32_t cut = 0; cut <= pass_writes; cut += cut < 64 || cut + 64 > pass_writes ? 1 : 13)
+    {
+        whitelist = fragmented();
+        sim::eeprom_fail_after(cut);
+        run_tasks(*whitelist, SETTLE_MS);
+        sim::eeprom_fail_after(-1);
+
+        whitelist = reboot(whitelist);
+        assert_fragmented_set(*whitelist);
+
+        // The interrupted pass resumes, or a new one starts. A resumed pass keeps the tombstones past
+        // its gap, as it cannot tell which ones cancel a record it already moved; the next pass
+        // drops them
+        run_tasks(*whitelist, SETTLE_MS);
+        assert_fragmented_set(*whitelist);
+        TEST_ASSERT_LESS_OR_EQUAL(FRAGMENTED_ADDED * W_RECORD_SIZE, whitelist->log_size());
+
+        uint32_t added = FRAGMENTED_ADDED;
+        while (whitelist->log_size() < W_COMPACT_THRESHOLD)
+            add(*whitelist, added++);
+        run_tasks(*whitelist, SETTLE_MS);
+        TEST_ASSERT_EQUAL_UINT16(whitelist->size() * W_RECORD_SIZE, whitelist->log_size());
+
+        uint16_t size = whitelist->size();
+        whitelist = reboot(whitelist);
+        TEST_ASSERT_EQUAL_UINT16(size, whitelist->size());
+        for (uint32_t i = 0; i < added; i++)
+        {
+            if (listed(*whitelist, i) != (i >= FRAGMENTED_ADDED || i % FRAGMENTED_STRIDE != 0))
+                TEST_FAIL_MESSAGE("a card changed state");
+        }
+        delete whitelist;
+        cuts++;
+    }
+
+    sim::set_serial_echo(true);
+    Serial.print("compaction: writes_per_pass=");
+    Serial.print(pass_writes);
+    Serial.print(" power_cuts_recovered=");
+    Serial.println(cuts);
+}
+
+int main(int argc, char **argv)
+{
+    storage.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_lookup_time_by_list_size);
+    RUN_TEST(test_reload_restores_the_set);
+    RUN_TEST(test_legacy_list_is_imported_once);
+    RUN_TEST(test_format_forgets_every_card);
+    RUN_TEST(test_compaction_reclaims_revoked_records);
+    RUN_TEST(test_full_log_compacts_on_append);
+    RUN_TEST(test_power_cut_during_append_keeps_committed_cards);
+    RUN_TEST(test_power_cut_during_compaction_recovers);
+    return UNITY_END();
+}